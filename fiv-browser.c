@@ -700,14 +700,17 @@ reload_one_thumbnail(FivBrowser *self, Entry *entry)
 	gtk_widget_queue_resize(GTK_WIDGET(self));
 }
 
+static void
+reload_thumbnail_worker(gpointer data, guint index)
+{
+	FivBrowser *self = data;
+	entry_add_thumbnail(self->entries->pdata[index], self);
+}
+
 static void
 reload_thumbnails(FivBrowser *self)
 {
-	GThreadPool *pool = g_thread_pool_new(
-		entry_add_thumbnail, self, g_get_num_processors(), FALSE, NULL);
-	for (guint i = 0; i < self->entries->len; i++)
-		g_thread_pool_push(pool, self->entries->pdata[i], NULL);
-	g_thread_pool_free(pool, FALSE, TRUE);
+	fiv_io_work_parallel(self->entries->len, reload_thumbnail_worker, self);
 
 	// Once a URI disappears from the model, its thumbnail is forgotten.
 	g_hash_table_remove_all(self->thumbnail_cache);
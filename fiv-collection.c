@@ -19,9 +19,17 @@
 
 #include "fiv-collection.h"
 
+// Collections may be appended to while being read from a stream,
+// and GFile lookups can happen from any thread.
+G_LOCK_DEFINE_STATIC(collection);
+
 static struct {
 	GFile **files;
 	gsize files_len;
+	gsize files_alloc;
+
+	GSList *monitors;                   ///< Root monitors, weak references
+	GCancellable *cancellable;          ///< Any stream being read
 } g;
 
 gboolean
@@ -38,19 +46,175 @@ fiv_collection_get_contents(gsize *len)
 	return g.files;
 }
 
-void
-fiv_collection_reload(gchar **uris)
+static void
+collection_clear(void)
 {
+	if (g.cancellable) {
+		g_cancellable_cancel(g.cancellable);
+		g_clear_object(&g.cancellable);
+	}
+
+	G_LOCK(collection);
 	if (g.files) {
 		for (gsize i = 0; i < g.files_len; i++)
 			g_object_unref(g.files[i]);
 		g_free(g.files);
 	}
+	g.files = NULL;
+	g.files_len = g.files_alloc = 0;
+	G_UNLOCK(collection);
+}
 
-	g.files_len = g_strv_length(uris);
+void
+fiv_collection_reload(gchar **uris)
+{
+	collection_clear();
+
+	G_LOCK(collection);
+	g.files_alloc = g.files_len = g_strv_length(uris);
 	g.files = g_malloc0_n(g.files_len + 1, sizeof *g.files);
 	for (gsize i = 0; i < g.files_len; i++)
 		g.files[i] = g_file_new_for_uri(uris[i]);
+	G_UNLOCK(collection);
+}
+
+static void collection_announce(gsize index);
+
+// Takes ownership of the file.
+static void
+collection_append(GFile *file)
+{
+	G_LOCK(collection);
+	if (g.files_len >= g.files_alloc) {
+		g.files_alloc = MAX(g.files_alloc * 2, 64);
+		g.files = g_renew(GFile *, g.files, g.files_alloc + 1);
+	}
+	gsize index = g.files_len++;
+	g.files[index] = file;
+	g.files[g.files_len] = NULL;
+	G_UNLOCK(collection);
+
+	collection_announce(index);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+typedef struct {
+	GInputStream *stream;               ///< Where to read records from
+	GCancellable *cancellable;          ///< Cancelled by any reload
+	GString *buffer;                    ///< Incomplete records
+	gchar *cwd;                         ///< Base for relative paths
+	int separator;                      ///< Record separator, or -1
+} CollectionReader;
+
+static void
+collection_reader_free(CollectionReader *self)
+{
+	g_object_unref(self->stream);
+	g_object_unref(self->cancellable);
+	g_string_free(self->buffer, TRUE);
+	g_free(self->cwd);
+	g_free(self);
+}
+
+static void
+collection_reader_add(CollectionReader *self, const char *record, gsize len)
+{
+	if (self->separator == '\n' && len && record[len - 1] == '\r')
+		len--;
+	if (!len)
+		return;
+
+	// Search tools produce paths, people tend to also paste URIs.
+	gchar *arg = g_strndup(record, len);
+	collection_append(g_file_new_for_commandline_arg_and_cwd(arg, self->cwd));
+	g_free(arg);
+}
+
+static void
+collection_reader_process(CollectionReader *self, gboolean eof)
+{
+	// The first separator found decides between NUL and newline separation.
+	const char *p = self->buffer->str, *end = p + self->buffer->len;
+	if (self->separator < 0) {
+		const char *nul = memchr(p, '\0', end - p);
+		const char *nl = memchr(p, '\n', end - p);
+		if (nul && (!nl || nul < nl))
+			self->separator = '\0';
+		else if (nl)
+			self->separator = '\n';
+		else if (!eof)
+			return;
+	}
+
+	const char *separator = NULL;
+	while (self->separator >= 0 &&
+		(separator = memchr(p, self->separator, end - p))) {
+		collection_reader_add(self, p, separator - p);
+		p = separator + 1;
+	}
+	if (eof) {
+		collection_reader_add(self, p, end - p);
+		p = end;
+	}
+	g_string_erase(self->buffer, 0, p - self->buffer->str);
+}
+
+static void
+on_stream_read(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	CollectionReader *self = user_data;
+	GError *error = NULL;
+	GBytes *bytes = g_input_stream_read_bytes_finish(
+		G_INPUT_STREAM(source_object), res, &error);
+	if (!bytes) {
+		if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning("%s", error->message);
+		g_error_free(error);
+		collection_reader_free(self);
+		return;
+	}
+
+	// A reload may have happened in the meantime.
+	if (g_cancellable_is_cancelled(self->cancellable)) {
+		g_bytes_unref(bytes);
+		collection_reader_free(self);
+		return;
+	}
+
+	gsize len = 0;
+	gconstpointer data = g_bytes_get_data(bytes, &len);
+	g_string_append_len(self->buffer, data, len);
+	g_bytes_unref(bytes);
+
+	collection_reader_process(self, !len);
+	if (!len) {
+		collection_reader_free(self);
+		return;
+	}
+
+	g_input_stream_read_bytes_async(self->stream, 1 << 16, G_PRIORITY_LOW,
+		self->cancellable, on_stream_read, self);
+}
+
+/// Replace the collection's contents with newline or NUL-separated paths
+/// or URIs from the stream, progressively, as they are being read.
+/// Relative paths are resolved against `cwd`, or the current directory.
+void
+fiv_collection_reload_from_stream(GInputStream *stream, const char *cwd)
+{
+	collection_clear();
+	g.cancellable = g_cancellable_new();
+
+	CollectionReader *self = g_new0(CollectionReader, 1);
+	self->stream = g_object_ref(stream);
+	self->cancellable = g_object_ref(g.cancellable);
+	self->buffer = g_string_new("");
+	self->cwd = cwd ? g_strdup(cwd) : g_get_current_dir();
+	self->separator = -1;
+
+	g_input_stream_read_bytes_async(self->stream, 1 << 16, G_PRIORITY_LOW,
+		self->cancellable, on_stream_read, self);
 }
 
 // --- Declarations ------------------------------------------------------------
@@ -79,6 +243,66 @@ struct _FivCollectionEnumerator {
 	GFileEnumerator *subenumerator;     ///< Non-root: a wrapped enumerator
 };
 
+#define FIV_TYPE_COLLECTION_MONITOR (fiv_collection_monitor_get_type())
+G_DECLARE_FINAL_TYPE(FivCollectionMonitor, fiv_collection_monitor, FIV,
+	COLLECTION_MONITOR, GFileMonitor)
+
+struct _FivCollectionMonitor {
+	GFileMonitor parent_instance;
+};
+
+// --- Monitor -----------------------------------------------------------------
+
+G_DEFINE_TYPE(
+	FivCollectionMonitor, fiv_collection_monitor, G_TYPE_FILE_MONITOR)
+
+static gboolean
+fiv_collection_monitor_cancel(GFileMonitor *monitor)
+{
+	g.monitors = g_slist_remove(g.monitors, monitor);
+	return TRUE;
+}
+
+static void
+fiv_collection_monitor_finalize(GObject *object)
+{
+	g.monitors = g_slist_remove(g.monitors, object);
+
+	G_OBJECT_CLASS(fiv_collection_monitor_parent_class)->finalize(object);
+}
+
+static void
+fiv_collection_monitor_class_init(FivCollectionMonitorClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fiv_collection_monitor_finalize;
+
+	GFileMonitorClass *monitor_class = G_FILE_MONITOR_CLASS(klass);
+	monitor_class->cancel = fiv_collection_monitor_cancel;
+}
+
+static void
+fiv_collection_monitor_init(G_GNUC_UNUSED FivCollectionMonitor *self)
+{
+}
+
+// Appending to the collection is the only change ever reported.
+static void
+collection_announce(gsize index)
+{
+	if (!g.monitors)
+		return;
+
+	FivCollectionFile *file = g_object_new(FIV_TYPE_COLLECTION_FILE, NULL);
+	file->index = index;
+	file->target = g_object_ref(g.files[index]);
+	for (GSList *iter = g.monitors; iter; iter = iter->next) {
+		g_file_monitor_emit_event(G_FILE_MONITOR(iter->data),
+			G_FILE(file), NULL, G_FILE_MONITOR_EVENT_CREATED);
+	}
+	g_object_unref(file);
+}
+
 // --- Enumerator --------------------------------------------------------------
 
 G_DEFINE_TYPE(
@@ -114,12 +338,16 @@ fiv_collection_enumerator_next_file(GFileEnumerator *enumerator,
 		return info;
 	}
 
-	if (self->index >= g.files_len)
+	G_LOCK(collection);
+	if (self->index >= g.files_len) {
+		G_UNLOCK(collection);
 		return NULL;
+	}
 
 	FivCollectionFile *file = g_object_new(FIV_TYPE_COLLECTION_FILE, NULL);
 	file->index = self->index;
 	file->target = g_object_ref(g.files[self->index++]);
+	G_UNLOCK(collection);
 
 	GFileInfo *info = g_file_query_info(G_FILE(file), self->attributes,
 		G_FILE_QUERY_INFO_NONE, cancellable, error);
@@ -127,6 +355,121 @@ fiv_collection_enumerator_next_file(GFileEnumerator *enumerator,
 	return info;
 }
 
+static void
+free_info_list(GList *list)
+{
+	g_list_free_full(list, g_object_unref);
+}
+
+typedef struct {
+	GPtrArray *infos;                   ///< Results, in collection order
+	gsize pending;                      ///< Unfinished lookups
+} NextFilesData;
+
+typedef struct {
+	GTask *task;                        ///< The whole batch
+	gsize index;                        ///< Index into NextFilesData::infos
+} NextFilesSlot;
+
+static void
+next_files_data_free(NextFilesData *data)
+{
+	for (guint i = 0; i < data->infos->len; i++)
+		g_clear_object(&data->infos->pdata[i]);
+	g_ptr_array_free(data->infos, TRUE);
+	g_free(data);
+}
+
+static void
+on_next_file_info(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	NextFilesSlot *slot = user_data;
+	NextFilesData *data = g_task_get_task_data(slot->task);
+
+	// Our query_info never fails, save for cancellation.
+	data->infos->pdata[slot->index] =
+		g_file_query_info_finish(G_FILE(source_object), res, NULL);
+
+	GTask *task = slot->task;
+	g_free(slot);
+	if (--data->pending) {
+		g_object_unref(task);
+		return;
+	}
+
+	if (!g_task_return_error_if_cancelled(task)) {
+		GList *list = NULL;
+		for (guint i = data->infos->len; i--; ) {
+			if (data->infos->pdata[i])
+				list = g_list_prepend(list, g_steal_pointer(
+					&data->infos->pdata[i]));
+		}
+		g_task_return_pointer(
+			task, list, (GDestroyNotify) free_info_list);
+	}
+	g_object_unref(task);
+}
+
+// Looking up attributes of collection items can take a while,
+// in particular with many of them, or when they are remote,
+// so run these lookups in parallel.
+static void
+fiv_collection_enumerator_next_files_async(GFileEnumerator *enumerator,
+	int num_files, int io_priority, GCancellable *cancellable,
+	GAsyncReadyCallback callback, gpointer user_data)
+{
+	FivCollectionEnumerator *self = FIV_COLLECTION_ENUMERATOR(enumerator);
+	if (self->subenumerator) {
+		G_FILE_ENUMERATOR_CLASS(fiv_collection_enumerator_parent_class)->
+			next_files_async(enumerator, num_files, io_priority, cancellable,
+				callback, user_data);
+		return;
+	}
+
+	GTask *task = g_task_new(enumerator, cancellable, callback, user_data);
+	g_task_set_name(task, __func__);
+	g_task_set_priority(task, io_priority);
+
+	G_LOCK(collection);
+	gsize count = 0;
+	if (num_files > 0 && self->index < g.files_len)
+		count = MIN((gsize) num_files, g.files_len - self->index);
+
+	GFile **files = g_malloc0_n(count + 1, sizeof *files);
+	for (gsize i = 0; i < count; i++) {
+		FivCollectionFile *file = g_object_new(FIV_TYPE_COLLECTION_FILE, NULL);
+		file->index = self->index;
+		file->target = g_object_ref(g.files[self->index++]);
+		files[i] = G_FILE(file);
+	}
+	G_UNLOCK(collection);
+
+	if (!count) {
+		g_task_return_pointer(task, NULL, NULL);
+		g_object_unref(task);
+		g_free(files);
+		return;
+	}
+
+	NextFilesData *data = g_new0(NextFilesData, 1);
+	data->infos = g_ptr_array_sized_new(count);
+	g_ptr_array_set_size(data->infos, count);
+	data->pending = count;
+	g_task_set_task_data(task, data, (GDestroyNotify) next_files_data_free);
+
+	for (gsize i = 0; i < count; i++) {
+		NextFilesSlot *slot = g_new0(NextFilesSlot, 1);
+		slot->task = g_object_ref(task);
+		slot->index = i;
+		g_file_query_info_async(files[i], self->attributes,
+			G_FILE_QUERY_INFO_NONE, io_priority, cancellable,
+			on_next_file_info, slot);
+		g_object_unref(files[i]);
+	}
+	g_object_unref(task);
+	g_free(files);
+}
+
 static gboolean
 fiv_collection_enumerator_close(
 	GFileEnumerator *enumerator, GCancellable *cancellable, GError **error)
@@ -145,6 +488,8 @@ fiv_collection_enumerator_class_init(FivCollectionEnumeratorClass *klass)
 
 	GFileEnumeratorClass *enumerator_class = G_FILE_ENUMERATOR_CLASS(klass);
 	enumerator_class->next_file = fiv_collection_enumerator_next_file;
+	enumerator_class->next_files_async =
+		fiv_collection_enumerator_next_files_async;
 	enumerator_class->close_fn = fiv_collection_enumerator_close;
 }
 
@@ -372,12 +717,16 @@ get_file_for_path(const char *path)
 
 	char *end = NULL;
 	guint64 i = g_ascii_strtoull(path, &end, 10);
-	if (i <= 0 || i > g.files_len || *end != '.')
+	G_LOCK(collection);
+	if (i <= 0 || i > g.files_len || *end != '.') {
+		G_UNLOCK(collection);
 		return g_file_new_for_uri("");
+	}
 
 	FivCollectionFile *new = g_object_new(FIV_TYPE_COLLECTION_FILE, NULL);
 	new->index = --i;
 	new->target = g_object_ref(g.files[i]);
+	G_UNLOCK(collection);
 
 	const char *subpath = strchr(path, '/');
 	if (subpath && subpath[1])
@@ -467,57 +816,52 @@ fiv_collection_file_enumerate_children(GFile *file, const char *attributes,
 	return G_FILE_ENUMERATOR(enumerator);
 }
 
-// TODO(p): Implement async variants of this proxying method.
 static GFileInfo *
-fiv_collection_file_query_info(GFile *file, const char *attributes,
-	GFileQueryInfoFlags flags, GCancellable *cancellable,
-	G_GNUC_UNUSED GError **error)
+make_root_info(void)
 {
-	FivCollectionFile *self = FIV_COLLECTION_FILE(file);
-	GError *e = NULL;
-	if (!self->target) {
-		GFileInfo *info = g_file_info_new();
-		g_file_info_set_file_type(info, G_FILE_TYPE_DIRECTORY);
-		g_file_info_set_name(info, "/");
-		g_file_info_set_display_name(info, "Collection");
-
-		GIcon *icon = g_icon_new_for_string("shapes-symbolic", NULL);
-		if (icon) {
-			g_file_info_set_symbolic_icon(info, icon);
-			g_object_unref(icon);
-		} else {
-			g_warning("%s", e->message);
-			g_error_free(e);
-		}
-		return info;
+	GFileInfo *info = g_file_info_new();
+	g_file_info_set_file_type(info, G_FILE_TYPE_DIRECTORY);
+	g_file_info_set_name(info, "/");
+	g_file_info_set_display_name(info, "Collection");
+
+	GIcon *icon = g_icon_new_for_string("shapes-symbolic", NULL);
+	if (icon) {
+		g_file_info_set_symbolic_icon(info, icon);
+		g_object_unref(icon);
+	} else {
+		g_warning("failed to create an icon");
 	}
+	return info;
+}
 
-	// The "http" scheme doesn't behave nicely, make something up if needed.
-	GFile *intermediate = get_target_subpathed(self);
-	GFileInfo *info =
-		g_file_query_info(intermediate, attributes, flags, cancellable, &e);
-	if (!info) {
-		g_warning("%s", e->message);
-		g_error_free(e);
+// The "http" scheme doesn't behave nicely, make something up if needed.
+static GFileInfo *
+make_fallback_info(GFile *intermediate, GError *error)
+{
+	g_warning("%s", error->message);
+	g_error_free(error);
 
-		info = g_file_info_new();
-		g_file_info_set_file_type(info, G_FILE_TYPE_REGULAR);
-		gchar *basename = g_file_get_basename(intermediate);
-		g_file_info_set_name(info, basename);
+	GFileInfo *info = g_file_info_new();
+	g_file_info_set_file_type(info, G_FILE_TYPE_REGULAR);
+	gchar *basename = g_file_get_basename(intermediate);
+	g_file_info_set_name(info, basename);
 
-		// The display name is "guaranteed to always be set" when queried,
-		// which is up to implementations.
-		gchar *safe = g_utf8_make_valid(basename, -1);
-		g_free(basename);
-		g_file_info_set_display_name(info, safe);
-		g_free(safe);
-	}
+	// The display name is "guaranteed to always be set" when queried,
+	// which is up to implementations.
+	gchar *safe = g_utf8_make_valid(basename, -1);
+	g_free(basename);
+	g_file_info_set_display_name(info, safe);
+	g_free(safe);
+	return info;
+}
 
+static GFileInfo *
+fix_up_info(FivCollectionFile *self, GFile *intermediate, GFileInfo *info)
+{
 	gchar *target_uri = g_file_get_uri(intermediate);
 	g_file_info_set_attribute_string(
 		info, G_FILE_ATTRIBUTE_STANDARD_TARGET_URI, target_uri);
 	g_free(target_uri);
-	g_object_unref(intermediate);
 
 	// Ensure all basenames that might have been set have the numeric prefix.
 	const char *name = NULL;
@@ -546,6 +890,75 @@ fiv_collection_file_query_info(GFile *file, const char *attributes,
 	return info;
 }
 
+static GFileInfo *
+fiv_collection_file_query_info(GFile *file, const char *attributes,
+	GFileQueryInfoFlags flags, GCancellable *cancellable,
+	G_GNUC_UNUSED GError **error)
+{
+	FivCollectionFile *self = FIV_COLLECTION_FILE(file);
+	if (!self->target)
+		return make_root_info();
+
+	GError *e = NULL;
+	GFile *intermediate = get_target_subpathed(self);
+	GFileInfo *info =
+		g_file_query_info(intermediate, attributes, flags, cancellable, &e);
+	if (!info)
+		info = make_fallback_info(intermediate, e);
+
+	fix_up_info(self, intermediate, info);
+	g_object_unref(intermediate);
+	return info;
+}
+
+static void
+on_query_info(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	GFile *intermediate = G_FILE(source_object);
+	GTask *task = G_TASK(user_data);
+	GError *error = NULL;
+	GFileInfo *info = g_file_query_info_finish(intermediate, res, &error);
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_task_return_error(task, error);
+		g_object_unref(task);
+		return;
+	}
+	if (!info)
+		info = make_fallback_info(intermediate, error);
+
+	fix_up_info(g_task_get_source_object(task), intermediate, info);
+	g_task_return_pointer(task, info, g_object_unref);
+	g_object_unref(task);
+}
+
+static void
+fiv_collection_file_query_info_async(GFile *file, const char *attributes,
+	GFileQueryInfoFlags flags, int io_priority, GCancellable *cancellable,
+	GAsyncReadyCallback callback, gpointer user_data)
+{
+	FivCollectionFile *self = FIV_COLLECTION_FILE(file);
+	GTask *task = g_task_new(file, cancellable, callback, user_data);
+	g_task_set_name(task, __func__);
+	g_task_set_priority(task, io_priority);
+	if (!self->target) {
+		g_task_return_pointer(task, make_root_info(), g_object_unref);
+		g_object_unref(task);
+		return;
+	}
+
+	GFile *intermediate = get_target_subpathed(self);
+	g_file_query_info_async(intermediate, attributes, flags, io_priority,
+		cancellable, on_query_info, task);
+	g_object_unref(intermediate);
+}
+
+static GFileInfo *
+fiv_collection_file_query_info_finish(
+	G_GNUC_UNUSED GFile *file, GAsyncResult *res, GError **error)
+{
+	return g_task_propagate_pointer(G_TASK(res), error);
+}
+
 static GFileInfo *
 fiv_collection_file_query_filesystem_info(G_GNUC_UNUSED GFile *file,
 	G_GNUC_UNUSED const char *attributes,
@@ -568,6 +981,24 @@ fiv_collection_file_query_filesystem_info(G_GNUC_UNUSED GFile *file,
 	return info;
 }
 
+static GFileMonitor *
+fiv_collection_file_monitor_dir(GFile *file,
+	G_GNUC_UNUSED GFileMonitorFlags flags,
+	G_GNUC_UNUSED GCancellable *cancellable, GError **error)
+{
+	// Only the root can change, by having items appended.
+	FivCollectionFile *self = FIV_COLLECTION_FILE(file);
+	if (self->target) {
+		g_set_error_literal(error,
+			G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "Operation not supported");
+		return NULL;
+	}
+
+	GFileMonitor *monitor = g_object_new(FIV_TYPE_COLLECTION_MONITOR, NULL);
+	g.monitors = g_slist_prepend(g.monitors, monitor);
+	return monitor;
+}
+
 static GFile *
 fiv_collection_file_set_display_name(G_GNUC_UNUSED GFile *file,
 	G_GNUC_UNUSED const char *display_name,
@@ -660,7 +1091,10 @@ fiv_collection_file_file_iface_init(GFileIface *iface)
 	// Optional methods.
 	iface->enumerate_children = fiv_collection_file_enumerate_children;
 	iface->query_info = fiv_collection_file_query_info;
+	iface->query_info_async = fiv_collection_file_query_info_async;
+	iface->query_info_finish = fiv_collection_file_query_info_finish;
 	iface->query_filesystem_info = fiv_collection_file_query_filesystem_info;
+	iface->monitor_dir = fiv_collection_file_monitor_dir;
 	iface->read_fn = fiv_collection_file_read;
 	iface->read_async = fiv_collection_file_read_async;
 	iface->read_finish = fiv_collection_file_read_finish;
@@ -22,4 +22,5 @@
 gboolean fiv_collection_uri_matches(const char *uri);
 GFile **fiv_collection_get_contents(gsize *len);
 void fiv_collection_reload(gchar **uris);
+void fiv_collection_reload_from_stream(GInputStream *stream, const char *cwd);
 void fiv_collection_register(void);
@@ -86,6 +86,7 @@ fiv_io_premultiply_argb32(FivIoImage *image)
 struct _FivIoProfile {
 	FivIoCmm *cmm;
 	cmsHPROFILE profile;
+	bool is_sRGB;                       ///< Built-in sRGB, not from data
 };
 
 GBytes *
@@ -192,8 +193,10 @@ fiv_io_cmm_get_profile_sRGB(FivIoCmm *self)
 {
 	g_return_val_if_fail(self != NULL, NULL);
 
-	return fiv_io_profile_new(self,
-		cmsCreate_sRGBProfileTHR(self->context));
+	FivIoProfile *profile =
+		fiv_io_profile_new(self, cmsCreate_sRGBProfileTHR(self->context));
+	profile->is_sRGB = true;
+	return profile;
 }
 
 FivIoProfile *
@@ -295,12 +298,25 @@ fiv_io_cmm_cmyk(FivIoCmm *self,
 		image->data, image->width * image->height);
 }
 
+// Untagged data are assumed to be sRGB, and so is a screen that doesn't
+// announce any profile. Building an lcms2 transform for that common case
+// is a waste of time, especially before the first image is shown.
+static bool
+fiv_io_cmm_is_identity(FivIoProfile *source, FivIoProfile *target)
+{
+	return !target || (!source && target->is_sRGB) ||
+		(source && source->is_sRGB && target->is_sRGB);
+}
+
 static bool
 fiv_io_cmm_rgb_direct(FivIoCmm *self, unsigned char *data, int w, int h,
 	FivIoProfile *source, FivIoProfile *target,
 	uint32_t source_format, uint32_t target_format)
 {
 	g_return_val_if_fail(target == NULL || self != NULL, false);
+	if (source_format == target_format &&
+		fiv_io_cmm_is_identity(source, target))
+		return false;
 
 	// TODO(p): We should make this optional.
 	FivIoProfile *src_fallback = NULL;
@@ -386,7 +402,7 @@ fiv_io_cmm_argb32_premultiply(FivIoCmm *self,
 
 	if (image->format != CAIRO_FORMAT_ARGB32) {
 		fiv_io_cmm_xrgb32(self, image, source, target);
-	} else if (!target || self->broken_premul) {
+	} else if (fiv_io_cmm_is_identity(source, target) || self->broken_premul) {
 		fiv_io_cmm_xrgb32(self, image, source, target);
 		fiv_io_premultiply_argb32(image);
 	} else if (!fiv_io_cmm_rgb_direct(self, image->data,
@@ -457,7 +473,9 @@ fiv_io_cmm_finish(FivIoCmm *self, FivIoImage *image, FivIoProfile *target)
 	if (!target)
 		return image;
 
+	// Deferred pages are only managed once they are decoded.
 	for (FivIoImage *page = image; page != NULL; page = page->page_next)
-		fiv_io_cmm_page(self, page, target, fiv_io_cmm_any);
+		if (!page->deferred)
+			fiv_io_cmm_page(self, page, target, fiv_io_cmm_any);
 	return image;
 }
@@ -17,7 +17,6 @@
 
 #include "fiv-io.h"
 #include "fiv-io-model.h"
-#include "xdg.h"
 
 GType
 fiv_io_model_sort_get_type(void)
@@ -124,12 +123,15 @@ entry_new(GFile *file, GFileInfo *info)
 
 struct _FivIoModel {
 	GObject parent_instance;
-	GPatternSpec **supported_patterns;
 
 	GFile *directory;                   ///< Currently loaded directory
 	GFileMonitor *monitor;              ///< "directory" monitoring
 	GPtrArray *subdirs;                 ///< "directory" contents
 	GPtrArray *files;                   ///< "directory" contents
+	GHashTable *uris;                   ///< All of the above, by URI
+
+	GCancellable *cancellable;          ///< Pending additions
+	GQueue additions;                   ///< Pending ModelAddition items
 
 	FivIoModelSort sort_field;          ///< How to sort
 	gboolean sort_descending;           ///< Whether to sort in reverse
@@ -170,8 +172,27 @@ model_entry_array_new(void)
 #define g_pattern_spec_match g_pattern_match
 #endif
 
+// The patterns are the same for all models, and only needed once filtering
+// actually takes place, so they are compiled lazily, and shared.
+static GPatternSpec **
+model_supported_patterns(void)
+{
+	static gsize initialization_value = 0;
+	static GPatternSpec **patterns = NULL;
+	if (g_once_init_enter(&initialization_value)) {
+		gchar **globs = fiv_io_all_supported_globs();
+		gsize n = g_strv_length(globs);
+		patterns = g_malloc0_n(n + 1, sizeof *patterns);
+		while (n--)
+			patterns[n] = g_pattern_spec_new(globs[n]);
+		g_strfreev(globs);
+		g_once_init_leave(&initialization_value, 1);
+	}
+	return patterns;
+}
+
 static gboolean
-model_supports(FivIoModel *self, const char *filename)
+model_supports(G_GNUC_UNUSED FivIoModel *self, const char *filename)
 {
 	gchar *utf8 = g_filename_to_utf8(filename, -1, NULL, NULL, NULL);
 	if (!utf8)
@@ -185,7 +206,7 @@ model_supports(FivIoModel *self, const char *filename)
 	// fnmatch() uses the /locale encoding/, and isn't present on Windows.
 	// TODO(p): Consider using g_file_info_get_display_name() for direct UTF-8.
 	gboolean result = FALSE;
-	for (GPatternSpec **p = self->supported_patterns; *p; p++)
+	for (GPatternSpec **p = model_supported_patterns(); *p; p++)
 		if ((result = g_pattern_spec_match(*p, lc_length, lc, reversed)))
 			break;
 
@@ -259,6 +280,24 @@ model_decide_placement(
 	return NULL;
 }
 
+typedef struct {
+	GList *infos;                       ///< Information on the next entries
+	GError *error;                      ///< Any error
+	gboolean done;                      ///< The request has finished
+} ModelBatch;
+
+static void
+on_model_batch(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	ModelBatch *batch = user_data;
+	batch->infos = g_file_enumerator_next_files_finish(
+		G_FILE_ENUMERATOR(source_object), res, &batch->error);
+	batch->done = TRUE;
+}
+
+// Enumerators can look up information on several entries at once,
+// which matters with large collections, where each of them is a query.
+// Wait on a private main context, so that this stays synchronous.
 static gboolean
 model_reload_to(FivIoModel *self, GFile *directory,
 	GPtrArray *subdirs, GPtrArray *files, GError **error)
@@ -273,24 +312,38 @@ model_reload_to(FivIoModel *self, GFile *directory,
 	if (!enumerator)
 		return FALSE;
 
-	GFileInfo *info = NULL;
-	GFile *child = NULL;
-	GError *e = NULL;
+	GMainContext *context = g_main_context_new();
+	g_main_context_push_thread_default(context);
 	while (TRUE) {
-		if (!g_file_enumerator_iterate(enumerator, &info, &child, NULL, &e) &&
-			e) {
-			g_warning("%s", e->message);
-			g_clear_error(&e);
-			continue;
+		ModelBatch batch = {};
+		g_file_enumerator_next_files_async(enumerator, 256,
+			G_PRIORITY_DEFAULT, NULL, on_model_batch, &batch);
+		while (!batch.done)
+			g_main_context_iteration(context, TRUE);
+		if (batch.error) {
+			// This is only reported when no entry could be read at all.
+			g_warning("%s", batch.error->message);
+			g_error_free(batch.error);
+			break;
 		}
-		if (!info)
+		if (!batch.infos)
 			break;
 
-		GPtrArray *target =
-			model_decide_placement(self, info, subdirs, files);
-		if (target)
+		for (GList *link = batch.infos; link; link = link->next) {
+			GFileInfo *info = link->data;
+			GPtrArray *target =
+				model_decide_placement(self, info, subdirs, files);
+			if (!target)
+				continue;
+
+			GFile *child = g_file_enumerator_get_child(enumerator, info);
 			g_ptr_array_add(target, entry_new(child, info));
+			g_object_unref(child);
+		}
+		g_list_free_full(batch.infos, g_object_unref);
 	}
+	g_main_context_pop_thread_default(context);
+	g_main_context_unref(context);
 	g_object_unref(enumerator);
 
 	if (subdirs)
@@ -300,12 +353,29 @@ model_reload_to(FivIoModel *self, GFile *directory,
 	return TRUE;
 }
 
+static void
+model_index(FivIoModel *self, GPtrArray *target)
+{
+	for (guint i = 0; i < target->len; i++) {
+		FivIoModelEntry *entry = target->pdata[i];
+		g_hash_table_insert(self->uris, entry->uri, entry);
+	}
+}
+
+static void model_cancel_additions(FivIoModel *self);
+
 static gboolean
 model_reload(FivIoModel *self, GError **error)
 {
+	model_cancel_additions(self);
+
 	// Note that this will clear all entries on failure.
 	gboolean result = model_reload_to(
 		self, self->directory, self->subdirs, self->files, error);
+
+	g_hash_table_remove_all(self->uris);
+	model_index(self, self->subdirs);
+	model_index(self, self->files);
 	g_signal_emit(self, model_signals[RELOADED], 0);
 	return result;
 }
@@ -320,15 +390,20 @@ model_resort(FivIoModel *self)
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+// Directories may grow large, in particular collections that are being
+// streamed in, so avoid linear searches through GFile objects.
 static gint
-model_find(const GPtrArray *target, GFile *file, FivIoModelEntry **entry)
+model_find(FivIoModel *self, const GPtrArray *target, GFile *file,
+	FivIoModelEntry **entry)
 {
+	gchar *uri = g_file_get_uri(file);
+	FivIoModelEntry *e = g_hash_table_lookup(self->uris, uri);
+	g_free(uri);
+	if (!e)
+		return -1;
+
 	for (guint i = 0; i < target->len; i++) {
-		FivIoModelEntry *e = target->pdata[i];
-		GFile *f = g_file_new_for_uri(e->uri);
-		gboolean match = g_file_equal(f, file);
-		g_object_unref(f);
-		if (match) {
+		if (target->pdata[i] == e) {
 			*entry = e;
 			return i;
 		}
@@ -345,8 +420,8 @@ enum monitor_event {
 };
 
 static void
-monitor_apply(enum monitor_event event, GPtrArray *target, int index,
-	FivIoModelEntry *new_entry)
+monitor_apply(FivIoModel *self, enum monitor_event event, GPtrArray *target,
+	int index, FivIoModelEntry *new_entry)
 {
 	g_return_if_fail(event != MONITOR_CHANGING || index >= 0);
 
@@ -357,6 +432,16 @@ monitor_apply(enum monitor_event event, GPtrArray *target, int index,
 		// The file wasn't filtered out but now it is.
 		event = MONITOR_REMOVING;
 
+	if (event == MONITOR_CHANGING || event == MONITOR_REMOVING ||
+		event == MONITOR_RENAMING) {
+		FivIoModelEntry *old_entry = target->pdata[index];
+		if (g_hash_table_lookup(self->uris, old_entry->uri) == old_entry)
+			g_hash_table_remove(self->uris, old_entry->uri);
+	}
+	if (event == MONITOR_CHANGING || event == MONITOR_RENAMING ||
+		event == MONITOR_ADDING)
+		g_hash_table_insert(self->uris, new_entry->uri, new_entry);
+
 	if (event == MONITOR_CHANGING) {
 		fiv_io_model_entry_unref(target->pdata[index]);
 		target->pdata[index] = fiv_io_model_entry_ref(new_entry);
@@ -367,16 +452,168 @@ monitor_apply(enum monitor_event event, GPtrArray *target, int index,
 		g_ptr_array_add(target, fiv_io_model_entry_ref(new_entry));
 }
 
+static void
+model_process_event(FivIoModel *self, enum monitor_event event, GFile *file,
+	GFile *new_entry_file, GFileInfo *info)
+{
+	FivIoModelEntry *old_entry = NULL;
+	gint files_index = model_find(self, self->files, file, &old_entry);
+	gint subdirs_index = model_find(self, self->subdirs, file, &old_entry);
+	if (event == MONITOR_ADDING)
+		old_entry = NULL;
+
+	FivIoModelEntry *new_entry = NULL;
+	GPtrArray *new_target = NULL;
+	if (new_entry_file && info) {
+		if ((new_target =
+			model_decide_placement(self, info, self->subdirs, self->files)))
+			new_entry = entry_new(new_entry_file, info);
+
+		if ((files_index != -1 && new_target == self->subdirs) ||
+			(subdirs_index != -1 && new_target == self->files)) {
+			g_debug("monitor: ignoring transfer between files and subdirs");
+			goto out;
+		}
+	}
+
+	// Keep a reference alive so that signal handlers see the new arrays.
+	if (old_entry)
+		fiv_io_model_entry_ref(old_entry);
+
+	if (files_index != -1 || new_target == self->files) {
+		monitor_apply(self, event, self->files, files_index, new_entry);
+		g_signal_emit(self, model_signals[FILES_CHANGED],
+			0, old_entry, new_entry);
+	}
+	if (subdirs_index != -1 || new_target == self->subdirs) {
+		monitor_apply(self, event, self->subdirs, subdirs_index, new_entry);
+		g_signal_emit(self, model_signals[SUBDIRECTORIES_CHANGED],
+			0, old_entry, new_entry);
+	}
+
+	// NOTE: It would make sense to do
+	//   g_ptr_array_sort_with_data(self->{files,subdirs}, model_compare, self);
+	// but then the iteration behaviour of fiv.c would differ from what's shown
+	// in the browser. Perhaps we need to use an index-based, fully-synchronized
+	// interface similar to GListModel::items-changed.
+
+	if (old_entry)
+		fiv_io_model_entry_unref(old_entry);
+out:
+	if (new_entry)
+		fiv_io_model_entry_unref(new_entry);
+}
+
+// Additions may arrive in large bursts, such as when a collection is being
+// read from a pipe, so their information is retrieved asynchronously.
+// They are still applied in the order in which they have been announced.
+typedef struct model_addition ModelAddition;
+struct model_addition {
+	FivIoModel *model;                  ///< Weak reference, NULL if orphaned
+	GFile *file;                        ///< The file being added
+	GFileInfo *info;                    ///< Its information, if available
+	gboolean ready;                     ///< The query has finished
+	gboolean dropped;                   ///< Do not apply the addition
+};
+
+static void
+model_addition_free(ModelAddition *self)
+{
+	g_object_unref(self->file);
+	g_clear_object(&self->info);
+	g_free(self);
+}
+
+static void
+model_cancel_additions(FivIoModel *self)
+{
+	if (self->cancellable) {
+		g_cancellable_cancel(self->cancellable);
+		g_clear_object(&self->cancellable);
+	}
+
+	// Unfinished queries will clean up after themselves.
+	ModelAddition *addition = NULL;
+	while ((addition = g_queue_pop_head(&self->additions))) {
+		if (addition->ready)
+			model_addition_free(addition);
+		else
+			addition->model = NULL;
+	}
+}
+
+static void
+model_drain_additions(FivIoModel *self)
+{
+	ModelAddition *addition = NULL;
+	while ((addition = g_queue_peek_head(&self->additions)) &&
+		addition->ready) {
+		g_queue_pop_head(&self->additions);
+		if (!addition->dropped && addition->info) {
+			model_process_event(self, MONITOR_ADDING,
+				addition->file, addition->file, addition->info);
+		}
+		model_addition_free(addition);
+	}
+}
+
+static void
+on_addition_queried(GObject *source_object, GAsyncResult *res,
+	gpointer user_data)
+{
+	ModelAddition *addition = user_data;
+	GError *error = NULL;
+	addition->info =
+		g_file_query_info_finish(G_FILE(source_object), res, &error);
+	addition->ready = TRUE;
+	if (!addition->model) {
+		g_clear_error(&error);
+		model_addition_free(addition);
+		return;
+	}
+
+	if (error) {
+		g_debug("monitor: %s", error->message);
+		g_error_free(error);
+	}
+	model_drain_additions(addition->model);
+}
+
+static void
+model_queue_addition(FivIoModel *self, GFile *file)
+{
+	if (!self->cancellable)
+		self->cancellable = g_cancellable_new();
+
+	ModelAddition *addition = g_new0(ModelAddition, 1);
+	addition->model = self;
+	addition->file = g_object_ref(file);
+	g_queue_push_tail(&self->additions, addition);
+
+	g_file_query_info_async(file, model_load_attributes,
+		G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT, self->cancellable,
+		on_addition_queried, addition);
+}
+
+static gboolean
+model_drop_addition(FivIoModel *self, GFile *file)
+{
+	for (GList *link = self->additions.head; link; link = link->next) {
+		ModelAddition *addition = link->data;
+		if (!addition->dropped && g_file_equal(addition->file, file)) {
+			addition->dropped = TRUE;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 static void
 on_monitor_changed(G_GNUC_UNUSED GFileMonitor *monitor, GFile *file,
 	GFile *other_file, GFileMonitorEvent event_type, gpointer user_data)
 {
 	FivIoModel *self = user_data;
 
-	FivIoModelEntry *old_entry = NULL;
-	gint files_index = model_find(self->files, file, &old_entry);
-	gint subdirs_index = model_find(self->subdirs, file, &old_entry);
-
 	enum monitor_event event = MONITOR_NONE;
 	GFile *new_entry_file = NULL;
 	switch (event_type) {
@@ -398,10 +635,8 @@ on_monitor_changed(G_GNUC_UNUSED GFileMonitor *monitor, GFile *file,
 		break;
 	case G_FILE_MONITOR_EVENT_CREATED:
 	case G_FILE_MONITOR_EVENT_MOVED_IN:
-		event = MONITOR_ADDING;
-		old_entry = NULL;
-		new_entry_file = file;
-		break;
+		model_queue_addition(self, file);
+		return;
 
 	case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
 	case G_FILE_MONITOR_EVENT_UNMOUNTED:
@@ -410,57 +645,35 @@ on_monitor_changed(G_GNUC_UNUSED GFileMonitor *monitor, GFile *file,
 		return;
 	}
 
-	FivIoModelEntry *new_entry = NULL;
-	GPtrArray *new_target = NULL;
+	// The file hasn't made it into the model yet, the addition will take
+	// the most recent information into account, or it is to be forgotten.
+	if (!g_queue_is_empty(&self->additions)) {
+		FivIoModelEntry *entry = NULL;
+		if (event == MONITOR_CHANGING &&
+			model_find(self, self->files, file, &entry) < 0 &&
+			model_find(self, self->subdirs, file, &entry) < 0)
+			return;
+		if (event != MONITOR_CHANGING && model_drop_addition(self, file)) {
+			if (event == MONITOR_RENAMING)
+				model_queue_addition(self, other_file);
+			return;
+		}
+	}
+
+	GFileInfo *info = NULL;
 	if (new_entry_file) {
 		GError *error = NULL;
-		GFileInfo *info = g_file_query_info(new_entry_file,
+		info = g_file_query_info(new_entry_file,
 			model_load_attributes, G_FILE_QUERY_INFO_NONE, NULL, &error);
 		if (error) {
 			g_debug("monitor: %s", error->message);
 			g_error_free(error);
-			goto run;
-		}
-
-		if ((new_target =
-			model_decide_placement(self, info, self->subdirs, self->files)))
-			new_entry = entry_new(new_entry_file, info);
-		g_object_unref(info);
-
-		if ((files_index != -1 && new_target == self->subdirs) ||
-			(subdirs_index != -1 && new_target == self->files)) {
-			g_debug("monitor: ignoring transfer between files and subdirs");
-			goto out;
 		}
 	}
 
-run:
-	// Keep a reference alive so that signal handlers see the new arrays.
-	if (old_entry)
-		fiv_io_model_entry_ref(old_entry);
-
-	if (files_index != -1 || new_target == self->files) {
-		monitor_apply(event, self->files, files_index, new_entry);
-		g_signal_emit(self, model_signals[FILES_CHANGED],
-			0, old_entry, new_entry);
-	}
-	if (subdirs_index != -1 || new_target == self->subdirs) {
-		monitor_apply(event, self->subdirs, subdirs_index, new_entry);
-		g_signal_emit(self, model_signals[SUBDIRECTORIES_CHANGED],
-			0, old_entry, new_entry);
-	}
-
-	// NOTE: It would make sense to do
-	//   g_ptr_array_sort_with_data(self->{files,subdirs}, model_compare, self);
-	// but then the iteration behaviour of fiv.c would differ from what's shown
-	// in the browser. Perhaps we need to use an index-based, fully-synchronized
-	// interface similar to GListModel::items-changed.
-
-	if (old_entry)
-		fiv_io_model_entry_unref(old_entry);
-out:
-	if (new_entry)
-		fiv_io_model_entry_unref(new_entry);
+	model_process_event(self, event, file, new_entry_file, info);
+	if (info)
+		g_object_unref(info);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -578,12 +791,10 @@ static void
 fiv_io_model_finalize(GObject *gobject)
 {
 	FivIoModel *self = FIV_IO_MODEL(gobject);
-	for (GPatternSpec **p = self->supported_patterns; *p; p++)
-		g_pattern_spec_free(*p);
-	g_free(self->supported_patterns);
-
+	model_cancel_additions(self);
 	g_clear_object(&self->directory);
 	g_clear_object(&self->monitor);
+	g_hash_table_destroy(self->uris);
 	g_ptr_array_free(self->subdirs, TRUE);
 	g_ptr_array_free(self->files, TRUE);
 
@@ -684,19 +895,10 @@ fiv_io_model_init(FivIoModel *self)
 {
 	self->filtering = TRUE;
 
-	char **types = fiv_io_all_supported_media_types();
-	char **globs = extract_mime_globs((const char **) types);
-	g_strfreev(types);
-
-	gsize n = g_strv_length(globs);
-	self->supported_patterns =
-		g_malloc0_n(n + 1, sizeof *self->supported_patterns);
-	while (n--)
-		self->supported_patterns[n] = g_pattern_spec_new(globs[n]);
-	g_strfreev(globs);
-
 	self->files = model_entry_array_new();
 	self->subdirs = model_entry_array_new();
+	self->uris = g_hash_table_new(g_str_hash, g_str_equal);
+	g_queue_init(&self->additions);
 }
 
 gboolean
@@ -0,0 +1,281 @@
+//
+// fiv-io-work.c: prioritised background work
+//
+// Copyright (c) 2024, Přemysl Eric Janouch <p@janouch.name>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+// OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+// CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+
+#include "config.h"
+
+#include <gio/gio.h>
+#include <glib.h>
+#include <stdbool.h>
+
+#include "fiv-io.h"
+
+// GThreadPool can sort its queue, but it offers no way for a thread waiting
+// on some of its jobs to run them, which would risk deadlocks
+// with nested parallelism, and stall the interactive thread.
+
+// Worker threads that have had nothing to do for this long will exit.
+#define WORK_IDLE_TIMEOUT (15 * G_TIME_SPAN_SECOND)
+
+typedef struct {
+	FivIoWorkPriority priority;         ///< Queue the job belongs to
+	FivIoWorkFunc func;                 ///< Job function
+	gpointer data;                      ///< Job data
+	GDestroyNotify destroy;             ///< Job data destructor
+	GCancellable *cancellable;          ///< Skips the job when cancelled
+} FivIoWork;
+
+static struct {
+	GMutex lock;                        ///< Protects everything but "busy"
+	GCond cond;                         ///< Signals newly queued work
+	GQueue queues[FivIoWorkPriorityCount];  ///< Queued FivIoWork
+	guint queued;                       ///< Total length of all queues
+	guint threads;                      ///< Running worker threads
+	guint idle;                         ///< Worker threads waiting for work
+	guint budget;                       ///< Maximum number of worker threads
+	gint busy;                          ///< Jobs being run, atomic
+} work;
+
+// The priority of the job running in the current thread, plus one.
+static GPrivate work_current;
+
+static guint
+work_budget_locked(void)
+{
+	if (!work.budget)
+		work.budget = MAX(1, g_get_num_processors());
+	return work.budget;
+}
+
+static FivIoWork *
+work_pop_locked(void)
+{
+	for (int i = 0; i < FivIoWorkPriorityCount; i++) {
+		FivIoWork *w = g_queue_pop_head(&work.queues[i]);
+		if (w) {
+			work.queued--;
+			return w;
+		}
+	}
+	return NULL;
+}
+
+static void
+work_run(FivIoWork *w)
+{
+	gpointer saved = g_private_get(&work_current);
+	g_private_set(&work_current, GINT_TO_POINTER(w->priority + 1));
+	g_atomic_int_inc(&work.busy);
+	if (!g_cancellable_is_cancelled(w->cancellable))
+		w->func(w->data, w->cancellable);
+	(void) g_atomic_int_dec_and_test(&work.busy);
+	g_private_set(&work_current, saved);
+
+	if (w->destroy)
+		w->destroy(w->data);
+	g_clear_object(&w->cancellable);
+	g_free(w);
+}
+
+static gpointer
+work_thread(G_GNUC_UNUSED gpointer data)
+{
+	g_mutex_lock(&work.lock);
+	while (true) {
+		FivIoWork *w = work_pop_locked();
+		if (w) {
+			g_mutex_unlock(&work.lock);
+			work_run(w);
+			g_mutex_lock(&work.lock);
+			continue;
+		}
+
+		work.idle++;
+		gint64 end_time = g_get_monotonic_time() + WORK_IDLE_TIMEOUT;
+		bool timed_out = !g_cond_wait_until(&work.cond, &work.lock, end_time);
+		work.idle--;
+		if (timed_out && !work.queued)
+			break;
+	}
+	work.threads--;
+	g_mutex_unlock(&work.lock);
+	return NULL;
+}
+
+static void
+work_queue(FivIoWork *w)
+{
+	g_mutex_lock(&work.lock);
+	g_queue_push_tail(&work.queues[w->priority], w);
+	if (++work.queued > work.idle && work.threads < work_budget_locked()) {
+		work.threads++;
+		g_thread_unref(g_thread_new("fiv-work", work_thread, NULL));
+	}
+	g_cond_signal(&work.cond);
+	g_mutex_unlock(&work.lock);
+}
+
+void
+fiv_io_work_push(FivIoWorkPriority priority, GCancellable *cancellable,
+	FivIoWorkFunc func, gpointer data, GDestroyNotify destroy)
+{
+	g_return_if_fail((unsigned) priority < FivIoWorkPriorityCount);
+
+	FivIoWork *w = g_new0(FivIoWork, 1);
+	w->priority = priority;
+	w->func = func;
+	w->data = data;
+	w->destroy = destroy;
+	if (cancellable)
+		w->cancellable = g_object_ref(cancellable);
+	work_queue(w);
+}
+
+guint
+fiv_io_work_threads(void)
+{
+	g_mutex_lock(&work.lock);
+	gint budget = work_budget_locked();
+	g_mutex_unlock(&work.lock);
+
+	// The calling job is included in the count, if there is one.
+	gint others = g_atomic_int_get(&work.busy) -
+		!!g_private_get(&work_current);
+	return CLAMP(budget - others, 1, budget);
+}
+
+// --- Tasks -------------------------------------------------------------------
+
+typedef struct {
+	GTask *task;                        ///< The task to run
+	GTaskThreadFunc func;               ///< The task's thread function
+	bool ran;                           ///< The job hasn't been skipped
+} WorkTask;
+
+static void
+work_task_free(WorkTask *self)
+{
+	// Tasks always need to return, even if they didn't get to run.
+	if (!self->ran)
+		g_task_return_error_if_cancelled(self->task);
+	g_object_unref(self->task);
+	g_free(self);
+}
+
+static void
+work_task_run(gpointer data, G_GNUC_UNUSED GCancellable *cancellable)
+{
+	WorkTask *self = data;
+	self->ran = true;
+	if (!g_task_return_error_if_cancelled(self->task)) {
+		self->func(self->task, g_task_get_source_object(self->task),
+			g_task_get_task_data(self->task),
+			g_task_get_cancellable(self->task));
+	}
+}
+
+void
+fiv_io_work_run_task(
+	GTask *task, FivIoWorkPriority priority, GTaskThreadFunc func)
+{
+	WorkTask *self = g_new0(WorkTask, 1);
+	self->task = g_object_ref(task);
+	self->func = func;
+	fiv_io_work_push(priority, g_task_get_cancellable(task),
+		work_task_run, self, (GDestroyNotify) work_task_free);
+}
+
+// --- Parallel loops ----------------------------------------------------------
+
+typedef struct {
+	gint ref_count;                     ///< Reference count
+	void (*func)(gpointer, guint);      ///< Loop body
+	gpointer data;                      ///< Loop body data
+	guint n;                            ///< Number of iterations
+	gint next;                          ///< The next iteration, atomic
+
+	GMutex lock;                        ///< Protects "done"
+	GCond cond;                         ///< Signals "done" changes
+	guint done;                         ///< Finished iterations
+} WorkLoop;
+
+static void
+work_loop_unref(WorkLoop *self)
+{
+	if (!g_atomic_int_dec_and_test(&self->ref_count))
+		return;
+
+	g_mutex_clear(&self->lock);
+	g_cond_clear(&self->cond);
+	g_free(self);
+}
+
+static void
+work_loop_run(gpointer data, G_GNUC_UNUSED GCancellable *cancellable)
+{
+	// Helpers that start late will find nothing left to do.
+	WorkLoop *self = data;
+	guint i = 0, done = 0;
+	while ((i = g_atomic_int_add(&self->next, 1)) < self->n) {
+		self->func(self->data, i);
+		done++;
+	}
+	if (!done)
+		return;
+
+	g_mutex_lock(&self->lock);
+	if ((self->done += done) == self->n)
+		g_cond_signal(&self->cond);
+	g_mutex_unlock(&self->lock);
+}
+
+void
+fiv_io_work_parallel(guint n, void (*func)(gpointer data, guint index),
+	gpointer data)
+{
+	if (!n)
+		return;
+
+	// Helpers inherit the priority of the calling job, and anything
+	// waiting outside of the pool is assumed to be interactive.
+	gpointer current = g_private_get(&work_current);
+	FivIoWorkPriority priority =
+		current ? GPOINTER_TO_INT(current) - 1 : FivIoWorkInteractive;
+
+	WorkLoop *self = g_new0(WorkLoop, 1);
+	self->ref_count = 1;
+	self->func = func;
+	self->data = data;
+	self->n = n;
+	g_mutex_init(&self->lock);
+	g_cond_init(&self->cond);
+
+	guint helpers = MIN(n, fiv_io_work_threads()) - 1;
+	for (guint i = 0; i < helpers; i++) {
+		g_atomic_int_inc(&self->ref_count);
+		fiv_io_work_push(priority, NULL,
+			work_loop_run, self, (GDestroyNotify) work_loop_unref);
+	}
+
+	// The calling thread takes part, so that progress is always made.
+	work_loop_run(self, NULL);
+
+	g_mutex_lock(&self->lock);
+	while (self->done < self->n)
+		g_cond_wait(&self->cond, &self->lock);
+	g_mutex_unlock(&self->lock);
+	work_loop_unref(self);
+}
@@ -24,6 +24,10 @@
 
 #include <cairo.h>
 #include <glib.h>
+#include <glib/gstdio.h>
+#ifdef G_OS_UNIX
+#include <sys/mman.h>
+#endif  // G_OS_UNIX
 #include <jpeglib.h>
 #include <turbojpeg.h>
 #include <webp/decode.h>
@@ -37,6 +41,7 @@
 #define TIFF_TABLES_CONSTANTS_ONLY
 #include "tiff-tables.h"
 #include "tiffer.h"
+#include "xdg.h"
 
 #ifdef HAVE_LIBRAW
 #include <libraw.h>
@@ -79,8 +84,10 @@
 #define WUFFS_CONFIG__MODULE__DEFLATE
 #define WUFFS_CONFIG__MODULE__GIF
 #define WUFFS_CONFIG__MODULE__LZW
+#define WUFFS_CONFIG__MODULE__NIE
 #define WUFFS_CONFIG__MODULE__PNG
 #define WUFFS_CONFIG__MODULE__TGA
+#define WUFFS_CONFIG__MODULE__WBMP
 #define WUFFS_CONFIG__MODULE__ZLIB
 #include "submodules/wuffs-mirror-release-c/release/c/wuffs-v0.3.c"
 
@@ -100,6 +107,7 @@ const char *fiv_io_supported_media_types[] = {
 	"image/x-tga",
 	"image/jpeg",
 	"image/webp",
+	"image/vnd.wap.wbmp",
 #ifdef HAVE_LIBRAW
 	"image/x-dcraw",
 #endif  // HAVE_LIBRAW
@@ -147,6 +155,97 @@ fiv_io_all_supported_media_types(void)
 	return (gchar **) g_ptr_array_free(types, FALSE);
 }
 
+// Everything that the result of fiv_io_all_supported_globs() depends on,
+// other than the shared-mime-info files themselves.
+static gchar *
+supported_globs_stamp(void)
+{
+	GString *stamp = g_string_new(PROJECT_VERSION "\n");
+	for (const char **p = fiv_io_supported_media_types; *p; p++)
+		g_string_append_printf(stamp, "%s\n", *p);
+
+#ifdef HAVE_GDKPIXBUF
+	// gdk-pixbuf offers no better way of finding out
+	// whether its set of loaders has changed.
+	const char *loaders = g_getenv("GDK_PIXBUF_MODULE_FILE");
+	if (!loaders || !*loaders)
+		loaders = GDK_PIXBUF_CACHE_FILE;
+
+	GStatBuf st = {};
+	if (*loaders && !g_stat(loaders, &st)) {
+		g_string_append_printf(stamp, "%s %lld %lld\n", loaders,
+			(long long) st.st_mtime, (long long) st.st_size);
+	}
+#endif  // HAVE_GDKPIXBUF
+
+	gchar *mime = get_mime_globs_stamp();
+	g_string_append(stamp, mime);
+	g_free(mime);
+	return g_string_free(stamp, FALSE);
+}
+
+static gchar *
+get_cache_path(const char *name)
+{
+#ifdef G_OS_WIN32
+	gchar *cache_dir = g_strdup(g_get_user_cache_dir());
+#else
+	gchar *cache_dir = get_xdg_home_dir("XDG_CACHE_HOME", ".cache");
+#endif
+	gchar *path = g_build_filename(cache_dir, PROJECT_NAME, name, NULL);
+	g_free(cache_dir);
+	return path;
+}
+
+gchar **
+fiv_io_all_supported_globs(void)
+{
+	gchar *stamp = supported_globs_stamp();
+	gchar *checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, stamp, -1);
+	g_free(stamp);
+
+	// Reading shared-mime-info files and initializing gdk-pixbuf loaders
+	// is noticeable on start-up, so the result is cached on disk.
+	gchar *path = get_cache_path("supported-globs");
+	GKeyFile *kf = g_key_file_new();
+	gchar **globs = NULL;
+	if (g_key_file_load_from_file(kf, path, G_KEY_FILE_NONE, NULL)) {
+		gchar *cached = g_key_file_get_string(kf, "Cache", "Stamp", NULL);
+		if (!g_strcmp0(cached, checksum))
+			globs = g_key_file_get_string_list(
+				kf, "Cache", "Globs", NULL, NULL);
+		g_free(cached);
+	}
+	if (globs)
+		goto out;
+
+	gchar **types = fiv_io_all_supported_media_types();
+	globs = extract_mime_globs((const char **) types);
+
+	g_strfreev(types);
+
+	g_key_file_set_string(kf, "Cache", "Stamp", checksum);
+	g_key_file_set_string_list(kf, "Cache", "Globs",
+		(const gchar *const *) globs, g_strv_length(globs));
+
+	// Failing to write the cache is not a reason to fail.
+	GError *error = NULL;
+	gchar *dirname = g_path_get_dirname(path);
+	if (g_mkdir_with_parents(dirname, 0755) ||
+		!g_key_file_save_to_file(kf, path, &error)) {
+		g_debug("%s: %s", path,
+			error ? error->message : g_strerror(errno));
+		g_clear_error(&error);
+	}
+	g_free(dirname);
+
+out:
+	g_key_file_free(kf);
+	g_free(checksum);
+	g_free(path);
+	return globs;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #define FIV_IO_ERROR fiv_io_error_quark()
@@ -179,6 +278,178 @@ add_warning(const FivIoOpenContext *ctx, const char *format, ...)
 }
 
 // --- Images ------------------------------------------------------------------
+// Browsing through photos of the same size would otherwise keep mapping
+// and unmapping the same large amounts of memory, faulting it all in again.
+// Large buffers are thus rounded up to size classes, and released ones
+// are retained for reuse, while the system may reclaim their pages.
+
+#define IMAGE_POOL_MIN    ((size_t) 1 << 20)    ///< Smaller ones use malloc
+#define IMAGE_POOL_CLASS  ((size_t) 2 << 20)    ///< Usual huge page size
+#define IMAGE_POOL_BUDGET ((size_t) 512 << 20)  ///< Retention limit
+
+typedef struct {
+	uint8_t *data;                      ///< Released buffer
+	size_t size;                        ///< Its allocated size
+} ImageBuffer;
+
+static struct {
+	GMutex lock;                        ///< Protects everything
+	GQueue retained;                    ///< ImageBuffer, most recent first
+	FivIoImagePoolStats stats;          ///< Statistics
+} image_pool;
+
+static size_t
+image_buffer_class(size_t size)
+{
+	if (size < IMAGE_POOL_MIN || size > SIZE_MAX - IMAGE_POOL_CLASS)
+		return size;
+	return (size + IMAGE_POOL_CLASS - 1) / IMAGE_POOL_CLASS * IMAGE_POOL_CLASS;
+}
+
+static uint8_t *
+image_buffer_map(size_t size)
+{
+#ifdef G_OS_UNIX
+	void *data = mmap(NULL, size,
+		PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (data == MAP_FAILED)
+		return NULL;
+#ifdef MADV_HUGEPAGE
+	// Fewer, larger pages mean fewer page faults.
+	(void) madvise(data, size, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+	return data;
+#else
+	return g_try_malloc0(size);
+#endif  // G_OS_UNIX
+}
+
+static void
+image_buffer_unmap(uint8_t *data, size_t size)
+{
+#ifdef G_OS_UNIX
+	munmap(data, size);
+#else
+	(void) size;
+	g_free(data);
+#endif  // G_OS_UNIX
+}
+
+// Returns zero-initialized memory, like g_try_malloc0(), or NULL.
+static uint8_t *
+image_buffer_alloc(size_t size, size_t *allocated)
+{
+	*allocated = 0;
+	if (size < IMAGE_POOL_MIN) {
+		uint8_t *data = g_try_malloc0(size);
+		if (data)
+			*allocated = size;
+		return data;
+	}
+
+	size_t class = image_buffer_class(size);
+	ImageBuffer *buffer = NULL;
+	g_mutex_lock(&image_pool.lock);
+	for (GList *link = image_pool.retained.head; link; link = link->next) {
+		if (((ImageBuffer *) link->data)->size == class) {
+			buffer = link->data;
+			g_queue_delete_link(&image_pool.retained, link);
+			image_pool.stats.retained -= class;
+			image_pool.stats.retained_buffers--;
+			break;
+		}
+	}
+	if (buffer)
+		image_pool.stats.hits++;
+	else
+		image_pool.stats.misses++;
+	g_mutex_unlock(&image_pool.lock);
+
+	uint8_t *data = NULL;
+	if (buffer) {
+		// The pages may or may not have been reclaimed in the meantime.
+		data = buffer->data;
+		memset(data, 0, size);
+		g_free(buffer);
+	} else if (!(data = image_buffer_map(class))) {
+		return NULL;
+	}
+
+	*allocated = class;
+	return data;
+}
+
+// Like realloc() to a smaller size, except that it may not move the data.
+static uint8_t *
+image_buffer_shrink(uint8_t *data, size_t *allocated, size_t size)
+{
+	if (*allocated < IMAGE_POOL_MIN) {
+		*allocated = size;
+		return g_realloc(data, size);
+	}
+
+	size_t class = image_buffer_class(size);
+	if (class < IMAGE_POOL_MIN || class >= *allocated)
+		return data;
+
+#ifdef G_OS_UNIX
+	munmap(data + class, *allocated - class);
+#else
+	data = g_realloc(data, class);
+#endif  // G_OS_UNIX
+	*allocated = class;
+	return data;
+}
+
+static void
+image_buffer_free(uint8_t *data, size_t allocated)
+{
+	if (allocated < IMAGE_POOL_MIN) {
+		g_free(data);
+		return;
+	}
+	if (allocated > IMAGE_POOL_BUDGET) {
+		image_buffer_unmap(data, allocated);
+		return;
+	}
+
+#ifdef MADV_FREE
+	// The system may take the pages back, but only when it runs short.
+	(void) madvise(data, allocated, MADV_FREE);
+#endif  // MADV_FREE
+
+	ImageBuffer *buffer = g_new(ImageBuffer, 1);
+	buffer->data = data;
+	buffer->size = allocated;
+
+	GQueue evicted = G_QUEUE_INIT;
+	g_mutex_lock(&image_pool.lock);
+	g_queue_push_head(&image_pool.retained, buffer);
+	image_pool.stats.retained += allocated;
+	image_pool.stats.retained_buffers++;
+	while (image_pool.stats.retained > IMAGE_POOL_BUDGET) {
+		ImageBuffer *oldest = g_queue_pop_tail(&image_pool.retained);
+		image_pool.stats.retained -= oldest->size;
+		image_pool.stats.retained_buffers--;
+		image_pool.stats.evictions++;
+		g_queue_push_tail(&evicted, oldest);
+	}
+	g_mutex_unlock(&image_pool.lock);
+
+	// Unmapping can take a while, so do it outside of the lock.
+	while ((buffer = g_queue_pop_head(&evicted))) {
+		image_buffer_unmap(buffer->data, buffer->size);
+		g_free(buffer);
+	}
+}
+
+void
+fiv_io_image_pool_stats(FivIoImagePoolStats *stats)
+{
+	g_mutex_lock(&image_pool.lock);
+	*stats = image_pool.stats;
+	g_mutex_unlock(&image_pool.lock);
+}
 
 FivIoImage *
 fiv_io_image_new(cairo_format_t format, uint32_t width, uint32_t height)
@@ -203,12 +474,14 @@ fiv_io_image_new(cairo_format_t format, uint32_t width, uint32_t height)
 		return NULL;
 	}
 
-	uint8_t *data = g_try_malloc0(unit * width * height);
+	size_t allocated = 0;
+	uint8_t *data = image_buffer_alloc(unit * width * height, &allocated);
 	if (!data)
 		return NULL;
 
 	FivIoImage *image = g_rc_box_new0(FivIoImage);
 	image->data = data;
+	image->data_size = allocated;
 	image->format = format;
 	image->width = width;
 	image->stride = width * unit;
@@ -225,7 +498,7 @@ fiv_io_image_ref(FivIoImage *self)
 static void
 fiv_io_image_finalize(FivIoImage *image)
 {
-	g_free(image->data);
+	image_buffer_free(image->data, image->data_size);
 
 	g_bytes_unref(image->exif);
 	g_bytes_unref(image->icc);
@@ -237,6 +510,8 @@ fiv_io_image_finalize(FivIoImage *image)
 
 	if (image->render)
 		image->render->destroy(image->render);
+	if (image->deferred)
+		image->deferred->destroy(image->deferred);
 
 	if (image->page_next)
 		fiv_io_image_unref(image->page_next);
@@ -250,6 +525,23 @@ fiv_io_image_unref(FivIoImage *self)
 	g_rc_box_release_full(self, (GDestroyNotify) fiv_io_image_finalize);
 }
 
+gboolean
+fiv_io_image_undefer(FivIoImage *page,
+	FivIoCmm *cmm, FivIoProfile *target, GError **error)
+{
+	FivIoDeferred *deferred = page->deferred;
+	if (!deferred)
+		return TRUE;
+
+	// Whatever the outcome, there is no point in trying again.
+	page->deferred = NULL;
+	gboolean ok = deferred->load(deferred, page, error);
+	deferred->destroy(deferred);
+	if (ok && target)
+		fiv_io_cmm_page(cmm, page, target, fiv_io_cmm_any);
+	return ok;
+}
+
 cairo_surface_t *
 fiv_io_image_to_surface_noref(const FivIoImage *image)
 {
@@ -415,7 +707,6 @@ load_wuffs_frame(struct load_wuffs_frame_context *ctx, GError **error)
 			WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL)
 		decode_format = CAIRO_FORMAT_ARGB32;
 
-	unsigned char *targetbuf = NULL;
 	FivIoImage *image =
 		fiv_io_image_new(decode_format, ctx->width, ctx->height);
 	if (!image) {
@@ -423,20 +714,29 @@ load_wuffs_frame(struct load_wuffs_frame_context *ctx, GError **error)
 		goto fail;
 	}
 
-	// There is no padding with ARGB/BGR/XRGB/BGRX.
+	// Wide formats are decoded straight into the image's own buffer,
+	// then converted in place. RGB30 needs it to be temporarily larger.
+	// There is no padding with ARGB/BGR/XRGB/BGRX, nor 4X16LE.
 	// This function does not support a stride different from the width,
 	// maybe Wuffs internals do not either.
-	wuffs_base__pixel_buffer pb = {0};
-	if (ctx->expand_16_float || ctx->pack_16_10) {
-		uint32_t targetbuf_size = image->height * image->width * 8;
-		targetbuf = g_malloc(targetbuf_size);
-		status = wuffs_base__pixel_buffer__set_from_slice(&pb, &ctx->cfg.pixcfg,
-			wuffs_base__make_slice_u8(targetbuf, targetbuf_size));
-	} else {
-		status = wuffs_base__pixel_buffer__set_from_slice(&pb, &ctx->cfg.pixcfg,
-			wuffs_base__make_slice_u8(
-				image->data, image->stride * image->height));
+	size_t pixels = (size_t) image->width * image->height;
+	wuffs_base__slice_u8 target = wuffs_base__make_slice_u8(
+		image->data, (size_t) image->stride * image->height);
+	if (ctx->pack_16_10) {
+		image_buffer_free(image->data, image->data_size);
+		image->data = image_buffer_alloc(pixels * 8, &image->data_size);
+		if (!image->data) {
+			set_error(error, "image allocation failure");
+			goto fail;
+		}
+		target = wuffs_base__make_slice_u8(image->data, pixels * 8);
+	} else if (ctx->expand_16_float) {
+		target = wuffs_base__make_slice_u8(image->data, pixels * 8);
 	}
+
+	wuffs_base__pixel_buffer pb = {0};
+	status = wuffs_base__pixel_buffer__set_from_slice(
+		&pb, &ctx->cfg.pixcfg, target);
 	if (!wuffs_base__status__is_ok(&status)) {
 		set_error(error, wuffs_base__status__message(&status));
 		goto fail;
@@ -453,8 +753,8 @@ load_wuffs_frame(struct load_wuffs_frame_context *ctx, GError **error)
 
 	if (ctx->target) {
 		if (ctx->expand_16_float || ctx->pack_16_10) {
-			fiv_io_cmm_4x16le_direct(ctx->cmm,
-				targetbuf, ctx->width, ctx->height, ctx->source, ctx->target);
+			fiv_io_cmm_4x16le_direct(ctx->cmm, image->data,
+				ctx->width, ctx->height, ctx->source, ctx->target);
 			// The first one premultiplies below, the second doesn't need to.
 		} else {
 			fiv_io_cmm_argb32_premultiply(
@@ -462,31 +762,32 @@ load_wuffs_frame(struct load_wuffs_frame_context *ctx, GError **error)
 		}
 	}
 
+	// The source and the destination overlap, so go from the end,
+	// and only read through memcpy() to avoid type punning issues.
+	uint16_t in[4] = {};
 	if (ctx->expand_16_float) {
 		g_debug("Wuffs to Cairo RGBA128F");
-		uint16_t *in = (uint16_t *) targetbuf;
 		float *out = (float *) image->data;
-		for (uint32_t y = 0; y < image->height; y++) {
-			for (uint32_t x = 0; x < image->width; x++) {
-				float b = *in++ / 65535., g = *in++ / 65535.,
-					r = *in++ / 65535., a = *in++ / 65535.;
-				*out++ = r * a;
-				*out++ = g * a;
-				*out++ = b * a;
-				*out++ = a;
-			}
+		for (size_t i = pixels; i--; ) {
+			memcpy(in, image->data + i * sizeof in, sizeof in);
+			float b = in[0] / 65535., g = in[1] / 65535.,
+				r = in[2] / 65535., a = in[3] / 65535.;
+			out[i * 4 + 0] = r * a;
+			out[i * 4 + 1] = g * a;
+			out[i * 4 + 2] = b * a;
+			out[i * 4 + 3] = a;
 		}
 	} else if (ctx->pack_16_10) {
 		g_debug("Wuffs to Cairo RGB30");
-		uint16_t *in = (uint16_t *) targetbuf;
 		uint32_t *out = (uint32_t *) image->data;
-		for (uint32_t y = 0; y < image->height; y++) {
-			for (uint32_t x = 0; x < image->width; x++) {
-				uint32_t b = *in++, g = *in++, r = *in++, X = *in++;
-				*out++ = (X >> 14) << 30 |
-					(r >> 6) << 20 | (g >> 6) << 10 | (b >> 6);
-			}
+		for (size_t i = 0; i < pixels; i++) {
+			memcpy(in, image->data + i * sizeof in, sizeof in);
+			uint32_t b = in[0], g = in[1], r = in[2], X = in[3];
+			out[i] = (X >> 14) << 30 |
+				(r >> 6) << 20 | (g >> 6) << 10 | (b >> 6);
 		}
+		image->data =
+			image_buffer_shrink(image->data, &image->data_size, pixels * 4);
 	}
 
 	// Single-frame images get a fast path, animations are are handled slowly:
@@ -577,14 +878,12 @@ load_wuffs_frame(struct load_wuffs_frame_context *ctx, GError **error)
 
 	ctx->result_tail = image;
 	ctx->last_fc = fc;
-	g_free(targetbuf);
 	return wuffs_base__status__is_ok(&status);
 
 fail:
 	g_clear_pointer(&image, fiv_io_image_unref);
 	g_clear_pointer(&ctx->result, fiv_io_image_unref);
 	ctx->result_tail = NULL;
-	g_free(targetbuf);
 	return false;
 }
 
@@ -750,9 +1049,14 @@ open_wuffs(wuffs_base__image_decoder *dec, wuffs_base__io_buffer src,
 		}
 	}
 
-	while (load_wuffs_frame(&ctx, error))
+	while (load_wuffs_frame(&ctx, error)) {
 		if (ioctx->first_frame_only)
 			break;
+		if (g_cancellable_set_error_if_cancelled(ioctx->cancellable, error)) {
+			g_clear_pointer(&ctx.result, fiv_io_image_unref);
+			break;
+		}
+	}
 
 	// Wrap the chain around, since our caller receives only one pointer.
 	if (ctx.result)
@@ -1240,7 +1544,8 @@ load_jpeg_finalize(FivIoImage *image, bool cmyk,
 		// XXX: This is ugly, as it relies on just the first individual image
 		// having any follow-up entries (as it should be).
 		FivIoImage *image_tail = image;
-		for (guint i = 0; i < meta.mpf->len; i++) {
+		for (guint i = 0; i < meta.mpf->len &&
+			!g_cancellable_is_cancelled(ctx->cancellable); i++) {
 			const char *jpeg = meta.mpf->pdata[i];
 			GError *error = NULL;
 			if (!try_append_page(
@@ -1387,19 +1692,200 @@ load_libjpeg_turbo(const char *data, gsize len, const FivIoOpenContext *ctx,
 	return image;
 }
 
+static void
+load_libjpeg_check_cancelled(struct jpeg_decompress_struct *cinfo)
+{
+	struct libjpeg_error_mgr *err = (struct libjpeg_error_mgr *) cinfo->err;
+	if (g_cancellable_set_error_if_cancelled(err->ctx->cancellable, err->error))
+		longjmp(err->buf, 1);
+}
+
 static void
 load_libjpeg_simple(
 	struct jpeg_decompress_struct *cinfo, JSAMPARRAY lines)
 {
 	(void) jpeg_start_decompress(cinfo);
-	while (cinfo->output_scanline < cinfo->output_height)
+	while (cinfo->output_scanline < cinfo->output_height) {
+		load_libjpeg_check_cancelled(cinfo);
 		(void) jpeg_read_scanlines(cinfo, lines + cinfo->output_scanline,
 			cinfo->output_height - cinfo->output_scanline);
+	}
 	(void) jpeg_finish_decompress(cinfo);
 }
 
 #ifdef HAVE_JPEG_QS
 
+// Enhancement takes seconds, so its results are cached on disk,
+// prior to colour management, as lossless WebP files.
+#define ENHANCED_CACHE_BUDGET (512 << 20)
+
+static gchar *
+enhanced_cache_path(struct jpeg_decompress_struct *cinfo,
+	const jpegqs_control_t *opts)
+{
+	const FivIoOpenContext *ctx =
+		((struct libjpeg_error_mgr *) cinfo->err)->ctx;
+	if (!ctx->uri)
+		return NULL;
+
+	GFile *file = g_file_new_for_uri(ctx->uri);
+	GFileInfo *info = g_file_query_info(file,
+		G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+		G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+		G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+		G_FILE_QUERY_INFO_NONE, NULL, NULL);
+	g_object_unref(file);
+	if (!info ||
+		!g_file_info_has_attribute(info, G_FILE_ATTRIBUTE_TIME_MODIFIED)) {
+		g_clear_object(&info);
+		return NULL;
+	}
+
+	gchar *key = g_strdup_printf("%s\n%" G_GUINT64_FORMAT ".%06u %"
+		G_GOFFSET_FORMAT "\n%u %u %d %d", ctx->uri,
+		g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+		g_file_info_get_attribute_uint32(
+			info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC),
+		g_file_info_get_size(info), cinfo->output_width,
+		cinfo->output_height, opts->flags, opts->niter);
+	g_object_unref(info);
+
+	gchar *sum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key, -1);
+	gchar *name = g_strconcat("enhanced" G_DIR_SEPARATOR_S, sum, ".webp", NULL);
+	gchar *path = get_cache_path(name);
+	g_free(name);
+	g_free(sum);
+	g_free(key);
+	return path;
+}
+
+static bool
+enhanced_cache_load(const char *path,
+	struct jpeg_decompress_struct *cinfo, JSAMPARRAY lines)
+{
+	gchar *data = NULL;
+	gsize len = 0;
+	if (!g_file_get_contents(path, &data, &len, NULL))
+		return false;
+
+	int width = 0, height = 0;
+	uint8_t *pixels = NULL;
+	if (G_BYTE_ORDER == G_BIG_ENDIAN)
+		pixels = WebPDecodeARGB((const uint8_t *) data, len, &width, &height);
+	else
+		pixels = WebPDecodeBGRA((const uint8_t *) data, len, &width, &height);
+	g_free(data);
+	if (!pixels)
+		return false;
+
+	bool ok = width == (int) cinfo->output_width &&
+		height == (int) cinfo->output_height;
+	for (int y = 0; ok && y < height; y++)
+		memcpy(lines[y], pixels + (size_t) y * width * 4, width * 4);
+	WebPFree(pixels);
+
+	// Keep recently used renditions from being evicted.
+	if (ok)
+		(void) g_utime(path, NULL);
+	return ok;
+}
+
+typedef struct {
+	gchar *path;                        ///< Full path to the file
+	GStatBuf st;                        ///< Its size and last use
+} EnhancedCacheEntry;
+
+static int
+enhanced_cache_entry_compare(const void *a, const void *b)
+{
+	const EnhancedCacheEntry *ea = a, *eb = b;
+	return (ea->st.st_mtime > eb->st.st_mtime) -
+		(ea->st.st_mtime < eb->st.st_mtime);
+}
+
+// Removes the least recently used renditions once over budget.
+static void
+enhanced_cache_trim(const char *dirname)
+{
+	GDir *dir = g_dir_open(dirname, 0, NULL);
+	if (!dir)
+		return;
+
+	GArray *entries = g_array_new(FALSE, FALSE, sizeof(EnhancedCacheEntry));
+	guint64 total = 0;
+	const gchar *name = NULL;
+	while ((name = g_dir_read_name(dir))) {
+		EnhancedCacheEntry entry = {
+			.path = g_build_filename(dirname, name, NULL)};
+		if (!g_str_has_suffix(name, ".webp") || g_stat(entry.path, &entry.st)) {
+			g_free(entry.path);
+			continue;
+		}
+
+		total += entry.st.st_size;
+		g_array_append_val(entries, entry);
+	}
+	g_dir_close(dir);
+
+	g_array_sort(entries, enhanced_cache_entry_compare);
+	for (guint i = 0; i < entries->len; i++) {
+		EnhancedCacheEntry *entry =
+			&g_array_index(entries, EnhancedCacheEntry, i);
+		if (total > ENHANCED_CACHE_BUDGET && !g_unlink(entry->path))
+			total -= entry->st.st_size;
+		g_free(entry->path);
+	}
+	g_array_free(entries, TRUE);
+}
+
+static void
+enhanced_cache_store(const char *path,
+	struct jpeg_decompress_struct *cinfo, JSAMPARRAY lines)
+{
+	WebPConfig config = {};
+	WebPPicture picture = {};
+	if (!WebPConfigInit(&config) || !WebPConfigLosslessPreset(&config, 1) ||
+		!WebPPictureInit(&picture))
+		return;
+
+	picture.use_argb = true;
+	picture.width = cinfo->output_width;
+	picture.height = cinfo->output_height;
+	if (!WebPPictureAlloc(&picture))
+		return;
+
+	// Cairo's RGB24 matches WebP's native ARGB, except for the alpha channel.
+	for (int y = 0; y < picture.height; y++) {
+		const uint32_t *in = (const uint32_t *) lines[y];
+		uint32_t *out = picture.argb + (size_t) y * picture.argb_stride;
+		for (int x = 0; x < picture.width; x++)
+			out[x] = in[x] | 0xFF000000;
+	}
+
+	WebPMemoryWriter writer = {};
+	WebPMemoryWriterInit(&writer);
+	picture.writer = WebPMemoryWrite;
+	picture.custom_ptr = &writer;
+	bool ok = WebPEncode(&config, &picture);
+	WebPPictureFree(&picture);
+
+	// Failing to write the cache is not a reason to fail.
+	GError *error = NULL;
+	gchar *dirname = g_path_get_dirname(path);
+	if (!ok) {
+		g_debug("WebPEncode: %d", picture.error_code);
+	} else if (g_mkdir_with_parents(dirname, 0755) ||
+		!g_file_set_contents(
+			path, (const gchar *) writer.mem, writer.size, &error)) {
+		g_debug("%s: %s", path, error ? error->message : g_strerror(errno));
+		g_clear_error(&error);
+	} else {
+		enhanced_cache_trim(dirname);
+	}
+	g_free(dirname);
+	WebPMemoryWriterClear(&writer);
+}
+
 static void
 load_libjpeg_enhanced(
 	struct jpeg_decompress_struct *cinfo, JSAMPARRAY lines)
@@ -1407,7 +1893,7 @@ load_libjpeg_enhanced(
 	// Go for the maximum quality setting.
 	jpegqs_control_t opts = {
 		.flags = JPEGQS_DIAGONALS | JPEGQS_JOINT_YUV,
-		.threads = g_get_num_processors(),
+		.threads = fiv_io_work_threads(),
 		.niter = 3,
 	};
 
@@ -1416,11 +1902,28 @@ load_libjpeg_enhanced(
 	opts.flags |= JPEGQS_UPSAMPLE_UV;
 #endif
 
+	// Once started, the smoothing can't be interrupted.
+	load_libjpeg_check_cancelled(cinfo);
+
+	// CMYK data would not survive a trip through WebP.
+	gchar *cache_path = NULL;
+	if (cinfo->out_color_space != JCS_CMYK)
+		cache_path = enhanced_cache_path(cinfo, &opts);
+	if (cache_path && enhanced_cache_load(cache_path, cinfo, lines)) {
+		jpeg_abort_decompress(cinfo);
+		g_free(cache_path);
+		return;
+	}
+
 	(void) jpegqs_start_decompress(cinfo, &opts);
 	while (cinfo->output_scanline < cinfo->output_height)
 		(void) jpeg_read_scanlines(cinfo, lines + cinfo->output_scanline,
 			cinfo->output_height - cinfo->output_scanline);
 	(void) jpegqs_finish_decompress(cinfo);
+
+	if (cache_path)
+		enhanced_cache_store(cache_path, cinfo, lines);
+	g_free(cache_path);
 }
 
 #else
@@ -1475,7 +1978,7 @@ load_libwebp_nonanimated(WebPDecoderConfig *config, const WebPData *wd,
 		return NULL;
 	}
 
-	config->options.use_threads = true;
+	config->options.use_threads = fiv_io_work_threads() > 1;
 
 	config->output.width = config->input.width;
 	config->output.height = config->input.height;
@@ -1570,7 +2073,7 @@ load_libwebp_animated(
 	bool premultiply = !ctx->screen_profile;
 	WebPAnimDecoderOptions options = {};
 	WebPAnimDecoderOptionsInit(&options);
-	options.use_threads = true;
+	options.use_threads = fiv_io_work_threads() > 1;
 	options.color_mode = premultiply ? MODE_bgrA : MODE_BGRA;
 
 	WebPAnimInfo info = {};
@@ -1585,9 +2088,9 @@ load_libwebp_animated(
 
 	int last_timestamp = 0;
 	while (WebPAnimDecoderHasMoreFrames(dec)) {
-		FivIoImage *image =
-			load_libwebp_frame(dec, &info, &last_timestamp, error);
-		if (!image) {
+		FivIoImage *image = NULL;
+		if (g_cancellable_set_error_if_cancelled(ctx->cancellable, error) ||
+			!(image = load_libwebp_frame(dec, &info, &last_timestamp, error))) {
 			g_clear_pointer(&frames, fiv_io_image_unref);
 			goto fail;
 		}
@@ -1944,6 +2447,10 @@ open_tiff_ep(
 		}
 		if (ctx->first_frame_only)
 			break;
+		if (g_cancellable_set_error_if_cancelled(ctx->cancellable, error)) {
+			g_clear_pointer(&result, fiv_io_image_unref);
+			return NULL;
+		}
 
 		// TODO(p): Try to adjust tiffer so that this isn't necessary.
 		struct tiffer_entry dummy = {};
@@ -1953,70 +2460,322 @@ open_tiff_ep(
 	return result;
 }
 
-// --- Optional dependencies ---------------------------------------------------
+// --- Embedded previews -------------------------------------------------------
+// Raw files on remote mounts are slow to load whole, yet their embedded JPEG
+// previews are usually referenced from the first few hundred kilobytes,
+// so it suffices to read these and the previews themselves.
 
-#ifdef HAVE_LIBRAW  // ---------------------------------------------------------
+// How much of the beginning of the file to parse.
+#define PREVIEW_PREFIX (256 << 10)
 
-static FivIoImage *
-load_libraw(libraw_data_t *iprc, GError **error)
+// The largest embedded JPEG that is worth fetching.
+#define PREVIEW_LIMIT (16 << 20)
+
+typedef struct {
+	goffset offset;                     ///< Absolute offset within the file
+	gsize length;                       ///< Length of the JPEG data stream
+} PreviewRange;
+
+static void
+preview_add(GArray *ranges, goffset base, int64_t offset, int64_t length)
 {
-	int err = 0;
-	if ((err = libraw_unpack(iprc))) {
-		set_error(error, libraw_strerror(err));
-		return NULL;
+	if (offset > 0 && length > 0 && length <= PREVIEW_LIMIT)
+		g_array_append_val(ranges,
+			((PreviewRange) {.offset = base + offset, .length = length}));
+}
+
+static void
+preview_collect_ifd(
+	GArray *ranges, const struct tiffer *T, goffset base, int depth)
+{
+	// Much like tiff_ep_find_jpeg_evaluate(), except that Exif thumbnails,
+	// and Canon's JPEG strips within IFD0 are of interest, too.
+	int64_t compression = 0, type = 0, pointer = 0, length = 0;
+	(void) tiffer_find_integer(T, TIFF_NewSubfileType, &type);
+	if (tiffer_find_integer(T, TIFF_JPEGInterchangeFormat, &pointer) &&
+		tiffer_find_integer(T, TIFF_JPEGInterchangeFormatLength, &length))
+		preview_add(ranges, base, pointer, length);
+	else if (tiffer_find_integer(T, TIFF_Compression, &compression) &&
+		(compression == TIFF_Compression_JPEG ||
+		 (compression == TIFF_Compression_JPEGDatastream && type == 1)) &&
+		tiffer_find_integer(T, TIFF_StripOffsets, &pointer) &&
+		tiffer_find_integer(T, TIFF_StripByteCounts, &length))
+		preview_add(ranges, base, pointer, length);
+
+	struct tiffer_entry subifds = tiff_ep_subifds_init(T);
+	struct tiffer subT = {};
+	while (depth < 4 && tiff_ep_subifds_next(T, &subifds, &subT))
+		preview_collect_ifd(ranges, &subT, base, depth + 1);
+}
+
+static void
+preview_collect_tiff(GArray *ranges,
+	const uint8_t *tiff, size_t len, goffset base, int64_t *orientation)
+{
+	struct tiffer T = {};
+	if (!tiffer_init(&T, tiff, len))
+		return;
+
+	// Limit the chain, it might as well be cyclic.
+	for (int i = 0; i < 16 && tiffer_next_ifd(&T); i++) {
+		if (!i)
+			(void) tiffer_find_integer(&T, TIFF_Orientation, orientation);
+		preview_collect_ifd(ranges, &T, base, 0);
+
+		struct tiffer_entry dummy = {};
+		while (tiffer_next_entry(&T, &dummy))
+			;
 	}
+}
 
-#if 0
-	// TODO(p): I'm not sure when this is necessary or useful yet.
-	if ((err = libraw_adjust_sizes_info_only(iprc))) {
-		set_error(error, libraw_strerror(err));
-		return NULL;
+static void
+preview_collect_mpf(
+	GArray *ranges, const uint8_t *mpf, size_t len, goffset base)
+{
+	struct tiffer T = {};
+	struct tiffer_entry entry = {};
+	if (!tiffer_init(&T, mpf, len) || !tiffer_next_ifd(&T) ||
+		!tiffer_find(&T, MPF_MPEntry, &entry) ||
+		entry.type != TIFFER_UNDEFINED || entry.remaining_count % 16)
+		return;
+
+	// Unlike parse_mpf_mpentry(), this is mostly after large thumbnails.
+	for (uint32_t i = 0; i < entry.remaining_count / 16; i++) {
+		const uint8_t *p = entry.p + i * 16;
+		uint32_t attrs = T.un->u32(p);
+		if (((attrs >> 24) & 0x7) == 0)
+			preview_add(ranges, base, T.un->u32(p + 8), T.un->u32(p + 4));
 	}
-#endif
+}
 
-	// TODO(p): Documentation says I should look at the code and do it myself.
-	if ((err = libraw_dcraw_process(iprc))) {
-		set_error(error, libraw_strerror(err));
-		return NULL;
+static void
+preview_collect_jpeg(
+	GArray *ranges, const uint8_t *jpeg, size_t len, int64_t *orientation)
+{
+	const uint8_t *p = jpeg + 2, *end = jpeg + len;
+	while (end - p >= 4 && p[0] == 0xFF) {
+		// Stop at the start of scan, or at the end of the image.
+		if (p[1] == 0xDA || p[1] == 0xD9)
+			break;
+
+		size_t segment_len = p[2] << 8 | p[3];
+		if (segment_len < 2 || (size_t) (end - p - 2) < segment_len)
+			break;
+
+		const uint8_t *payload = p + 4;
+		size_t payload_len = segment_len - 2;
+		if (p[1] == 0xE1 && payload_len >= 6 &&
+			!memcmp(payload, "Exif\0\0", 6))
+			preview_collect_tiff(ranges, payload + 6, payload_len - 6,
+				payload + 6 - jpeg, orientation);
+		if (p[1] == 0xE2 && payload_len >= 4 && !memcmp(payload, "MPF\0", 4))
+			preview_collect_mpf(ranges, payload + 4, payload_len - 4,
+				payload + 4 - jpeg);
+		p += 2 + segment_len;
 	}
+}
 
-	// FIXME: This is shittily written to iterate over the range of
-	// idata.colors, and will be naturally slow.
-	libraw_processed_image_t *image = libraw_dcraw_make_mem_image(iprc, &err);
-	if (!image) {
-		set_error(error, libraw_strerror(err));
+static int
+preview_compare(const void *a, const void *b)
+{
+	const PreviewRange *ra = a, *rb = b;
+	return (ra->length > rb->length) - (ra->length < rb->length);
+}
+
+static GBytes *
+preview_read(GInputStream *stream, goffset offset, gsize len, bool exact,
+	GCancellable *cancellable, GError **error)
+{
+	if (!g_seekable_seek(
+			G_SEEKABLE(stream), offset, G_SEEK_SET, cancellable, error))
 		return NULL;
-	}
 
-	// This should have been transformed, and kept, respectively.
-	if (image->colors != 3 || image->bits != 8) {
-		set_error(error, "unexpected number of colours, or bit depth");
-		libraw_dcraw_clear_mem(image);
+	guint8 *buffer = g_malloc(len);
+	gsize n = 0;
+	if (!g_input_stream_read_all(
+			stream, buffer, len, &n, cancellable, error)) {
+		g_free(buffer);
 		return NULL;
 	}
-
-	FivIoImage *I =
-		fiv_io_image_new(CAIRO_FORMAT_RGB24, image->width, image->height);
-	if (!I) {
-		set_error(error, "image allocation failure");
-		libraw_dcraw_clear_mem(image);
+	if (exact && n != len) {
+		g_free(buffer);
+		set_error(error, "unexpected end of file");
 		return NULL;
 	}
+	return g_bytes_new_take(g_realloc(buffer, n), n);
+}
 
-	uint32_t *pixels = (uint32_t *) I->data;
-	unsigned char *p = image->data;
-	for (ushort y = 0; y < image->height; y++) {
-		for (ushort x = 0; x < image->width; x++) {
-			*pixels++ = 0xff000000 | (uint32_t) p[0] << 16 |
-				(uint32_t) p[1] << 8 | (uint32_t) p[2];
-			p += 3;
+static FivIoImage *
+preview_decode(GInputStream *stream, GBytes *prefix,
+	const PreviewRange *range, const FivIoOpenContext *ctx, GError **error)
+{
+	GBytes *jpeg = NULL;
+	if ((gsize) range->offset + range->length <= g_bytes_get_size(prefix))
+		jpeg = g_bytes_new_from_bytes(prefix, range->offset, range->length);
+	else if (!(jpeg = preview_read(stream, range->offset, range->length,
+			true, ctx->cancellable, error)))
+		return NULL;
+
+	gsize len = 0;
+	const char *data = g_bytes_get_data(jpeg, &len);
+	FivIoImage *image = NULL;
+	if (len < 2 || memcmp(data, "\xff\xd8", 2))
+		set_error(error, "not a JPEG preview");
+	else
+		image = fiv_io_open_from_data(data, len, ctx, error);
+	g_bytes_unref(jpeg);
+	return image;
+}
+
+FivIoImage *
+fiv_io_open_preview(const FivIoOpenContext *ctx, int min_size, GError **error)
+{
+	GFile *file = g_file_new_for_uri(ctx->uri);
+	GFileInputStream *stream = g_file_read(file, ctx->cancellable, error);
+	g_object_unref(file);
+	if (!stream)
+		return NULL;
+	if (!g_seekable_can_seek(G_SEEKABLE(stream))) {
+		set_error(error, "the file is not seekable");
+		g_object_unref(stream);
+		return NULL;
+	}
+
+	GBytes *prefix = preview_read(G_INPUT_STREAM(stream),
+		0, PREVIEW_PREFIX, false, ctx->cancellable, error);
+	if (!prefix) {
+		g_object_unref(stream);
+		return NULL;
+	}
+
+	gsize len = 0;
+	const uint8_t *p = g_bytes_get_data(prefix, &len);
+	GArray *ranges = g_array_new(FALSE, FALSE, sizeof(PreviewRange));
+	int64_t orientation = 0;
+	if (len >= 2 && p[0] == 0xFF && p[1] == 0xD8)
+		preview_collect_jpeg(ranges, p, len, &orientation);
+	else
+		preview_collect_tiff(ranges, p, len, 0, &orientation);
+
+	// Go from the smallest, and stop once one is large enough.
+	g_array_sort(ranges, preview_compare);
+
+	FivIoImage *result = NULL;
+	for (guint i = 0; i < ranges->len; i++) {
+		if (g_cancellable_is_cancelled(ctx->cancellable))
+			break;
+
+		GError *e = NULL;
+		FivIoImage *image = preview_decode(G_INPUT_STREAM(stream), prefix,
+			&g_array_index(ranges, PreviewRange, i), ctx, &e);
+		if (!image) {
+			g_debug("%s: %s", ctx->uri, e->message);
+			g_error_free(e);
+			continue;
+		}
+		if (result && (int64_t) result->width * result->height >
+				(int64_t) image->width * image->height) {
+			fiv_io_image_unref(image);
+			continue;
+		}
+
+		g_clear_pointer(&result, fiv_io_image_unref);
+		result = image;
+		if (MAX(image->width, image->height) >= (unsigned) min_size)
+			break;
+	}
+
+	g_array_free(ranges, TRUE);
+	g_bytes_unref(prefix);
+	g_object_unref(stream);
+	if (g_cancellable_set_error_if_cancelled(ctx->cancellable, error)) {
+		g_clear_pointer(&result, fiv_io_image_unref);
+		return NULL;
+	}
+	if (!result) {
+		set_error(error, "no embedded preview found");
+		return NULL;
+	}
+
+	// Previews rarely carry their own Exif.
+	if (result->orientation == FivIoOrientationUnknown &&
+		orientation >= 1 && orientation <= 8)
+		result->orientation = orientation;
+	return result;
+}
+
+// --- Optional dependencies ---------------------------------------------------
+
+#ifdef HAVE_LIBRAW  // ---------------------------------------------------------
+
+static FivIoImage *
+load_libraw(libraw_data_t *iprc, GError **error)
+{
+	int err = 0;
+	if ((err = libraw_unpack(iprc))) {
+		set_error(error, libraw_strerror(err));
+		return NULL;
+	}
+
+#if 0
+	// TODO(p): I'm not sure when this is necessary or useful yet.
+	if ((err = libraw_adjust_sizes_info_only(iprc))) {
+		set_error(error, libraw_strerror(err));
+		return NULL;
+	}
+#endif
+
+	// TODO(p): Documentation says I should look at the code and do it myself.
+	if ((err = libraw_dcraw_process(iprc))) {
+		set_error(error, libraw_strerror(err));
+		return NULL;
+	}
+
+	int width = 0, height = 0, colors = 0, bps = 0;
+	libraw_get_mem_image_format(iprc, &width, &height, &colors, &bps);
+
+	// This should have been transformed, and kept, respectively.
+	if (colors != 3 || bps != 8) {
+		set_error(error, "unexpected number of colours, or bit depth");
+		return NULL;
+	}
+
+	FivIoImage *I = fiv_io_image_new(CAIRO_FORMAT_RGB24, width, height);
+	if (!I) {
+		set_error(error, "image allocation failure");
+		return NULL;
+	}
+
+	// LibRaw can only produce packed RGB, so have it write rows
+	// into our buffer, and widen them in place, from their ends.
+	if ((err = libraw_copy_mem_image(iprc, I->data, I->stride, false))) {
+		set_error(error, libraw_strerror(err));
+		fiv_io_image_unref(I);
+		return NULL;
+	}
+	for (int y = 0; y < height; y++) {
+		uint8_t *row = I->data + (size_t) y * I->stride;
+		uint32_t *pixels = (uint32_t *) row;
+		for (int x = width; x-- > 0; ) {
+			const uint8_t *p = row + x * 3;
+			pixels[x] = 0xff000000 | (uint32_t) p[0] << 16 |
+				(uint32_t) p[1] << 8 | (uint32_t) p[2];
 		}
 	}
 
-	libraw_dcraw_clear_mem(image);
+	I->preview = iprc->params.half_size;
 	return I;
 }
 
+static int
+load_libraw_progress(void *user_data, G_GNUC_UNUSED enum LibRaw_progress stage,
+	G_GNUC_UNUSED int iteration, G_GNUC_UNUSED int expected)
+{
+	// Non-zero return values make LibRaw abort processing.
+	const FivIoOpenContext *ctx = user_data;
+	return g_cancellable_is_cancelled(ctx->cancellable);
+}
+
 static FivIoImage *
 open_libraw(
 	const char *data, gsize len, const FivIoOpenContext *ctx, GError **error)
@@ -2034,6 +2793,10 @@ open_libraw(
 	iprc->params.output_color = 1;  // sRGB, TODO(p): Is this used?
 	iprc->params.output_bps = 8;    // This should be the default value.
 
+	// Demosaicing at full resolution takes long, so only do it on request.
+	iprc->params.half_size = !ctx->enhance;
+	libraw_set_progress_handler(iprc, load_libraw_progress, (void *) ctx);
+
 	int err = 0;
 	FivIoImage *result = NULL, *result_tail = NULL;
 	if ((err = libraw_open_buffer(iprc, (const void *) data, len))) {
@@ -2045,6 +2808,11 @@ open_libraw(
 		goto out;
 
 	for (unsigned i = 1; i < iprc->idata.raw_count; i++) {
+		if (g_cancellable_set_error_if_cancelled(ctx->cancellable, error)) {
+			g_clear_pointer(&result, fiv_io_image_unref);
+			goto out;
+		}
+
 		iprc->rawparams.shot_select = i;
 
 		// This library is terrible, we need to start again.
@@ -2070,6 +2838,7 @@ out:
 typedef struct {
 	FivIoRenderClosure parent;
 	resvg_render_tree *tree;            ///< Loaded resvg tree
+	GMutex lock;                        ///< Serializes access to the tree
 	double width;                       ///< Normal width
 	double height;                      ///< Normal height
 } FivIoRenderClosureResvg;
@@ -2079,38 +2848,53 @@ load_resvg_destroy(FivIoRenderClosure *closure)
 {
 	FivIoRenderClosureResvg *self = (void *) closure;
 	resvg_tree_destroy(self->tree);
+	g_mutex_clear(&self->lock);
 	g_free(self);
 }
 
 static FivIoImage *
 load_resvg_render_internal(FivIoRenderClosureResvg *self, double scale,
-	FivIoCmm *cmm, FivIoProfile *target, GError **error)
+	const cairo_rectangle_int_t *region, FivIoCmm *cmm, FivIoProfile *target,
+	GError **error)
 {
 	double w = ceil(self->width * scale), h = ceil(self->height * scale);
+	if (region) {
+		w = region->width;
+		h = region->height;
+	}
 	if (w > SHRT_MAX || h > SHRT_MAX) {
 		set_error(error, "image dimensions overflow");
 		return NULL;
 	}
 
-	FivIoImage *image = fiv_io_image_new(CAIRO_FORMAT_ARGB32, w, h);
+	cairo_rectangle_int_t full = {.width = w, .height = h};
+	if (!region)
+		region = &full;
+
+	FivIoImage *image =
+		fiv_io_image_new(CAIRO_FORMAT_ARGB32, region->width, region->height);
 	if (!image) {
 		set_error(error, "image allocation failure");
 		return NULL;
 	}
 
 	uint32_t *pixels = (uint32_t *) image->data;
+	g_mutex_lock(&self->lock);
 #if RESVG_MAJOR_VERSION == 0 && RESVG_MINOR_VERSION < 33
+	// Regions are only requested from versions that support transforms.
 	resvg_fit_to fit_to = {
 		scale == 1 ? RESVG_FIT_TO_TYPE_ORIGINAL : RESVG_FIT_TO_TYPE_ZOOM,
 		scale};
 	resvg_render(self->tree, fit_to, resvg_transform_identity(),
 		image->width, image->height, (char *) pixels);
 #else
-	resvg_render(self->tree, (resvg_transform) {.a = scale, .d = scale},
+	resvg_render(self->tree, (resvg_transform) {.a = scale, .d = scale,
+		.e = -region->x, .f = -region->y},
 		image->width, image->height, (char *) pixels);
 #endif
+	g_mutex_unlock(&self->lock);
 
-	for (int i = 0; i < w * h; i++) {
+	for (size_t i = 0; i < (size_t) image->width * image->height; i++) {
 		uint32_t rgba = g_ntohl(pixels[i]);
 		pixels[i] = rgba << 24 | rgba >> 8;
 	}
@@ -2122,9 +2906,21 @@ load_resvg_render(FivIoRenderClosure *closure,
 	FivIoCmm *cmm, FivIoProfile *target, double scale)
 {
 	FivIoRenderClosureResvg *self = (FivIoRenderClosureResvg *) closure;
-	return load_resvg_render_internal(self, scale, cmm, target, NULL);
+	return load_resvg_render_internal(self, scale, NULL, cmm, target, NULL);
+}
+
+#if RESVG_MAJOR_VERSION > 0 || RESVG_MINOR_VERSION >= 33
+
+static FivIoImage *
+load_resvg_render_region(FivIoRenderClosure *closure, FivIoCmm *cmm,
+	FivIoProfile *target, double scale, const cairo_rectangle_int_t *region)
+{
+	FivIoRenderClosureResvg *self = (FivIoRenderClosureResvg *) closure;
+	return load_resvg_render_internal(self, scale, region, cmm, target, NULL);
 }
 
+#endif
+
 static const char *
 load_resvg_error(int err)
 {
@@ -2175,13 +2971,17 @@ open_resvg(
 
 	FivIoRenderClosureResvg *closure = g_malloc0(sizeof *closure);
 	closure->parent.render = load_resvg_render;
+#if RESVG_MAJOR_VERSION > 0 || RESVG_MINOR_VERSION >= 33
+	closure->parent.render_region = load_resvg_render_region;
+#endif
 	closure->parent.destroy = load_resvg_destroy;
 	closure->tree = tree;
+	g_mutex_init(&closure->lock);
 	closure->width = size.width;
 	closure->height = size.height;
 
 	FivIoImage *image = load_resvg_render_internal(
-		closure, 1., ctx->cmm, ctx->screen_profile, error);
+		closure, 1., NULL, ctx->cmm, ctx->screen_profile, error);
 	if (!image) {
 		load_resvg_destroy(&closure->parent);
 		return NULL;
@@ -2197,6 +2997,7 @@ open_resvg(
 typedef struct {
 	FivIoRenderClosure parent;
 	RsvgHandle *handle;                 ///< Loaded rsvg handle
+	GMutex lock;                        ///< Serializes access to the handle
 	double width;                       ///< Normal width
 	double height;                      ///< Normal height
 } FivIoRenderClosureLibrsvg;
@@ -2206,27 +3007,40 @@ load_librsvg_destroy(FivIoRenderClosure *closure)
 {
 	FivIoRenderClosureLibrsvg *self = (void *) closure;
 	g_object_unref(self->handle);
+	g_mutex_clear(&self->lock);
 	g_free(self);
 }
 
 static FivIoImage *
 load_librsvg_render_internal(FivIoRenderClosureLibrsvg *self, double scale,
-	FivIoCmm *cmm, FivIoProfile *target, GError **error)
+	const cairo_rectangle_int_t *region, FivIoCmm *cmm, FivIoProfile *target,
+	GError **error)
 {
 	RsvgRectangle viewport = {.x = 0, .y = 0,
 		.width = self->width * scale, .height = self->height * scale};
-	FivIoImage *image = fiv_io_image_new(
-		CAIRO_FORMAT_ARGB32, ceil(viewport.width), ceil(viewport.height));
+	cairo_rectangle_int_t full = {.x = 0, .y = 0,
+		.width = ceil(viewport.width), .height = ceil(viewport.height)};
+	if (!region)
+		region = &full;
+
+	FivIoImage *image =
+		fiv_io_image_new(CAIRO_FORMAT_ARGB32, region->width, region->height);
 	if (!image) {
 		set_error(error, "image allocation failure");
 		return NULL;
 	}
 
+	// Cairo clips the document to the surface.
+	viewport.x = -region->x;
+	viewport.y = -region->y;
+
 	cairo_surface_t *surface = fiv_io_image_to_surface_noref(image);
 	cairo_t *cr = cairo_create(surface);
 	cairo_surface_destroy(surface);
+	g_mutex_lock(&self->lock);
 	gboolean success =
 		rsvg_handle_render_document(self->handle, cr, &viewport, error);
+	g_mutex_unlock(&self->lock);
 	cairo_status_t status = cairo_status(cr);
 	cairo_destroy(cr);
 	if (!success) {
@@ -2246,7 +3060,16 @@ load_librsvg_render(FivIoRenderClosure *closure,
 	FivIoCmm *cmm, FivIoProfile *target, double scale)
 {
 	FivIoRenderClosureLibrsvg *self = (FivIoRenderClosureLibrsvg *) closure;
-	return load_librsvg_render_internal(self, scale, cmm, target, NULL);
+	return load_librsvg_render_internal(self, scale, NULL, cmm, target, NULL);
+}
+
+static FivIoImage *
+load_librsvg_render_region(FivIoRenderClosure *closure, FivIoCmm *cmm,
+	FivIoProfile *target, double scale, const cairo_rectangle_int_t *region)
+{
+	FivIoRenderClosureLibrsvg *self = (FivIoRenderClosureLibrsvg *) closure;
+	return load_librsvg_render_internal(
+		self, scale, region, cmm, target, NULL);
 }
 
 static FivIoImage *
@@ -2288,15 +3111,17 @@ open_librsvg(
 
 	FivIoRenderClosureLibrsvg *closure = g_malloc0(sizeof *closure);
 	closure->parent.render = load_librsvg_render;
+	closure->parent.render_region = load_librsvg_render_region;
 	closure->parent.destroy = load_librsvg_destroy;
 	closure->handle = handle;
+	g_mutex_init(&closure->lock);
 	closure->width = w;
 	closure->height = h;
 
 	// librsvg rasterizes filters, so rendering to a recording Cairo surface
 	// has been abandoned.
 	FivIoImage *image = load_librsvg_render_internal(
-		closure, 1., ctx->cmm, ctx->screen_profile, error);
+		closure, 1., NULL, ctx->cmm, ctx->screen_profile, error);
 	if (!image) {
 		load_librsvg_destroy(&closure->parent);
 		return NULL;
@@ -2447,38 +3272,65 @@ open_xcursor(
 #endif  // HAVE_XCURSOR --------------------------------------------------------
 #ifdef HAVE_LIBHEIF  //---------------------------------------------------------
 
-static FivIoImage *
-load_libheif_image(struct heif_image_handle *handle, GError **error)
+static struct heif_context *
+load_libheif_context(const void *data, size_t len, GError **error)
+{
+	// libheif will throw C++ exceptions on allocation failures.
+	// The library is generally awful through and through.
+	struct heif_context *ctx = heif_context_alloc();
+#if LIBHEIF_HAVE_VERSION(1, 13, 0)
+	// This is what parallelizes decoding of grid images, as from iPhones.
+	heif_context_set_max_decoding_threads(ctx, fiv_io_work_threads());
+#endif
+
+	struct heif_error err =
+		heif_context_read_from_memory_without_copy(ctx, data, len, NULL);
+	if (err.code != heif_error_Ok) {
+		set_error(error, err.message);
+		heif_context_free(ctx);
+		return NULL;
+	}
+	return ctx;
+}
+
+static struct heif_image *
+load_libheif_decode(struct heif_image_handle *handle, GError **error)
 {
-	FivIoImage *I = NULL;
-	int has_alpha = heif_image_handle_has_alpha_channel(handle);
 	int bit_depth = heif_image_handle_get_luma_bits_per_pixel(handle);
 	if (bit_depth < 0) {
 		set_error(error, "undefined bit depth");
-		goto fail;
+		return NULL;
 	}
 
 	// Setting `convert_hdr_to_8bit` seems to be a no-op for RGBA32/64.
 	struct heif_decoding_options *opts = heif_decoding_options_alloc();
 
+	// There is no chroma matching Cairo's byte order,
+	// so at least avoid producing alpha when there is none.
 	// TODO(p): We can get 16-bit depth, in reality most likely 10-bit.
 	struct heif_image *image = NULL;
 	struct heif_error err = heif_decode_image(handle, &image,
-		heif_colorspace_RGB, heif_chroma_interleaved_RGBA, opts);
+		heif_colorspace_RGB, heif_image_handle_has_alpha_channel(handle)
+			? heif_chroma_interleaved_RGBA
+			: heif_chroma_interleaved_RGB,
+		opts);
+	heif_decoding_options_free(opts);
 	if (err.code != heif_error_Ok) {
 		set_error(error, err.message);
-		goto fail_decode;
+		return NULL;
 	}
+	return image;
+}
 
-	int w = heif_image_get_width(image, heif_channel_interleaved);
-	int h = heif_image_get_height(image, heif_channel_interleaved);
-
-	I = fiv_io_image_new(
-		has_alpha ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24, w, h);
-	if (!I) {
-		set_error(error, "image allocation failure");
-		goto fail_process;
-	}
+static void
+load_libheif_convert(
+	struct heif_image *image, struct heif_image_handle *handle, FivIoImage *I)
+{
+	bool has_alpha = heif_image_handle_has_alpha_channel(handle);
+	int w = MIN((int) I->width,
+		heif_image_get_width(image, heif_channel_interleaved));
+	int h = MIN((int) I->height,
+		heif_image_get_height(image, heif_channel_interleaved));
 
 	// As of writing, the library is using 16-byte alignment, unlike Cairo.
 	int src_stride = 0;
@@ -2486,17 +3338,26 @@ load_libheif_image(struct heif_image_handle *handle, GError **error)
 		image, heif_channel_interleaved, &src_stride);
 	for (int y = 0; y < h; y++) {
 		uint32_t *dstp = (uint32_t *) (I->data + I->stride * y);
-		const uint32_t *srcp = (const uint32_t *) (src + src_stride * y);
-		for (int x = 0; x < w; x++) {
-			uint32_t rgba = g_ntohl(srcp[x]);
-			*dstp++ = rgba << 24 | rgba >> 8;
+		const uint8_t *srcp = src + src_stride * y;
+		if (has_alpha) {
+			for (int x = 0; x < w; x++, srcp += 4)
+				*dstp++ = (uint32_t) srcp[3] << 24 |
+					srcp[0] << 16 | srcp[1] << 8 | srcp[2];
+		} else {
+			for (int x = 0; x < w; x++, srcp += 3)
+				*dstp++ = 0xffu << 24 | srcp[0] << 16 | srcp[1] << 8 | srcp[2];
 		}
 	}
 
 	// TODO(p): Test real behaviour on real transparent images.
 	if (has_alpha && !heif_image_handle_is_premultiplied_alpha(handle))
 		fiv_io_premultiply_argb32(I);
+}
 
+static void
+load_libheif_metadata(struct heif_image_handle *handle, FivIoImage *I)
+{
+	struct heif_error err = {};
 	heif_item_id exif_id = 0;
 	if (heif_image_handle_get_list_of_metadata_block_IDs(
 			handle, "Exif", &exif_id, 1)) {
@@ -2524,18 +3385,127 @@ load_libheif_image(struct heif_image_handle *handle, GError **error)
 			I->icc = g_bytes_new_take(icc, icc_len);
 		}
 	}
+}
+
+FivIoImage *
+fiv_io_open_libheif_handle(struct heif_image_handle *handle, GError **error)
+{
+	struct heif_image *image = load_libheif_decode(handle, error);
+	if (!image)
+		return NULL;
+
+	FivIoImage *I = fiv_io_image_new(
+		heif_image_handle_has_alpha_channel(handle)
+			? CAIRO_FORMAT_ARGB32
+			: CAIRO_FORMAT_RGB24,
+		heif_image_get_width(image, heif_channel_interleaved),
+		heif_image_get_height(image, heif_channel_interleaved));
+	if (!I)
+		set_error(error, "image allocation failure");
+	else
+		load_libheif_convert(image, handle, I);
 
-fail_process:
 	heif_image_release(image);
-fail_decode:
-	heif_decoding_options_free(opts);
-fail:
+	return I;
+}
+
+static FivIoImage *
+load_libheif_image(struct heif_image_handle *handle, GError **error)
+{
+	FivIoImage *I = fiv_io_open_libheif_handle(handle, error);
+	if (I)
+		load_libheif_metadata(handle, I);
+	return I;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Auxiliary images, such as depth maps, are rarely looked at,
+// so they are only decoded once the user pages to them.
+
+typedef struct {
+	FivIoDeferred parent;               ///< Parent structure
+	GBytes *data;                       ///< Copy of the whole file
+	heif_item_id top;                   ///< Top-level image ID
+	heif_item_id aux;                   ///< Auxiliary image ID
+} FivIoDeferredHeif;
+
+static void
+load_libheif_deferred_destroy(FivIoDeferred *deferred)
+{
+	FivIoDeferredHeif *self = (FivIoDeferredHeif *) deferred;
+	g_bytes_unref(self->data);
+	g_free(self);
+}
+
+static gboolean
+load_libheif_deferred_load(
+	FivIoDeferred *deferred, FivIoImage *page, GError **error)
+{
+	FivIoDeferredHeif *self = (FivIoDeferredHeif *) deferred;
+	gsize len = 0;
+	const void *data = g_bytes_get_data(self->data, &len);
+	struct heif_context *ctx = load_libheif_context(data, len, error);
+	if (!ctx)
+		return FALSE;
+
+	gboolean ok = FALSE;
+	struct heif_image_handle *top = NULL, *handle = NULL;
+	struct heif_error err = heif_context_get_image_handle(ctx, self->top, &top);
+	if (err.code != heif_error_Ok) {
+		set_error(error, err.message);
+		goto fail_top;
+	}
+	err = heif_image_handle_get_auxiliary_image_handle(top, self->aux, &handle);
+	if (err.code != heif_error_Ok) {
+		set_error(error, err.message);
+		goto fail_aux;
+	}
+
+	struct heif_image *image = load_libheif_decode(handle, error);
+	if (image) {
+		load_libheif_convert(image, handle, page);
+		load_libheif_metadata(handle, page);
+		heif_image_release(image);
+		ok = TRUE;
+	}
+
+	heif_image_handle_release(handle);
+fail_aux:
+	heif_image_handle_release(top);
+fail_top:
+	heif_context_free(ctx);
+	return ok;
+}
+
+static FivIoImage *
+load_libheif_deferred(struct heif_image_handle *handle,
+	GBytes *data, heif_item_id top, heif_item_id aux, GError **error)
+{
+	FivIoImage *I = fiv_io_image_new(
+		heif_image_handle_has_alpha_channel(handle)
+			? CAIRO_FORMAT_ARGB32
+			: CAIRO_FORMAT_RGB24,
+		heif_image_handle_get_width(handle),
+		heif_image_handle_get_height(handle));
+	if (!I) {
+		set_error(error, "image allocation failure");
+		return NULL;
+	}
+
+	FivIoDeferredHeif *deferred = g_malloc0(sizeof *deferred);
+	deferred->parent.load = load_libheif_deferred_load;
+	deferred->parent.destroy = load_libheif_deferred_destroy;
+	deferred->data = g_bytes_ref(data);
+	deferred->top = top;
+	deferred->aux = aux;
+	I->deferred = &deferred->parent;
 	return I;
 }
 
 static void
 load_libheif_aux_images(const FivIoOpenContext *ioctx,
-	struct heif_image_handle *top,
+	const char *data, gsize len, GBytes **copy,
+	struct heif_image_handle *top, heif_item_id top_id,
 	FivIoImage **result, FivIoImage **result_tail)
 {
 	// Include the depth image, we have no special processing for it now.
@@ -2553,9 +3523,14 @@ load_libheif_aux_images(const FivIoOpenContext *ioctx,
 			continue;
 		}
 
+		// The data we've been given are only borrowed.
+		if (!*copy)
+			*copy = g_bytes_new(data, len);
+
 		GError *e = NULL;
 		if (!try_append_page(
-				load_libheif_image(handle, &e), result, result_tail)) {
+				load_libheif_deferred(handle, *copy, top_id, ids[i], &e),
+				result, result_tail)) {
 			add_warning(ioctx, "%s", e->message);
 			g_error_free(e);
 		}
@@ -2570,24 +3545,22 @@ static FivIoImage *
 open_libheif(
 	const char *data, gsize len, const FivIoOpenContext *ioctx, GError **error)
 {
-	// libheif will throw C++ exceptions on allocation failures.
-	// The library is generally awful through and through.
-	struct heif_context *ctx = heif_context_alloc();
-	FivIoImage *result = NULL, *result_tail = NULL;
-
-	struct heif_error err;
-	err = heif_context_read_from_memory_without_copy(ctx, data, len, NULL);
-	if (err.code != heif_error_Ok) {
-		set_error(error, err.message);
-		goto fail_read;
-	}
+	struct heif_context *ctx = load_libheif_context(data, len, error);
+	if (!ctx)
+		return NULL;
 
+	FivIoImage *result = NULL, *result_tail = NULL;
+	GBytes *copy = NULL;
 	int n = heif_context_get_number_of_top_level_images(ctx);
 	heif_item_id *ids = g_malloc0_n(n, sizeof *ids);
 	n = heif_context_get_list_of_top_level_image_IDs(ctx, ids, n);
 	for (int i = 0; i < n; i++) {
+		if (g_cancellable_is_cancelled(ioctx->cancellable))
+			break;
+
 		struct heif_image_handle *handle = NULL;
-		err = heif_context_get_image_handle(ctx, ids[i], &handle);
+		struct heif_error err =
+			heif_context_get_image_handle(ctx, ids[i], &handle);
 		if (err.code != heif_error_Ok) {
 			add_warning(ioctx, "%s", err.message);
 			continue;
@@ -2601,16 +3574,31 @@ open_libheif(
 		}
 
 		// TODO(p): Possibly add thumbnail images as well.
-		load_libheif_aux_images(ioctx, handle, &result, &result_tail);
+		load_libheif_aux_images(ioctx, data, len, &copy,
+			handle, ids[i], &result, &result_tail);
 		heif_image_handle_release(handle);
 	}
+	if (copy)
+		g_bytes_unref(copy);
+
+	if (g_cancellable_set_error_if_cancelled(ioctx->cancellable, error)) {
+		g_clear_pointer(&result, fiv_io_image_unref);
+		goto out;
+	}
+
+	// Callers are free to only look at the first page, which can't be blank.
+	GError *e = NULL;
+	if (result && !fiv_io_image_undefer(result, NULL, NULL, &e)) {
+		add_warning(ioctx, "%s", e->message);
+		g_error_free(e);
+	}
 	if (!result) {
 		g_clear_pointer(&result, fiv_io_image_unref);
 		set_error(error, "empty or unsupported image");
 	}
 
+out:
 	g_free(ids);
-fail_read:
 	heif_context_free(ctx);
 	return fiv_io_cmm_finish(ioctx->cmm, result, ioctx->screen_profile);
 }
@@ -2693,10 +3681,36 @@ fiv_io_tiff_size(thandle_t h)
 	return ((struct fiv_io_tiff *) h)->len;
 }
 
+// libtiff's handlers are process-global, yet we decode from multiple threads,
+// and gdk-pixbuf's loader may be using libtiff at the same time.
+// Ours are therefore installed just once, and only act on our own handles.
+static struct {
+	GMutex lock;                        ///< Guards handles
+	GHashTable *handles;                ///< Open struct fiv_io_tiff pointers
+	TIFFErrorHandlerExt error;          ///< Previous error handler
+	TIFFErrorHandlerExt warning;        ///< Previous warning handler
+} fiv_io_tiff_handlers;
+
+static bool
+fiv_io_tiff_is_ours(thandle_t h)
+{
+	g_mutex_lock(&fiv_io_tiff_handlers.lock);
+	bool ours = fiv_io_tiff_handlers.handles &&
+		g_hash_table_contains(fiv_io_tiff_handlers.handles, h);
+	g_mutex_unlock(&fiv_io_tiff_handlers.lock);
+	return ours;
+}
+
 static void
 fiv_io_tiff_error(
 	thandle_t h, const char *module, const char *format, va_list ap)
 {
+	if (!fiv_io_tiff_is_ours(h)) {
+		if (fiv_io_tiff_handlers.error)
+			fiv_io_tiff_handlers.error(h, module, format, ap);
+		return;
+	}
+
 	struct fiv_io_tiff *io = h;
 	gchar *message = g_strdup_vprintf(format, ap);
 	if (io->error)
@@ -2709,18 +3723,355 @@ fiv_io_tiff_error(
 }
 
 static void
-fiv_io_tiff_warning(G_GNUC_UNUSED thandle_t h,
-	const char *module, const char *format, va_list ap)
+fiv_io_tiff_warning(
+	thandle_t h, const char *module, const char *format, va_list ap)
 {
+	if (!fiv_io_tiff_is_ours(h)) {
+		if (fiv_io_tiff_handlers.warning)
+			fiv_io_tiff_handlers.warning(h, module, format, ap);
+		return;
+	}
+
 	gchar *message = g_strdup_vprintf(format, ap);
 	g_debug("tiff: %s: %s", module, message);
 	g_free(message);
 }
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static gpointer
+fiv_io_tiff_install_handlers(G_GNUC_UNUSED gpointer data)
+{
+	fiv_io_tiff_handlers.handles = g_hash_table_new(g_direct_hash, NULL);
 
-static FivIoImage *
-load_libtiff_directory(TIFF *tiff, GError **error)
+	// Both kinds of handlers are called, redirect everything.
+	TIFFSetErrorHandler(NULL);
+	TIFFSetWarningHandler(NULL);
+	fiv_io_tiff_handlers.error = TIFFSetErrorHandlerExt(fiv_io_tiff_error);
+	fiv_io_tiff_handlers.warning =
+		TIFFSetWarningHandlerExt(fiv_io_tiff_warning);
+	return NULL;
+}
+
+static TIFF *
+fiv_io_tiff_open(const char *name, struct fiv_io_tiff *io)
+{
+	static GOnce once = G_ONCE_INIT;
+	g_once(&once, fiv_io_tiff_install_handlers, NULL);
+
+	g_mutex_lock(&fiv_io_tiff_handlers.lock);
+	g_hash_table_add(fiv_io_tiff_handlers.handles, io);
+	g_mutex_unlock(&fiv_io_tiff_handlers.lock);
+
+	TIFF *tiff = TIFFClientOpen(name, "rm" /* Avoid mmap. */, io,
+		fiv_io_tiff_read, fiv_io_tiff_write, fiv_io_tiff_seek,
+		fiv_io_tiff_close, fiv_io_tiff_size, NULL, NULL);
+	if (!tiff) {
+		g_mutex_lock(&fiv_io_tiff_handlers.lock);
+		g_hash_table_remove(fiv_io_tiff_handlers.handles, io);
+		g_mutex_unlock(&fiv_io_tiff_handlers.lock);
+	}
+	return tiff;
+}
+
+static void
+fiv_io_tiff_release(TIFF *tiff)
+{
+	thandle_t h = TIFFClientdata(tiff);
+	TIFFClose(tiff);
+
+	g_mutex_lock(&fiv_io_tiff_handlers.lock);
+	g_hash_table_remove(fiv_io_tiff_handlers.handles, h);
+	g_mutex_unlock(&fiv_io_tiff_handlers.lock);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Common layouts are decoded directly into Cairo's format, by strips or tiles,
+// in parallel, each thread with its own handle over the same memory buffer.
+
+typedef struct {
+	const struct fiv_io_tiff *io;       ///< The original handle's data
+	FivIoOpenContext ctx;               ///< Context without warning storage
+	toff_t offset;                      ///< Directory being decoded
+	FivIoImage *image;                  ///< Target image
+	uint32_t x;                         ///< Target image's offset in the IFD
+	uint32_t y;                         ///< Target image's offset in the IFD
+
+	bool tiled;                         ///< Tiles rather than strips
+	bool separate;                      ///< Planes stored separately
+	bool jpeg_rgb;                      ///< Let libjpeg convert from YCbCr
+	uint16_t bps;                       ///< Bits per sample, 8 or 16
+	uint16_t spp;                       ///< Samples per pixel
+	uint16_t colors;                    ///< Colour samples, 1 or 3
+	bool alpha;                         ///< First extra sample is alpha
+	bool unassociated;                  ///< The alpha is not premultiplied
+
+	uint32_t unit_width;                ///< Width of a strip or tile
+	uint32_t unit_height;               ///< Height of a strip or tile
+	uint32_t across;                    ///< Units across an image plane
+	uint32_t per_plane;                 ///< Units within an image plane
+	uint32_t units;                     ///< Units in total
+
+	gint next;                          ///< Next unit to decode, atomic
+	gint failed;                        ///< Decoding has failed, atomic
+} FivIoTiffDecode;
+
+// Byte offsets of A, R, G, B within a native-endian ARGB pixel.
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+static const int tiff_argb_offsets[4] = {3, 2, 1, 0};
+#else
+static const int tiff_argb_offsets[4] = {0, 1, 2, 3};
+#endif
+
+static inline uint8_t
+tiff_sample(const FivIoTiffDecode *d, const uint8_t *p, size_t i)
+{
+	return d->bps == 8 ? p[i] : ((const uint16_t *) p)[i] >> 8;
+}
+
+static void
+tiff_convert_unit(const FivIoTiffDecode *d, uint32_t unit, const uint8_t *buf)
+{
+	FivIoImage *I = d->image;
+	uint32_t plane = unit / d->per_plane, index = unit % d->per_plane;
+	uint32_t ux = index % d->across * d->unit_width;
+	uint32_t uy = index / d->across * d->unit_height;
+
+	// Only convert the part of the unit that lies within the target.
+	uint32_t x0 = MAX(ux, d->x), y0 = MAX(uy, d->y);
+	uint32_t x1 = MIN(ux + d->unit_width, d->x + I->width);
+	uint32_t y1 = MIN(uy + d->unit_height, d->y + I->height);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	size_t sample_size = d->bps / 8;
+	size_t samples = d->separate ? 1 : d->spp;
+	size_t in_stride = d->unit_width * samples * sample_size;
+	const uint8_t *in = buf + (y0 - uy) * in_stride +
+		(x0 - ux) * samples * sample_size;
+	uint8_t *out = I->data + (size_t) (y0 - d->y) * I->stride + (x0 - d->x) * 4;
+
+	if (d->separate) {
+		// Planes past the colours and alpha are of no interest.
+		int first = 0, last = 0;
+		if (plane < d->colors) {
+			first = d->colors == 1 ? 1 : 1 + plane;
+			last = d->colors == 1 ? 3 : 1 + plane;
+		} else if (plane == d->colors && d->alpha) {
+			first = last = 0;
+		} else {
+			return;
+		}
+
+		for (uint32_t y = y0; y < y1; y++, in += in_stride, out += I->stride) {
+			uint8_t *pixel = out;
+			for (uint32_t x = 0; x < x1 - x0; x++, pixel += 4) {
+				uint8_t value = tiff_sample(d, in, x);
+				for (int c = first; c <= last; c++)
+					pixel[tiff_argb_offsets[c]] = value;
+			}
+		}
+		return;
+	}
+
+	for (uint32_t y = y0; y < y1; y++, in += in_stride, out += I->stride) {
+		uint32_t *pixels = (uint32_t *) out;
+		for (uint32_t x = 0; x < x1 - x0; x++) {
+			size_t i = (size_t) x * d->spp;
+			uint32_t r = tiff_sample(d, in, i), g = r, b = r, a = 0xff;
+			if (d->colors == 3) {
+				g = tiff_sample(d, in, i + 1);
+				b = tiff_sample(d, in, i + 2);
+			}
+			if (d->alpha)
+				a = tiff_sample(d, in, i + d->colors);
+			pixels[x] = a << 24 | r << 16 | g << 8 | b;
+		}
+	}
+}
+
+// Each worker opens its own handle, and takes units until none are left.
+static void
+tiff_decode_worker(gpointer data, G_GNUC_UNUSED guint index)
+{
+	FivIoTiffDecode *d = data;
+	struct fiv_io_tiff h = {
+		.ctx = &d->ctx,
+		.data = d->io->data,
+		.position = 0,
+		.len = d->io->len,
+	};
+
+	TIFF *tiff = fiv_io_tiff_open("", &h);
+	if (!tiff || !TIFFSetSubDirectory(tiff, d->offset)) {
+		g_atomic_int_set(&d->failed, true);
+		goto out;
+	}
+	if (d->jpeg_rgb)
+		TIFFSetField(tiff, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+
+	tmsize_t size = d->tiled ? TIFFTileSize(tiff) : TIFFStripSize(tiff);
+	uint8_t *buf = size > 0 ? g_try_malloc(size) : NULL;
+	if (!buf) {
+		g_atomic_int_set(&d->failed, true);
+		goto out;
+	}
+
+	// Cancellation leaves the remaining units to no one.
+	gint unit = 0;
+	while (!g_atomic_int_get(&d->failed) &&
+		!g_cancellable_is_cancelled(d->ctx.cancellable) &&
+		(unit = g_atomic_int_add(&d->next, 1)) < (gint) d->units) {
+		tmsize_t n = d->tiled
+			? TIFFReadEncodedTile(tiff, unit, buf, size)
+			: TIFFReadEncodedStrip(tiff, unit, buf, size);
+		if (n < 0 || h.error)
+			g_atomic_int_set(&d->failed, true);
+		else
+			tiff_convert_unit(d, unit, buf);
+	}
+	g_free(buf);
+
+out:
+	if (tiff)
+		fiv_io_tiff_release(tiff);
+	g_free(h.error);
+}
+
+static bool
+tiff_native_supported(TIFF *tiff, FivIoTiffDecode *d)
+{
+	uint16_t photometric = 0, compression = 0, planar = 0, format = 0;
+	TIFFGetFieldDefaulted(tiff, TIFFTAG_PHOTOMETRIC, &photometric);
+	TIFFGetFieldDefaulted(tiff, TIFFTAG_COMPRESSION, &compression);
+	TIFFGetFieldDefaulted(tiff, TIFFTAG_PLANARCONFIG, &planar);
+	TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLEFORMAT, &format);
+	TIFFGetFieldDefaulted(tiff, TIFFTAG_BITSPERSAMPLE, &d->bps);
+	TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLESPERPIXEL, &d->spp);
+	if ((d->bps != 8 && d->bps != 16) || format != SAMPLEFORMAT_UINT)
+		return false;
+
+	switch (compression) {
+	case COMPRESSION_NONE:
+	case COMPRESSION_LZW:
+	case COMPRESSION_JPEG:
+	case COMPRESSION_ADOBE_DEFLATE:
+	case COMPRESSION_DEFLATE:
+#ifdef COMPRESSION_ZSTD
+	case COMPRESSION_ZSTD:
+#endif
+		if (!TIFFIsCODECConfigured(compression))
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	d->separate = planar == PLANARCONFIG_SEPARATE;
+	switch (photometric) {
+	case PHOTOMETRIC_MINISBLACK:
+		d->colors = 1;
+		break;
+	case PHOTOMETRIC_RGB:
+		d->colors = 3;
+		break;
+	case PHOTOMETRIC_YCBCR:
+		if (compression != COMPRESSION_JPEG || d->separate)
+			return false;
+		d->colors = 3;
+		d->jpeg_rgb = true;
+		break;
+	default:
+		return false;
+	}
+	if (d->spp < d->colors)
+		return false;
+
+	// It seems that neither GIMP nor Photoshop use unassociated alpha.
+	uint16_t extra = 0, *extra_types = NULL;
+	if (TIFFGetField(tiff, TIFFTAG_EXTRASAMPLES, &extra, &extra_types) &&
+		extra && d->spp > d->colors) {
+		d->unassociated = extra_types[0] == EXTRASAMPLE_UNASSALPHA;
+		d->alpha = d->unassociated ||
+			extra_types[0] == EXTRASAMPLE_ASSOCALPHA;
+	}
+
+	uint32_t width = 0, height = 0;
+	TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+	TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height);
+	if (!width || !height || width > G_MAXINT || height >= G_MAXINT ||
+		G_MAXUINT32 / width < height)
+		return false;
+
+	uint32_t planes = d->separate ? d->spp : 1;
+	if ((d->tiled = TIFFIsTiled(tiff))) {
+		TIFFGetField(tiff, TIFFTAG_TILEWIDTH, &d->unit_width);
+		TIFFGetField(tiff, TIFFTAG_TILELENGTH, &d->unit_height);
+		if (!d->unit_width || !d->unit_height)
+			return false;
+
+		d->across = (width + d->unit_width - 1) / d->unit_width;
+		d->per_plane =
+			d->across * ((height + d->unit_height - 1) / d->unit_height);
+		if (TIFFNumberOfTiles(tiff) != d->per_plane * planes)
+			return false;
+	} else {
+		d->unit_width = width;
+		d->unit_height = height;
+		TIFFGetFieldDefaulted(tiff, TIFFTAG_ROWSPERSTRIP, &d->unit_height);
+		d->unit_height = MIN(d->unit_height, height);
+		if (!d->unit_height)
+			return false;
+
+		d->across = 1;
+		d->per_plane = (height + d->unit_height - 1) / d->unit_height;
+		if (TIFFNumberOfStrips(tiff) != d->per_plane * planes)
+			return false;
+	}
+
+	d->units = d->per_plane * planes;
+	return d->units <= G_MAXINT;
+}
+
+// Returns NULL if the directory needs to go through TIFFRGBAImage.
+static FivIoImage *
+load_libtiff_native(TIFF *tiff)
+{
+	const struct fiv_io_tiff *io = TIFFClientdata(tiff);
+	FivIoTiffDecode d = {.io = io, .ctx = *io->ctx};
+	d.ctx.warnings = NULL;
+	if (!tiff_native_supported(tiff, &d))
+		return NULL;
+
+	uint32_t width = 0, height = 0;
+	TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+	TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height);
+	d.image = fiv_io_image_new(
+		d.alpha ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24, width, height);
+	if (!d.image)
+		return NULL;
+
+	d.offset = TIFFCurrentDirOffset(tiff);
+	fiv_io_work_parallel(
+		MIN(fiv_io_work_threads(), d.units), tiff_decode_worker, &d);
+
+	if (d.failed || g_cancellable_is_cancelled(d.ctx.cancellable)) {
+		g_clear_pointer(&d.image, fiv_io_image_unref);
+		return NULL;
+	}
+
+	if (d.unassociated)
+		fiv_io_premultiply_argb32(d.image);
+
+	// FivIoOrientation follows TIFF's numbering.
+	uint16_t orientation = 0;
+	if (TIFFGetField(tiff, TIFFTAG_ORIENTATION, &orientation) &&
+		orientation >= 1 && orientation <= 8)
+		d.image->orientation = orientation;
+	return d.image;
+}
+
+static FivIoImage *
+load_libtiff_rgba(TIFF *tiff, GError **error)
 {
 	char emsg[1024] = "";
 	if (!TIFFRGBAImageOK(tiff, emsg)) {
@@ -2768,6 +4119,31 @@ load_libtiff_directory(TIFF *tiff, GError **error)
 	if (image.alpha == EXTRASAMPLE_UNASSALPHA)
 		fiv_io_premultiply_argb32(I);
 
+	// Don't ask. The API is high, alright, I'm just not sure about the level.
+	uint16_t orientation = 0;
+	if (TIFFGetField(tiff, TIFFTAG_ORIENTATION, &orientation)) {
+		if (orientation == 5 || orientation == 7)
+			I->orientation = 5;
+		if (orientation == 6 || orientation == 8)
+			I->orientation = 7;
+	}
+
+fail:
+	TIFFRGBAImageEnd(&image);
+	return I;
+}
+
+static FivIoImage *
+load_libtiff_directory(TIFF *tiff, GError **error)
+{
+	// Do not fall back to the slow path when the load has been cancelled.
+	const struct fiv_io_tiff *io = TIFFClientdata(tiff);
+	FivIoImage *I = load_libtiff_native(tiff);
+	if (!I && g_cancellable_set_error_if_cancelled(io->ctx->cancellable, error))
+		return NULL;
+	if (!I && !(I = load_libtiff_rgba(tiff, error)))
+		return NULL;
+
 	// XXX: The whole file is essentially an Exif, any ideas?
 
 	// TODO(p): TIFF has a number of fields that an ICC profile can be
@@ -2780,30 +4156,278 @@ load_libtiff_directory(TIFF *tiff, GError **error)
 	if (TIFFGetField(tiff, TIFFTAG_XMLPACKET, &meta_len, &meta))
 		I->xmp = g_bytes_new(meta, meta_len);
 
-	// Don't ask. The API is high, alright, I'm just not sure about the level.
-	uint16_t orientation = 0;
-	if (TIFFGetField(tiff, TIFFTAG_ORIENTATION, &orientation)) {
-		if (orientation == 5 || orientation == 7)
-			I->orientation = 5;
-		if (orientation == 6 || orientation == 8)
-			I->orientation = 7;
+	// TODO(p): It's possible to implement ClipPath easily with Cairo.
+	return I;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Pages too large to be decoded whole, yet with reduced-resolution images,
+// are loaded at a reduced resolution as drafts, and rendered from the pyramid
+// by regions, decoding only the strips or tiles that intersect them.
+
+// Pages up to this size are always decoded whole.
+#define TIFF_PYRAMID_THRESHOLD (8192. * 8192.)
+// The largest level of a pyramid to decode as the page itself.
+#define TIFF_PYRAMID_BASE (4096. * 4096.)
+// The largest strip or tile to decode for a region, in bytes.
+#define TIFF_PYRAMID_UNIT (8 << 20)
+
+typedef struct {
+	toff_t offset;                      ///< IFD offset
+	uint32_t width;                     ///< Width of the level
+	uint32_t height;                    ///< Height of the level
+} FivIoTiffLevel;
+
+typedef struct {
+	FivIoRenderClosure parent;
+	GBytes *data;                       ///< The whole file
+	GArray *levels;                     ///< FivIoTiffLevel, largest first
+	GBytes *icc;                        ///< Raw ICC profile data or NULL
+	uint32_t width;                     ///< Full width of the page
+	uint32_t height;                    ///< Full height of the page
+} FivIoRenderClosureTiff;
+
+static void
+load_libtiff_pyramid_destroy(FivIoRenderClosure *closure)
+{
+	FivIoRenderClosureTiff *self = (void *) closure;
+	g_bytes_unref(self->data);
+	g_array_unref(self->levels);
+	if (self->icc)
+		g_bytes_unref(self->icc);
+	g_free(self);
+}
+
+// Decodes the given rectangle of a level, which must lie within it.
+static FivIoImage *
+load_libtiff_pyramid_rect(FivIoRenderClosureTiff *self,
+	const FivIoTiffLevel *level, const cairo_rectangle_int_t *rect)
+{
+	// Any further errors after the first one will go to the log.
+	FivIoOpenContext ctx = {};
+	gsize len = 0;
+	struct fiv_io_tiff h = {
+		.ctx = &ctx,
+		.data = (unsigned char *) g_bytes_get_data(self->data, &len),
+	};
+	h.len = len;
+
+	FivIoImage *image = NULL;
+	uint8_t *buf = NULL;
+	TIFF *tiff = fiv_io_tiff_open("", &h);
+	FivIoTiffDecode d = {.io = &h, .x = rect->x, .y = rect->y};
+	if (!tiff || !TIFFSetSubDirectory(tiff, level->offset) ||
+		!tiff_native_supported(tiff, &d))
+		goto out;
+	if (d.jpeg_rgb)
+		TIFFSetField(tiff, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+
+	tmsize_t size = d.tiled ? TIFFTileSize(tiff) : TIFFStripSize(tiff);
+	if (size <= 0 || !(buf = g_try_malloc(size)) ||
+		!(image = fiv_io_image_new(
+			d.alpha ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24,
+			rect->width, rect->height)))
+		goto out;
+
+	d.image = image;
+	uint32_t c1 = rect->x / d.unit_width;
+	uint32_t c2 = (rect->x + rect->width - 1) / d.unit_width;
+	uint32_t r1 = rect->y / d.unit_height;
+	uint32_t r2 = (rect->y + rect->height - 1) / d.unit_height;
+	for (uint32_t plane = 0; plane < d.units / d.per_plane; plane++)
+		for (uint32_t row = r1; row <= r2; row++)
+			for (uint32_t column = c1; column <= c2; column++) {
+				uint32_t unit =
+					plane * d.per_plane + row * d.across + column;
+				tmsize_t n = d.tiled
+					? TIFFReadEncodedTile(tiff, unit, buf, size)
+					: TIFFReadEncodedStrip(tiff, unit, buf, size);
+				if (n < 0 || h.error) {
+					g_clear_pointer(&image, fiv_io_image_unref);
+					goto out;
+				}
+				tiff_convert_unit(&d, unit, buf);
+			}
+
+	if (d.unassociated)
+		fiv_io_premultiply_argb32(image);
+
+out:
+	g_free(buf);
+	g_free(h.error);
+	if (tiff)
+		fiv_io_tiff_release(tiff);
+	return image;
+}
+
+static FivIoImage *
+load_libtiff_pyramid_render_region(FivIoRenderClosure *closure, FivIoCmm *cmm,
+	FivIoProfile *target, double scale, const cairo_rectangle_int_t *region)
+{
+	FivIoRenderClosureTiff *self = (FivIoRenderClosureTiff *) closure;
+	if (region->width <= 0 || region->height <= 0 ||
+		region->width > SHRT_MAX || region->height > SHRT_MAX)
+		return NULL;
+
+	// Find the smallest level that doesn't need to be magnified.
+	const FivIoTiffLevel *level =
+		&g_array_index(self->levels, FivIoTiffLevel, 0);
+	for (guint i = self->levels->len; i--; ) {
+		const FivIoTiffLevel *candidate =
+			&g_array_index(self->levels, FivIoTiffLevel, i);
+		if (candidate->width >= self->width * scale) {
+			level = candidate;
+			break;
+		}
 	}
 
-fail:
-	TIFFRGBAImageEnd(&image);
-	// TODO(p): It's possible to implement ClipPath easily with Cairo.
+	double fx = level->width / (self->width * scale);
+	double fy = level->height / (self->height * scale);
+	double x1 = MAX(0, floor(region->x * fx));
+	double y1 = MAX(0, floor(region->y * fy));
+	double x2 = MIN(level->width, ceil((region->x + region->width) * fx));
+	double y2 = MIN(level->height, ceil((region->y + region->height) * fy));
+
+	FivIoImage *part = NULL;
+	cairo_rectangle_int_t rect = {.x = x1, .y = y1,
+		.width = x2 - x1, .height = y2 - y1};
+	if (rect.width > 0 && rect.height > 0 &&
+		!(part = load_libtiff_pyramid_rect(self, level, &rect)))
+		return NULL;
+
+	FivIoImage *image = fiv_io_image_new(
+		part ? part->format : CAIRO_FORMAT_ARGB32,
+		region->width, region->height);
+	if (!image) {
+		g_clear_pointer(&part, fiv_io_image_unref);
+		return NULL;
+	}
+	if (part) {
+		cairo_surface_t *surface = fiv_io_image_to_surface_noref(image);
+		cairo_t *cr = cairo_create(surface);
+		cairo_surface_destroy(surface);
+
+		surface = fiv_io_image_to_surface_noref(part);
+		cairo_set_source_surface(cr, surface, 0, 0);
+		cairo_surface_destroy(surface);
+
+		cairo_matrix_t matrix = {};
+		cairo_matrix_init(&matrix, fx, 0, 0, fy,
+			region->x * fx - rect.x, region->y * fy - rect.y);
+		cairo_pattern_t *pattern = cairo_get_source(cr);
+		cairo_pattern_set_matrix(pattern, &matrix);
+		cairo_pattern_set_extend(pattern, CAIRO_EXTEND_PAD);
+		cairo_pattern_set_filter(pattern, CAIRO_FILTER_GOOD);
+
+		cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+		cairo_paint(cr);
+		cairo_destroy(cr);
+		fiv_io_image_unref(part);
+	}
+
+	if (self->icc)
+		image->icc = g_bytes_ref(self->icc);
+	return fiv_io_cmm_finish(cmm, image, target);
+}
+
+static FivIoImage *
+load_libtiff_pyramid_render(FivIoRenderClosure *closure,
+	FivIoCmm *cmm, FivIoProfile *target, double scale)
+{
+	FivIoRenderClosureTiff *self = (FivIoRenderClosureTiff *) closure;
+	cairo_rectangle_int_t region = {
+		.width = ceil(self->width * scale),
+		.height = ceil(self->height * scale)};
+	return load_libtiff_pyramid_render_region(
+		closure, cmm, target, scale, &region);
+}
+
+static int
+load_libtiff_level_compare(const void *a, const void *b)
+{
+	const FivIoTiffLevel *la = a, *lb = b;
+	return (la->width < lb->width) - (la->width > lb->width);
+}
+
+static GBytes *
+load_libtiff_keep_data(const char *data, gsize len, const FivIoOpenContext *ctx)
+{
+	// Local files can be mapped rather than copied.
+	gchar *path = ctx->uri ? g_filename_from_uri(ctx->uri, NULL, NULL) : NULL;
+	GMappedFile *mf = path ? g_mapped_file_new(path, FALSE, NULL) : NULL;
+	g_free(path);
+
+	GBytes *bytes = NULL;
+	if (mf && g_mapped_file_get_length(mf) == len)
+		bytes = g_mapped_file_get_bytes(mf);
+	else
+		bytes = g_bytes_new(data, len);
+	if (mf)
+		g_mapped_file_unref(mf);
+	return bytes;
+}
+
+// Loads a page, given all of its levels, and that the handle is positioned
+// at the first one, which has full resolution.
+static FivIoImage *
+load_libtiff_page(TIFF *tiff, GArray *levels, GError **error)
+{
+	toff_t offset = TIFFCurrentDirOffset(tiff);
+	g_array_sort(levels, load_libtiff_level_compare);
+	const FivIoTiffLevel *full = &g_array_index(levels, FivIoTiffLevel, 0);
+	if (levels->len < 2 ||
+		(double) full->width * full->height <= TIFF_PYRAMID_THRESHOLD)
+		return load_libtiff_directory(tiff, error);
+
+	// All levels must be decodable by reasonably small regions.
+	const FivIoTiffLevel *base = NULL;
+	for (guint i = 0; i < levels->len; i++) {
+		const FivIoTiffLevel *level =
+			&g_array_index(levels, FivIoTiffLevel, i);
+		FivIoTiffDecode d = {};
+		if (!TIFFSetSubDirectory(tiff, level->offset) ||
+			!tiff_native_supported(tiff, &d))
+			goto full;
+
+		tmsize_t unit = d.tiled ? TIFFTileSize(tiff) : TIFFStripSize(tiff);
+		if (unit <= 0 || unit > TIFF_PYRAMID_UNIT)
+			goto full;
+		if (!base ||
+			(double) base->width * base->height > TIFF_PYRAMID_BASE)
+			base = level;
+	}
+
+	FivIoImage *I = NULL;
+	if (!TIFFSetSubDirectory(tiff, base->offset) ||
+		!(I = load_libtiff_directory(tiff, error)))
+		return NULL;
+
+	const struct fiv_io_tiff *io = TIFFClientdata(tiff);
+	FivIoRenderClosureTiff *closure = g_malloc0(sizeof *closure);
+	closure->parent.render = load_libtiff_pyramid_render;
+	closure->parent.render_region = load_libtiff_pyramid_render_region;
+	closure->parent.destroy = load_libtiff_pyramid_destroy;
+	closure->data = load_libtiff_keep_data(
+		(const char *) io->data, io->len, io->ctx);
+	closure->levels = g_array_ref(levels);
+	closure->icc = I->icc ? g_bytes_ref(I->icc) : NULL;
+	closure->width = I->full_width = full->width;
+	closure->height = I->full_height = full->height;
+	I->render = &closure->parent;
 	return I;
+
+full:
+	if (!TIFFSetSubDirectory(tiff, offset)) {
+		set_error(error, "failed to reread a directory");
+		return NULL;
+	}
+	return load_libtiff_directory(tiff, error);
 }
 
 static FivIoImage *
 open_libtiff(
 	const char *data, gsize len, const FivIoOpenContext *ctx, GError **error)
 {
-	// Both kinds of handlers are called, redirect everything.
-	TIFFErrorHandler eh = TIFFSetErrorHandler(NULL);
-	TIFFErrorHandler wh = TIFFSetWarningHandler(NULL);
-	TIFFErrorHandlerExt ehe = TIFFSetErrorHandlerExt(fiv_io_tiff_error);
-	TIFFErrorHandlerExt whe = TIFFSetWarningHandlerExt(fiv_io_tiff_warning);
 	struct fiv_io_tiff h = {
 		.ctx = ctx,
 		.data = (unsigned char *) data,
@@ -2812,37 +4436,88 @@ open_libtiff(
 	};
 
 	FivIoImage *result = NULL, *result_tail = NULL;
-	TIFF *tiff = TIFFClientOpen(ctx->uri, "rm" /* Avoid mmap. */, &h,
-		fiv_io_tiff_read, fiv_io_tiff_write, fiv_io_tiff_seek,
-		fiv_io_tiff_close, fiv_io_tiff_size, NULL, NULL);
+	TIFF *tiff = fiv_io_tiff_open(ctx->uri, &h);
 	if (!tiff)
 		goto fail;
 
+	// Reduced-resolution images are not pages of their own, but levels
+	// of the preceding page, or of the page that lists them as SubIFDs.
+	GPtrArray *pages =
+		g_ptr_array_new_with_free_func((GDestroyNotify) g_array_unref);
+	GArray *subifds = g_array_new(FALSE, FALSE, sizeof(toff_t) * 2);
 	do {
+		FivIoTiffLevel level = {.offset = TIFFCurrentDirOffset(tiff)};
+		TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &level.width);
+		TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &level.height);
+
+		uint32_t subfile = 0;
+		if (TIFFGetField(tiff, TIFFTAG_SUBFILETYPE, &subfile) &&
+			(subfile & FILETYPE_REDUCEDIMAGE) && pages->len) {
+			g_array_append_val(pages->pdata[pages->len - 1], level);
+			continue;
+		}
+
+		GArray *levels = g_array_new(FALSE, FALSE, sizeof level);
+		g_array_append_val(levels, level);
+		g_ptr_array_add(pages, levels);
+
+		uint16_t count = 0;
+		toff_t *offsets = NULL;
+		if (TIFFGetField(tiff, TIFFTAG_SUBIFD, &count, &offsets))
+			for (uint16_t i = 0; i < count; i++) {
+				toff_t entry[2] = {pages->len - 1, offsets[i]};
+				g_array_append_val(subifds, entry);
+			}
+	} while (!g_cancellable_is_cancelled(ctx->cancellable) &&
+		TIFFReadDirectory(tiff));
+
+	for (guint i = 0; i < subifds->len; i++) {
+		const toff_t *entry = &g_array_index(subifds, toff_t, i * 2);
+		uint32_t subfile = 0;
+		FivIoTiffLevel level = {.offset = entry[1]};
+		if (!TIFFSetSubDirectory(tiff, level.offset) ||
+			!TIFFGetField(tiff, TIFFTAG_SUBFILETYPE, &subfile) ||
+			!(subfile & FILETYPE_REDUCEDIMAGE))
+			continue;
+
+		TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &level.width);
+		TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &level.height);
+		g_array_append_val(pages->pdata[entry[0]], level);
+	}
+	g_array_free(subifds, TRUE);
+
+	for (guint i = 0; i < pages->len; i++) {
+		if (g_cancellable_is_cancelled(ctx->cancellable))
+			break;
+
+		GArray *levels = pages->pdata[i];
+		const FivIoTiffLevel *full = &g_array_index(levels, FivIoTiffLevel, 0);
+		if (!TIFFSetSubDirectory(tiff, full->offset))
+			continue;
+
 		// We inform about unsupported directories, but do not fail on them.
 		GError *err = NULL;
 		if (!try_append_page(
-				load_libtiff_directory(tiff, &err), &result, &result_tail) &&
+				load_libtiff_page(tiff, levels, &err), &result, &result_tail) &&
 			err) {
 			add_warning(ctx, "%s", err->message);
 			g_error_free(err);
 		}
-	} while (TIFFReadDirectory(tiff));
-	TIFFClose(tiff);
+	}
+	g_ptr_array_free(pages, TRUE);
+	fiv_io_tiff_release(tiff);
 
 fail:
-	if (h.error) {
+	if (g_cancellable_set_error_if_cancelled(ctx->cancellable, error)) {
+		g_clear_pointer(&result, fiv_io_image_unref);
+		g_free(h.error);
+	} else if (h.error) {
 		g_clear_pointer(&result, fiv_io_image_unref);
 		set_error(error, h.error);
 		g_free(h.error);
 	} else if (!result) {
 		set_error(error, "empty or unsupported image");
 	}
-
-	TIFFSetErrorHandlerExt(ehe);
-	TIFFSetWarningHandlerExt(whe);
-	TIFFSetErrorHandler(eh);
-	TIFFSetWarningHandler(wh);
 	return fiv_io_cmm_finish(ctx->cmm, result, ctx->screen_profile);
 }
 
@@ -2947,12 +4622,568 @@ open_gdkpixbuf(
 
 #endif  // HAVE_GDKPIXBUF ------------------------------------------------------
 
-FivIoImage *
-fiv_io_open(const FivIoOpenContext *ctx, GError **error)
-{
-	// TODO(p): Don't always load everything into memory, test type first,
-	// so that we can reject non-pictures early.  Wuffs only needs the first
-	// 17 bytes to make a guess right now.
+// --- Decoder backends --------------------------------------------------------
+// Formats recognized by Wuffs may have several decoders to choose from,
+// the first one listed being the default. The choice can be overridden
+// through the FIV_BACKENDS environment variable, e.g., "png=gdk-pixbuf",
+// or for individual calls through FivIoOpenContext::backend.
+
+typedef struct {
+	uint32_t fourcc;                    ///< Wuffs format identification
+	const char *format;                 ///< Format name for FIV_BACKENDS
+	const char *name;                   ///< Backend name
+	FivIoImage *(*open)(const char *data, gsize len,
+		const FivIoOpenContext *ctx, GError **error);
+	/// Alternatively to open(), a generic Wuffs image decoder.
+	wuffs_base__image_decoder *(*allocate)();
+} FivIoBackend;
+
+#define WUFFS(fourcc, format, module) {WUFFS_BASE__FOURCC__ ## fourcc, \
+	(format), "wuffs", .allocate = \
+	wuffs_ ## module ## __decoder__alloc_as__wuffs_base__image_decoder}
+#define OTHER(fourcc, format, name, loader) \
+	{WUFFS_BASE__FOURCC__ ## fourcc, (format), (name), .open = (loader)}
+
+static const FivIoBackend fiv_io_backends[] = {
+	// Note that BMP can redirect into another format,
+	// which is so far unsupported here.
+	WUFFS(BMP, "bmp", bmp),
+	WUFFS(GIF, "gif", gif),
+	WUFFS(PNG, "png", png),
+	WUFFS(TGA, "tga", tga),
+	WUFFS(NIE, "nie", nie),
+	WUFFS(WBMP, "wbmp", wbmp),
+	OTHER(JPEG, "jpeg", "libjpeg-turbo", open_libjpeg_turbo),
+	OTHER(WEBP, "webp", "libwebp", open_libwebp),
+#ifdef HAVE_GDKPIXBUF
+	OTHER(BMP, "bmp", "gdk-pixbuf", open_gdkpixbuf),
+	OTHER(GIF, "gif", "gdk-pixbuf", open_gdkpixbuf),
+	OTHER(PNG, "png", "gdk-pixbuf", open_gdkpixbuf),
+	OTHER(TGA, "tga", "gdk-pixbuf", open_gdkpixbuf),
+	OTHER(WBMP, "wbmp", "gdk-pixbuf", open_gdkpixbuf),
+	OTHER(JPEG, "jpeg", "gdk-pixbuf", open_gdkpixbuf),
+#endif  // HAVE_GDKPIXBUF
+};
+
+#undef WUFFS
+#undef OTHER
+
+static FivIoImage *
+backend_open(const FivIoBackend *backend,
+	const char *data, gsize len, const FivIoOpenContext *ctx, GError **error)
+{
+	if (backend->open)
+		return backend->open(data, len, ctx, error);
+	return open_wuffs_using(backend->allocate, data, len, ctx, error);
+}
+
+static gchar *
+backend_from_environment(const char *format)
+{
+	const char *backends = g_getenv("FIV_BACKENDS");
+	if (!backends)
+		return NULL;
+
+	gchar *result = NULL;
+	gchar **pairs = g_strsplit(backends, ",", -1);
+	for (gchar **pair = pairs; *pair && !result; pair++) {
+		const char *equals = strchr(*pair, '=');
+		if (equals && equals - *pair == (ptrdiff_t) strlen(format) &&
+			!strncmp(*pair, format, equals - *pair))
+			result = g_strdup(equals + 1);
+	}
+	g_strfreev(pairs);
+	return result;
+}
+
+static const FivIoBackend *
+backend_for(uint32_t fourcc, const char *preferred)
+{
+	const FivIoBackend *chosen = NULL, *fallback = NULL;
+	gchar *configured = NULL;
+	for (size_t i = 0; i < G_N_ELEMENTS(fiv_io_backends); i++) {
+		const FivIoBackend *backend = &fiv_io_backends[i];
+		if (backend->fourcc != fourcc)
+			continue;
+		if (!fallback) {
+			fallback = backend;
+			if (!preferred)
+				preferred = configured =
+					backend_from_environment(backend->format);
+		}
+		if (preferred && !strcmp(backend->name, preferred)) {
+			chosen = backend;
+			break;
+		}
+	}
+	g_free(configured);
+	return chosen ? chosen : fallback;
+}
+
+gchar **
+fiv_io_backends_for_data(const char *data, size_t len)
+{
+	wuffs_base__slice_u8 prefix =
+		wuffs_base__make_slice_u8((uint8_t *) data, len);
+	uint32_t fourcc =
+		wuffs_base__magic_number_guess_fourcc(prefix, true /* closed */);
+
+	GPtrArray *names = g_ptr_array_new();
+	for (size_t i = 0; i < G_N_ELEMENTS(fiv_io_backends); i++)
+		if (fiv_io_backends[i].fourcc == fourcc)
+			g_ptr_array_add(names, g_strdup(fiv_io_backends[i].name));
+	g_ptr_array_add(names, NULL);
+	return (gchar **) g_ptr_array_free(names, FALSE);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Loaders in the fallback chain are rather expensive to fail in,
+// notably LibRaw and the SVG parsers, so only try plausible ones.
+
+enum {
+	SNIFF_TIFF_EP = 1 << 0,             ///< open_tiff_ep()
+	SNIFF_LIBRAW  = 1 << 1,             ///< open_libraw()
+	SNIFF_SVG     = 1 << 2,             ///< open_resvg(), open_librsvg()
+	SNIFF_XCURSOR = 1 << 3,             ///< open_xcursor()
+	SNIFF_LIBHEIF = 1 << 4,             ///< open_libheif()
+	SNIFF_LIBTIFF = 1 << 5,             ///< open_libtiff()
+	SNIFF_ALL     = ~0u,
+};
+
+static unsigned
+sniff(const char *data, size_t len)
+{
+	static const struct {
+		size_t offset;                  ///< Signature offset
+		const char *signature;          ///< Signature
+		size_t signature_len;           ///< Signature length
+		unsigned loaders;               ///< Plausible loaders
+	} table[] = {
+#define S(offset, signature, loaders) \
+	{(offset), (signature), sizeof (signature) - 1, (loaders)}
+		// TIFF also underlies most raw formats, in which case LibRaw should
+		// take precedence, and BigTIFF isn't handled by anything but libtiff.
+		S(0, "II*\0", SNIFF_TIFF_EP | SNIFF_LIBRAW | SNIFF_LIBTIFF),
+		S(0, "MM\0*", SNIFF_TIFF_EP | SNIFF_LIBRAW | SNIFF_LIBTIFF),
+		S(0, "II+\0", SNIFF_LIBTIFF),
+		S(0, "MM\0+", SNIFF_LIBTIFF),
+		// Canon CR3 is ISO BMFF, just like HEIF, distinguished by its brand.
+		S(4, "ftypcrx ", SNIFF_LIBRAW),
+		S(4, "ftyp", SNIFF_LIBHEIF),
+		// Raw formats that only resemble TIFF, or not at all.
+		S(0, "IIRO", SNIFF_LIBRAW),
+		S(0, "IIRS", SNIFF_LIBRAW),
+		S(0, "MMOR", SNIFF_LIBRAW),
+		S(0, "IIU\0", SNIFF_LIBRAW),
+		S(6, "HEAPCCDR", SNIFF_LIBRAW),
+		S(0, "FUJIFILMCCD-RAW", SNIFF_LIBRAW),
+		S(0, "\0MRM", SNIFF_LIBRAW),
+		S(0, "FOVb", SNIFF_LIBRAW),
+		S(0, "Xcur", SNIFF_XCURSOR),
+		// SVGZ, and UTF-16 XML.
+		S(0, "\x1f\x8b", SNIFF_SVG),
+		S(0, "\xff\xfe", SNIFF_SVG),
+		S(0, "\xfe\xff", SNIFF_SVG),
+#undef S
+	};
+
+	for (size_t i = 0; i < G_N_ELEMENTS(table); i++) {
+		if (len >= table[i].offset + table[i].signature_len &&
+			!memcmp(data + table[i].offset,
+				table[i].signature, table[i].signature_len))
+			return table[i].loaders;
+	}
+
+	// XML may only be preceded by a byte order mark and whitespace.
+	const char *p = data, *end = data + len;
+	if (len >= 3 && !memcmp(p, "\xef\xbb\xbf", 3))
+		p += 3;
+	while (p < end && g_ascii_isspace(*p))
+		p++;
+	if (p < end && *p == '<')
+		return SNIFF_SVG;
+
+	// LibRaw supports too many formats to list them all,
+	// though the most common ones are covered above.
+	return SNIFF_LIBRAW;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Files from slow sources can be shown while they are still being read,
+// as far as the decoder of their format is able to resume on more data.
+// These previews are neither colour managed nor complete, and the whole file
+// is decoded again once it has been read, with all the usual processing.
+
+#define PROGRESSIVE_CHUNK (64 << 10)
+#define PROGRESSIVE_INTERVAL (G_USEC_PER_SEC / 10)
+
+typedef struct {
+	const FivIoOpenContext *ctx;        ///< Receives progress
+	GInputStream *stream;               ///< Source stream
+	GByteArray *data;                   ///< Everything read so far
+	gboolean eof;                       ///< No more data is going to come
+	GError *error;                      ///< Read error, if any
+	gint64 reported;                    ///< Last progress report time
+} FivIoProgressive;
+
+/// Blocks until another chunk of data is read, and returns whether it was.
+static bool
+progressive_read(FivIoProgressive *self)
+{
+	if (self->eof)
+		return false;
+
+	guint old = self->data->len;
+	g_byte_array_set_size(self->data, old + PROGRESSIVE_CHUNK);
+	gssize n = g_input_stream_read(self->stream, self->data->data + old,
+		PROGRESSIVE_CHUNK, self->ctx->cancellable, &self->error);
+	g_byte_array_set_size(self->data, old + MAX(n, 0));
+	if (n <= 0)
+		self->eof = TRUE;
+	return n > 0;
+}
+
+static void
+progressive_report(FivIoProgressive *self, FivIoImage *partial, bool force)
+{
+	gint64 now = g_get_monotonic_time();
+	if (!partial || (!force && now - self->reported < PROGRESSIVE_INTERVAL))
+		return;
+
+	self->reported = now;
+	self->ctx->progress(partial, self->ctx->progress_data);
+}
+
+static bool
+progressive_wuffs_refill(FivIoProgressive *self, wuffs_base__io_buffer *src)
+{
+	if (src->meta.closed)
+		return false;
+
+	// The reader index stays valid, since nothing is ever compacted.
+	(void) progressive_read(self);
+	src->data = wuffs_base__make_slice_u8(self->data->data, self->data->len);
+	src->meta.wi = self->data->len;
+	src->meta.closed = self->eof;
+	return true;
+}
+
+static FivIoImage *
+progressive_wuffs(
+	FivIoProgressive *self, wuffs_base__image_decoder *(*allocate)())
+{
+	wuffs_base__image_decoder *dec = allocate();
+	if (!dec)
+		return NULL;
+
+	wuffs_base__io_buffer src = wuffs_base__make_io_buffer(
+		wuffs_base__make_slice_u8(self->data->data, self->data->len),
+		wuffs_base__make_io_buffer_meta(self->data->len, 0, 0, self->eof));
+
+	FivIoImage *image = NULL;
+	wuffs_base__slice_u8 workbuf = {};
+	wuffs_base__image_config cfg = {};
+	wuffs_base__status status = {};
+	while ((status = wuffs_base__image_decoder__decode_image_config(
+				dec, &cfg, &src)).repr == wuffs_base__suspension__short_read)
+		if (!progressive_wuffs_refill(self, &src))
+			break;
+	if (!wuffs_base__status__is_ok(&status))
+		goto out;
+
+	uint32_t width = wuffs_base__pixel_config__width(&cfg.pixcfg);
+	uint32_t height = wuffs_base__pixel_config__height(&cfg.pixcfg);
+	if (width > INT16_MAX || height > INT16_MAX)
+		goto out;
+
+	wuffs_base__pixel_config__set(&cfg.pixcfg,
+		WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL,
+		WUFFS_BASE__PIXEL_SUBSAMPLING__NONE, width, height);
+
+	uint64_t workbuf_len_max_incl =
+		wuffs_base__image_decoder__workbuf_len(dec).max_incl;
+	if (workbuf_len_max_incl) {
+		workbuf = wuffs_base__malloc_slice_u8(malloc, workbuf_len_max_incl);
+		if (!workbuf.ptr)
+			goto out;
+	}
+
+	wuffs_base__frame_config fc = {};
+	while ((status = wuffs_base__image_decoder__decode_frame_config(
+				dec, &fc, &src)).repr == wuffs_base__suspension__short_read)
+		if (!progressive_wuffs_refill(self, &src))
+			break;
+	if (!wuffs_base__status__is_ok(&status))
+		goto out;
+
+	// Blending onto transparent black is the right thing for the first frame.
+	if (!(image = fiv_io_image_new(CAIRO_FORMAT_ARGB32, width, height)))
+		goto out;
+
+	wuffs_base__pixel_buffer pb = {};
+	status = wuffs_base__pixel_buffer__set_from_slice(&pb, &cfg.pixcfg,
+		wuffs_base__make_slice_u8(image->data, image->stride * image->height));
+	if (!wuffs_base__status__is_ok(&status))
+		goto out;
+
+	while ((status = wuffs_base__image_decoder__decode_frame(dec, &pb, &src,
+				WUFFS_BASE__PIXEL_BLEND__SRC, workbuf, NULL)).repr ==
+			wuffs_base__suspension__short_read) {
+		progressive_report(self, image, false);
+		if (!progressive_wuffs_refill(self, &src))
+			break;
+	}
+	progressive_report(self, image, true);
+
+out:
+	free(workbuf.ptr);
+	free(dec);
+	return image;
+}
+
+struct progressive_jpeg_source {
+	struct jpeg_source_mgr pub;         ///< Public source manager
+	FivIoProgressive *self;             ///< Data provider
+	size_t offset;                      ///< Data passed to libjpeg so far
+};
+
+static void
+progressive_jpeg_init_source(G_GNUC_UNUSED j_decompress_ptr cinfo)
+{
+}
+
+static boolean
+progressive_jpeg_fill_input_buffer(j_decompress_ptr cinfo)
+{
+	// libjpeg only asks for more once it has used up the buffer,
+	// so the byte array may be reallocated in the meantime.
+	struct progressive_jpeg_source *src =
+		(struct progressive_jpeg_source *) cinfo->src;
+	while (src->offset >= src->self->data->len && progressive_read(src->self))
+		;
+
+	if (src->offset >= src->self->data->len) {
+		// Make the decoder finish with what it has, as jdatasrc.c does.
+		static const JOCTET eoi[] = {0xFF, JPEG_EOI};
+		src->pub.next_input_byte = eoi;
+		src->pub.bytes_in_buffer = sizeof eoi;
+		return TRUE;
+	}
+
+	src->pub.next_input_byte = src->self->data->data + src->offset;
+	src->pub.bytes_in_buffer = src->self->data->len - src->offset;
+	src->offset = src->self->data->len;
+	return TRUE;
+}
+
+static void
+progressive_jpeg_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+	struct jpeg_source_mgr *src = cinfo->src;
+	while (num_bytes > (long) src->bytes_in_buffer) {
+		num_bytes -= src->bytes_in_buffer;
+		src->bytes_in_buffer = 0;
+		(void) progressive_jpeg_fill_input_buffer(cinfo);
+	}
+	if (num_bytes > 0) {
+		src->next_input_byte += num_bytes;
+		src->bytes_in_buffer -= num_bytes;
+	}
+}
+
+static void
+progressive_jpeg_term_source(G_GNUC_UNUSED j_decompress_ptr cinfo)
+{
+}
+
+static void
+progressive_jpeg_output_message(G_GNUC_UNUSED j_common_ptr cinfo)
+{
+	// The final decode will report any warnings.
+}
+
+static FivIoImage *
+progressive_jpeg(FivIoProgressive *self)
+{
+	FivIoImage *volatile image = NULL;
+
+	struct libjpeg_error_mgr jerr = {.ctx = self->ctx};
+	struct jpeg_decompress_struct cinfo = {.err = jpeg_std_error(&jerr.pub)};
+	jerr.pub.error_exit = libjpeg_error_exit;
+	jerr.pub.output_message = progressive_jpeg_output_message;
+	if (setjmp(jerr.buf)) {
+		// Whatever has been decoded so far has already been reported.
+		jpeg_destroy_decompress(&cinfo);
+		return image;
+	}
+
+	jpeg_create_decompress(&cinfo);
+
+	struct progressive_jpeg_source src = {
+		.pub.init_source = progressive_jpeg_init_source,
+		.pub.fill_input_buffer = progressive_jpeg_fill_input_buffer,
+		.pub.skip_input_data = progressive_jpeg_skip_input_data,
+		.pub.resync_to_restart = jpeg_resync_to_restart,
+		.pub.term_source = progressive_jpeg_term_source,
+		.self = self,
+	};
+	cinfo.src = &src.pub;
+
+	(void) jpeg_read_header(&cinfo, true);
+	if (cinfo.jpeg_color_space == JCS_CMYK ||
+		cinfo.jpeg_color_space == JCS_YCCK)
+		longjmp(jerr.buf, 1);
+	if (G_BYTE_ORDER == G_BIG_ENDIAN)
+		cinfo.out_color_space = JCS_EXT_XRGB;
+	else
+		cinfo.out_color_space = JCS_EXT_BGRX;
+
+	// Progressive JPEGs are shown one scan at a time, as they come in.
+	cinfo.buffered_image = jpeg_has_multiple_scans(&cinfo);
+	(void) jpeg_start_decompress(&cinfo);
+	if (cinfo.output_width > INT16_MAX || cinfo.output_height > INT16_MAX ||
+		!(image = fiv_io_image_new(CAIRO_FORMAT_RGB24,
+			cinfo.output_width, cinfo.output_height)))
+		longjmp(jerr.buf, 1);
+
+	JSAMPARRAY lines = (*cinfo.mem->alloc_small)((j_common_ptr) &cinfo,
+		JPOOL_IMAGE, sizeof *lines * cinfo.output_height);
+	for (JDIMENSION i = 0; i < cinfo.output_height; i++)
+		lines[i] = image->data + i * image->stride;
+
+	do {
+		if (cinfo.buffered_image)
+			(void) jpeg_start_output(&cinfo, cinfo.input_scan_number);
+		while (cinfo.output_scanline < cinfo.output_height) {
+			(void) jpeg_read_scanlines(&cinfo, lines + cinfo.output_scanline,
+				cinfo.output_height - cinfo.output_scanline);
+			progressive_report(self, image, false);
+		}
+		if (cinfo.buffered_image)
+			(void) jpeg_finish_output(&cinfo);
+		progressive_report(self, image, true);
+	} while (cinfo.buffered_image && !jpeg_input_complete(&cinfo));
+
+	(void) jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	return image;
+}
+
+static FivIoImage *
+progressive_webp(FivIoProgressive *self)
+{
+	WebPDecoderConfig config = {};
+	if (!WebPInitDecoderConfig(&config))
+		return NULL;
+
+	VP8StatusCode err = VP8_STATUS_NOT_ENOUGH_DATA;
+	while ((err = WebPGetFeatures(self->data->data, self->data->len,
+				&config.input)) == VP8_STATUS_NOT_ENOUGH_DATA)
+		if (!progressive_read(self))
+			break;
+	if (err != VP8_STATUS_OK || config.input.has_animation)
+		return NULL;
+
+	FivIoImage *image = fiv_io_image_new(
+		config.input.has_alpha ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24,
+		config.input.width, config.input.height);
+	if (!image)
+		return NULL;
+
+	config.output.width = config.input.width;
+	config.output.height = config.input.height;
+	config.output.is_external_memory = true;
+	config.output.u.RGBA.rgba = image->data;
+	config.output.u.RGBA.stride = image->stride;
+	config.output.u.RGBA.size = config.output.u.RGBA.stride * image->height;
+	if (G_BYTE_ORDER == G_LITTLE_ENDIAN)
+		config.output.colorspace = MODE_bgrA;
+	else
+		config.output.colorspace = MODE_Argb;
+
+	WebPIDecoder *idec = WebPIDecode(NULL, 0, &config);
+	if (!idec) {
+		fiv_io_image_unref(image);
+		return NULL;
+	}
+
+	// WebPIUpdate() is fine with the buffer moving around between calls.
+	while (WebPIUpdate(idec, self->data->data, self->data->len) ==
+			VP8_STATUS_SUSPENDED) {
+		progressive_report(self, image, false);
+		if (!progressive_read(self))
+			break;
+	}
+	progressive_report(self, image, true);
+
+	WebPIDelete(idec);
+	WebPFreeDecBuffer(&config.output);
+	return image;
+}
+
+static FivIoImage *
+progressive_preview(FivIoProgressive *self)
+{
+	// Wuffs needs more than a few bytes to recognize some formats.
+	while (self->data->len < 64 && progressive_read(self))
+		;
+
+	wuffs_base__slice_u8 prefix =
+		wuffs_base__make_slice_u8(self->data->data, self->data->len);
+	int32_t fourcc = wuffs_base__magic_number_guess_fourcc(prefix, self->eof);
+	if (fourcc <= 0)
+		return NULL;
+
+	const FivIoBackend *backend = backend_for(fourcc, self->ctx->backend);
+	if (!backend)
+		return NULL;
+	if (backend->allocate)
+		return progressive_wuffs(self, backend->allocate);
+	if (backend->open == open_libjpeg_turbo)
+		return progressive_jpeg(self);
+	if (backend->open == open_libwebp)
+		return progressive_webp(self);
+	return NULL;
+}
+
+static gchar *
+progressive_load(GFile *file,
+	const FivIoOpenContext *ctx, gsize *len, GError **error)
+{
+	GFileInputStream *stream = g_file_read(file, ctx->cancellable, error);
+	if (!stream)
+		return NULL;
+
+	FivIoProgressive self = {
+		.ctx = ctx,
+		.stream = G_INPUT_STREAM(stream),
+		.data = g_byte_array_new(),
+	};
+
+	FivIoImage *preview = progressive_preview(&self);
+	g_clear_pointer(&preview, fiv_io_image_unref);
+	while (progressive_read(&self))
+		;
+
+	g_object_unref(stream);
+	if (self.error) {
+		g_propagate_error(error, self.error);
+		g_byte_array_free(self.data, TRUE);
+		return NULL;
+	}
+
+	// Terminate the data like g_file_load_contents() does.
+	*len = self.data->len;
+	g_byte_array_append(self.data, (const guint8 *) "", 1);
+	return (gchar *) g_byte_array_free(self.data, FALSE);
+}
+
+FivIoImage *
+fiv_io_open(const FivIoOpenContext *ctx, GError **error)
+{
+	// TODO(p): Don't always load everything into memory, test type first,
+	// so that we can reject non-pictures early.  Wuffs only needs the first
+	// 17 bytes to make a guess right now.
 	//
 	// LibRaw poses an issue--there is no good registry for identification
 	// of supported files.  Many of them are compliant TIFF files.
@@ -2968,10 +5199,13 @@ fiv_io_open(const FivIoOpenContext *ctx, GError **error)
 
 	gchar *data = NULL;
 	gsize len = 0;
-	gboolean success =
-		g_file_load_contents(file, NULL, &data, &len, NULL, error);
+	if (ctx->progress)
+		data = progressive_load(file, ctx, &len, error);
+	else if (!g_file_load_contents(
+			file, ctx->cancellable, &data, &len, NULL, error))
+		data = NULL;
 	g_object_unref(file);
-	if (!success)
+	if (!data)
 		return NULL;
 
 	FivIoImage *image = fiv_io_open_from_data(data, len, ctx, error);
@@ -2979,113 +5213,120 @@ fiv_io_open(const FivIoOpenContext *ctx, GError **error)
 	return image;
 }
 
+// Cancellation makes loaders fail, which must not be mistaken for the format
+// being unsupported, and tried with the remaining loaders, or gdk-pixbuf.
+static bool
+loader_cancelled(const FivIoOpenContext *ctx, GError **error)
+{
+	if (!g_cancellable_is_cancelled(ctx->cancellable))
+		return false;
+
+	g_clear_error(error);
+	return g_cancellable_set_error_if_cancelled(ctx->cancellable, error);
+}
+
+static bool
+loader_failed(const FivIoOpenContext *ctx, GError **error)
+{
+	if (loader_cancelled(ctx, error))
+		return true;
+	if (error && *error) {
+		g_debug("%s", (*error)->message);
+		g_clear_error(error);
+	}
+	return false;
+}
+
 FivIoImage *
 fiv_io_open_from_data(
 	const char *data, size_t len, const FivIoOpenContext *ctx, GError **error)
 {
 	wuffs_base__slice_u8 prefix =
 		wuffs_base__make_slice_u8((uint8_t *) data, len);
+	uint32_t fourcc =
+		wuffs_base__magic_number_guess_fourcc(prefix, true /* closed */);
 
 	FivIoImage *image = NULL;
-	switch (wuffs_base__magic_number_guess_fourcc(prefix, true /* closed */)) {
+	unsigned loaders = 0;
+	switch (fourcc) {
 	case WUFFS_BASE__FOURCC__BMP:
-		// Note that BMP can redirect into another format,
-		// which is so far unsupported here.
-		image = open_wuffs_using(
-			wuffs_bmp__decoder__alloc_as__wuffs_base__image_decoder, data, len,
-			ctx, error);
-		break;
 	case WUFFS_BASE__FOURCC__GIF:
-		image = open_wuffs_using(
-			wuffs_gif__decoder__alloc_as__wuffs_base__image_decoder, data, len,
-			ctx, error);
-		break;
 	case WUFFS_BASE__FOURCC__PNG:
-		image = open_wuffs_using(
-			wuffs_png__decoder__alloc_as__wuffs_base__image_decoder, data, len,
-			ctx, error);
-		break;
 	case WUFFS_BASE__FOURCC__TGA:
-		image = open_wuffs_using(
-			wuffs_tga__decoder__alloc_as__wuffs_base__image_decoder, data, len,
-			ctx, error);
-		break;
+	case WUFFS_BASE__FOURCC__NIE:
+	case WUFFS_BASE__FOURCC__WBMP:
 	case WUFFS_BASE__FOURCC__JPEG:
-		image = open_libjpeg_turbo(data, len, ctx, error);
-		break;
 	case WUFFS_BASE__FOURCC__WEBP:
-		image = open_libwebp(data, len, ctx, error);
+		image = backend_open(
+			backend_for(fourcc, ctx->backend), data, len, ctx, error);
 		break;
 	default:
+		loaders = ctx->try_all_loaders ? SNIFF_ALL : sniff(data, len);
+
 		// Try to extract full-size previews from TIFF/EP-compatible raws,
 		// but allow for running the full render.
 #ifdef HAVE_LIBRAW  // ---------------------------------------------------------
 		if (!ctx->enhance) {
 #endif  // HAVE_LIBRAW ---------------------------------------------------------
-		if ((image = open_tiff_ep(data, len, ctx, error)))
+		if ((loaders & SNIFF_TIFF_EP) &&
+			(image = open_tiff_ep(data, len, ctx, error)))
 			break;
-		if (error) {
-			g_debug("%s", (*error)->message);
-			g_clear_error(error);
-		}
+		if (loader_failed(ctx, error))
+			return NULL;
 #ifdef HAVE_LIBRAW  // ---------------------------------------------------------
 		}
-		if ((image = open_libraw(data, len, ctx, error)))
+		if ((loaders & SNIFF_LIBRAW) &&
+			(image = open_libraw(data, len, ctx, error)))
 			break;
 
 		// TODO(p): We should try to pass actual processing errors through,
 		// notably only continue with LIBRAW_FILE_UNSUPPORTED.
-		if (error) {
-			g_debug("%s", (*error)->message);
-			g_clear_error(error);
-		}
+		if (loader_failed(ctx, error))
+			return NULL;
 #endif  // HAVE_LIBRAW ---------------------------------------------------------
 #ifdef HAVE_RESVG  // ----------------------------------------------------------
-		if ((image = open_resvg(data, len, ctx, error)))
+		if ((loaders & SNIFF_SVG) &&
+			(image = open_resvg(data, len, ctx, error)))
 			break;
-		if (error) {
-			g_debug("%s", (*error)->message);
-			g_clear_error(error);
-		}
+		if (loader_failed(ctx, error))
+			return NULL;
 #endif  // HAVE_RESVG ----------------------------------------------------------
 #ifdef HAVE_LIBRSVG  // --------------------------------------------------------
-		if ((image = open_librsvg(data, len, ctx, error)))
+		if ((loaders & SNIFF_SVG) &&
+			(image = open_librsvg(data, len, ctx, error)))
 			break;
 
 		// XXX: It doesn't look like librsvg can return sensible errors.
-		if (error) {
-			g_debug("%s", (*error)->message);
-			g_clear_error(error);
-		}
+		if (loader_failed(ctx, error))
+			return NULL;
 #endif  // HAVE_LIBRSVG --------------------------------------------------------
 #ifdef HAVE_XCURSOR  //---------------------------------------------------------
-		if ((image = open_xcursor(data, len, ctx, error)))
+		if ((loaders & SNIFF_XCURSOR) &&
+			(image = open_xcursor(data, len, ctx, error)))
 			break;
-		if (error) {
-			g_debug("%s", (*error)->message);
-			g_clear_error(error);
-		}
+		if (loader_failed(ctx, error))
+			return NULL;
 #endif  // HAVE_XCURSOR --------------------------------------------------------
 #ifdef HAVE_LIBHEIF  //---------------------------------------------------------
-		if ((image = open_libheif(data, len, ctx, error)))
+		if ((loaders & SNIFF_LIBHEIF) &&
+			(image = open_libheif(data, len, ctx, error)))
 			break;
-		if (error) {
-			g_debug("%s", (*error)->message);
-			g_clear_error(error);
-		}
+		if (loader_failed(ctx, error))
+			return NULL;
 #endif  // HAVE_LIBHEIF --------------------------------------------------------
 #ifdef HAVE_LIBTIFF  //---------------------------------------------------------
 		// This needs to be positioned after LibRaw.
-		if ((image = open_libtiff(data, len, ctx, error)))
+		if ((loaders & SNIFF_LIBTIFF) &&
+			(image = open_libtiff(data, len, ctx, error)))
 			break;
-		if (error) {
-			g_debug("%s", (*error)->message);
-			g_clear_error(error);
-		}
+		if (loader_failed(ctx, error))
+			return NULL;
 #endif  // HAVE_LIBTIFF --------------------------------------------------------
 
 		set_error(error, "unsupported file type");
 	}
+	if (!image && loader_cancelled(ctx, error))
+		return NULL;
 
 #ifdef HAVE_GDKPIXBUF  // ------------------------------------------------------
 	// This is used as a last resort, the rest above is special-cased.
@@ -3342,7 +5583,7 @@ encode_lossless_webp(FivIoImage *image)
 	if (!WebPConfigInit(&config) || !WebPConfigLosslessPreset(&config, 6))
 		return bitstream;
 
-	config.thread_level = true;
+	config.thread_level = fiv_io_work_threads() > 1;
 	if (!WebPValidateConfig(&config))
 		return bitstream;
 
@@ -24,6 +24,7 @@
 
 typedef enum _FivIoOrientation FivIoOrientation;
 typedef struct _FivIoRenderClosure FivIoRenderClosure;
+typedef struct _FivIoDeferred FivIoDeferred;
 typedef struct _FivIoImage FivIoImage;
 typedef struct _FivIoProfile FivIoProfile;
 
@@ -70,11 +71,43 @@ void fiv_io_cmm_any(FivIoCmm *self,
 FivIoImage *fiv_io_cmm_finish(FivIoCmm *self,
 	FivIoImage *image, FivIoProfile *target);
 
+// --- Background work ---------------------------------------------------------
+// All background work shares a process-wide pool of threads, as many as there
+// are processors, which takes jobs in the order of their priority.
+
+typedef enum _FivIoWorkPriority {
+	FivIoWorkInteractive,               ///< Decoding what is to be shown now
+	FivIoWorkPrefetch,                  ///< Decoding what may be shown next
+	FivIoWorkUpgrade,                   ///< Quality upgrades
+	FivIoWorkPriorityCount
+} FivIoWorkPriority;
+
+typedef void (*FivIoWorkFunc)(gpointer data, GCancellable *cancellable);
+
+/// Queue a job. It is skipped if the cancellable is cancelled before it starts.
+/// In either case, `destroy` is called on `data` afterwards.
+void fiv_io_work_push(FivIoWorkPriority priority, GCancellable *cancellable,
+	FivIoWorkFunc func, gpointer data, GDestroyNotify destroy);
+
+/// Like g_task_run_in_thread(), only using the shared pool.
+/// Tasks cancelled before they get to run return G_IO_ERROR_CANCELLED.
+void fiv_io_work_run_task(
+	GTask *task, FivIoWorkPriority priority, GTaskThreadFunc func);
+
+/// Call `func` for each index below `n` in parallel, taking part in it,
+/// and wait for all calls to finish. Jobs inherit the caller's priority.
+void fiv_io_work_parallel(
+	guint n, void (*func)(gpointer data, guint index), gpointer data);
+
+/// Return how many threads a job may use internally without oversubscribing.
+guint fiv_io_work_threads(void);
+
 // --- Loading -----------------------------------------------------------------
 
 extern const char *fiv_io_supported_media_types[];
 
 gchar **fiv_io_all_supported_media_types(void);
+gchar **fiv_io_all_supported_globs(void);
 
 // https://www.cipa.jp/std/documents/e/DC-008-2012_E.pdf Table 6
 enum _FivIoOrientation {
@@ -95,13 +128,26 @@ struct _FivIoRenderClosure {
 	/// The rendering is allowed to fail, returning NULL.
 	FivIoImage *(*render)(
 		FivIoRenderClosure *, FivIoCmm *, FivIoProfile *, double scale);
+	/// Optional. Renders only the given region of what render() would return,
+	/// which need not lie within its bounds. It is allowed to fail as well.
+	/// It may be called from any thread, including concurrently.
+	FivIoImage *(*render_region)(FivIoRenderClosure *, FivIoCmm *,
+		FivIoProfile *, double scale, const cairo_rectangle_int_t *region);
 	void (*destroy)(FivIoRenderClosure *);
 };
 
+struct _FivIoDeferred {
+	/// Decodes data into the page, which has its final format and dimensions,
+	/// but is blank until then. It is allowed to fail.
+	gboolean (*load)(FivIoDeferred *, FivIoImage *page, GError **);
+	void (*destroy)(FivIoDeferred *);
+};
+
 // Metadata are typically attached to all Cairo surfaces in an animation.
 
 struct _FivIoImage {
 	uint8_t *data;                      ///< Raw image data
+	size_t data_size;                   ///< Allocated size of the data
 	cairo_format_t format;              ///< Data format
 	uint32_t width;                     ///< Width of the image in pixels
 	uint32_t stride;                    ///< Row stride in bytes
@@ -122,6 +168,19 @@ struct _FivIoImage {
 	/// This is attached at the page level.
 	FivIoRenderClosure *render;
 
+	/// A FivIoDeferred for pages that are only decoded once they're needed,
+	/// see fiv_io_image_undefer(). This is attached at the page level.
+	FivIoDeferred *deferred;
+
+	/// Whether this page is a reduced resolution preview,
+	/// and the full picture can be obtained with FivIoOpenContext::enhance.
+	gboolean preview;
+
+	/// Where non-zero, this page is a reduced resolution draft of a picture
+	/// with these dimensions, which is what FivIoRenderClosure renders.
+	uint32_t full_width;
+	uint32_t full_height;
+
 	/// The first frame of the next page, in a chain.
 	/// There is no wrap-around.
 	FivIoImage *page_next;
@@ -153,6 +212,23 @@ void fiv_io_image_unref(FivIoImage *image);
 FivIoImage *fiv_io_image_new(
 	cairo_format_t format, uint32_t width, uint32_t height);
 
+/// Large image buffers are recycled through a process-wide pool.
+typedef struct _FivIoImagePoolStats {
+	guint64 hits;                       ///< Allocations served from the pool
+	guint64 misses;                     ///< Allocations of new memory
+	guint64 evictions;                  ///< Buffers released over budget
+	gsize retained;                     ///< Bytes held for reuse
+	guint retained_buffers;             ///< Buffers held for reuse
+} FivIoImagePoolStats;
+
+void fiv_io_image_pool_stats(FivIoImagePoolStats *stats);
+
+/// Decode page data that the loader has deferred, if any, and colour manage
+/// them. Returns FALSE on failure, in which case the page stays blank.
+/// This is not thread-safe.
+gboolean fiv_io_image_undefer(FivIoImage *page,
+	FivIoCmm *cmm, FivIoProfile *target, GError **error);
+
 /// Return a new Cairo image surface referencing the same data as the image,
 /// eating the reference to it.
 cairo_surface_t *fiv_io_image_to_surface(FivIoImage *image);
@@ -170,7 +246,16 @@ typedef struct {
 	int screen_dpi;                     ///< Target DPI
 	gboolean enhance;                   ///< Enhance JPEG (currently)
 	gboolean first_frame_only;          ///< Only interested in the 1st frame
+	gboolean try_all_loaders;           ///< Don't sniff, for benchmarking
+	const char *backend;                ///< Preferred decoder backend or NULL
+	GCancellable *cancellable;          ///< Abandons loading, or NULL
 	GPtrArray *warnings;                ///< String vector for non-fatal errors
+
+	/// Receives partially decoded images while fiv_io_open() is reading
+	/// the file, from the calling thread. These are not colour managed,
+	/// and keep changing until the function returns.
+	void (*progress)(FivIoImage *partial, gpointer user_data);
+	gpointer progress_data;             ///< User data for the progress callback
 } FivIoOpenContext;
 
 FivIoImage *fiv_io_open(const FivIoOpenContext *ctx, GError **error);
@@ -179,6 +264,23 @@ FivIoImage *fiv_io_open_from_data(
 
 FivIoImage *fiv_io_open_png_thumbnail(const char *path, GError **error);
 
+/// Decode a libheif image handle, such as a thumbnail, without any metadata.
+/// Only available when built with libheif.
+struct heif_image_handle;
+FivIoImage *fiv_io_open_libheif_handle(
+	struct heif_image_handle *handle, GError **error);
+
+/// Decode the smallest JPEG preview embedded in a raw or JPEG file
+/// that is at least `min_size` pixels along its longer side,
+/// or the largest one there is. Only the necessary parts of the file are read,
+/// which makes this suitable for slow remote files.
+FivIoImage *fiv_io_open_preview(
+	const FivIoOpenContext *ctx, int min_size, GError **error);
+
+/// Lists decoder backends that FivIoOpenContext::backend may select
+/// for the given data, starting with the default. May be empty.
+gchar **fiv_io_backends_for_data(const char *data, size_t len);
+
 // --- Metadata ----------------------------------------------------------------
 
 /// Returns a rendering matrix for an image (user space to pattern space),
@@ -27,10 +27,83 @@ struct _FivSidebar {
 	GtkPlacesSidebar *places;
 	GtkWidget *listbox;
 	FivIoModel *model;
+
+	GListStore *items;                  ///< FivSidebarItem objects in listbox
+	GFile *location;                    ///< Location of the breadcrumbs
+	guint breadcrumbs_len;              ///< Parents and the location in items
+	GCancellable *cancellable;          ///< Breadcrumb information queries
+
+	GPtrArray *pending;                 ///< Subdirectories yet to be added
+	guint pending_offset;               ///< First unprocessed pending entry
+	guint pending_source;               ///< Pending items idle source ID
 };
 
 G_DEFINE_TYPE(FivSidebar, fiv_sidebar, GTK_TYPE_SCROLLED_WINDOW)
 
+// --- Items -------------------------------------------------------------------
+
+// Rows are created from these, so that the listbox can be changed piecewise,
+// and so that producing rows involves no I/O.
+#define FIV_TYPE_SIDEBAR_ITEM (fiv_sidebar_item_get_type())
+G_DECLARE_FINAL_TYPE(
+	FivSidebarItem, fiv_sidebar_item, FIV, SIDEBAR_ITEM, GObject)
+
+struct _FivSidebarItem {
+	GObject parent_instance;
+	GFile *location;                    ///< Where the row leads to
+	gchar *uri;                         ///< URI of a subdirectory, or NULL
+	gchar *name;                        ///< Label for the row
+	const char *icon_name;              ///< Icon for the row
+};
+
+G_DEFINE_TYPE(FivSidebarItem, fiv_sidebar_item, G_TYPE_OBJECT)
+
+static void
+fiv_sidebar_item_finalize(GObject *gobject)
+{
+	FivSidebarItem *self = FIV_SIDEBAR_ITEM(gobject);
+	g_object_unref(self->location);
+	g_free(self->uri);
+	g_free(self->name);
+
+	G_OBJECT_CLASS(fiv_sidebar_item_parent_class)->finalize(gobject);
+}
+
+static void
+fiv_sidebar_item_class_init(FivSidebarItemClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fiv_sidebar_item_finalize;
+}
+
+static void
+fiv_sidebar_item_init(G_GNUC_UNUSED FivSidebarItem *self)
+{
+}
+
+static FivSidebarItem *
+fiv_sidebar_item_new(GFile *location, const char *name, const char *icon_name)
+{
+	FivSidebarItem *self = g_object_new(FIV_TYPE_SIDEBAR_ITEM, NULL);
+	self->location = g_object_ref(location);
+	self->name = g_strdup(name);
+	self->icon_name = icon_name;
+	return self;
+}
+
+static FivSidebarItem *
+fiv_sidebar_item_new_for_entry(FivIoModelEntry *entry)
+{
+	GFile *location = g_file_new_for_uri(entry->uri);
+	FivSidebarItem *self =
+		fiv_sidebar_item_new(location, entry->display_name, "go-down-symbolic");
+	self->uri = g_strdup(entry->uri);
+	g_object_unref(location);
+	return self;
+}
+
+// --- Sidebar -----------------------------------------------------------------
+
 G_DEFINE_QUARK(fiv-sidebar-drag-gesture-quark, fiv_sidebar_drag_gesture)
 G_DEFINE_QUARK(fiv-sidebar-location-quark, fiv_sidebar_location)
 G_DEFINE_QUARK(fiv-sidebar-self-quark, fiv_sidebar_self)
@@ -51,6 +124,17 @@ fiv_sidebar_dispose(GObject *gobject)
 		g_signal_handlers_disconnect_by_data(self->model, self);
 		g_clear_object(&self->model);
 	}
+	if (self->cancellable) {
+		g_cancellable_cancel(self->cancellable);
+		g_clear_object(&self->cancellable);
+	}
+	if (self->pending_source) {
+		g_source_remove(self->pending_source);
+		self->pending_source = 0;
+	}
+	g_clear_pointer(&self->pending, g_ptr_array_unref);
+	g_clear_object(&self->location);
+	g_clear_object(&self->items);
 
 	G_OBJECT_CLASS(fiv_sidebar_parent_class)->dispose(gobject);
 }
@@ -216,19 +300,14 @@ on_breadcrumb_popup_menu(GtkWidget *widget, G_GNUC_UNUSED gpointer user_data)
 }
 
 static GtkWidget *
-create_row(FivSidebar *self, GFile *file, const char *icon_name)
+create_row(gpointer item, gpointer user_data)
 {
-	GError *error = NULL;
-	GFileInfo *info =
-		g_file_query_info(file, G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
-			G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, NULL, &error);
-	if (!info) {
-		g_debug("%s", error->message);
-		g_error_free(error);
-		return NULL;
-	}
+	FivSidebar *self = FIV_SIDEBAR(user_data);
+	FivSidebarItem *sidebar_item = FIV_SIDEBAR_ITEM(item);
+	const char *name = sidebar_item->name;
+	const char *icon_name = sidebar_item->icon_name;
+	GFile *file = sidebar_item->location;
 
-	const char *name = g_file_info_get_display_name(info);
 	GtkWidget *rowbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
 
 	GtkWidget *rowimage =
@@ -291,7 +370,6 @@ create_row(FivSidebar *self, GFile *file, const char *icon_name)
 
 	gtk_container_add(GTK_CONTAINER(row), revealer);
 	gtk_widget_show_all(row);
-	g_object_unref(info);
 	return row;
 }
 
@@ -311,51 +389,248 @@ on_update_task_done(GObject *source_object, G_GNUC_UNUSED GAsyncResult *res,
 		self->places, fiv_io_model_get_location(self->model));
 }
 
+static gint
+find_item(FivSidebar *self, gpointer item)
+{
+	GListModel *items = G_LIST_MODEL(self->items);
+	guint len = g_list_model_get_n_items(items);
+	for (guint i = 0; i < len; i++) {
+		gpointer iter = g_list_model_get_item(items, i);
+		g_object_unref(iter);
+		if (iter == item)
+			return i;
+	}
+	return -1;
+}
+
+static gint
+find_subdir(FivSidebar *self, const char *uri)
+{
+	GListModel *items = G_LIST_MODEL(self->items);
+	guint len = g_list_model_get_n_items(items);
+	for (guint i = self->breadcrumbs_len; i < len; i++) {
+		FivSidebarItem *item = g_list_model_get_item(items, i);
+		gboolean match = !g_strcmp0(item->uri, uri);
+		g_object_unref(item);
+		if (match)
+			return i;
+	}
+	return -1;
+}
+
 static void
-reload_directories(FivSidebar *self)
+on_breadcrumb_info(GObject *source_object, GAsyncResult *res,
+	gpointer user_data)
 {
-	GFile *location = fiv_io_model_get_location(self->model);
-	gtk_container_foreach(GTK_CONTAINER(self->listbox),
-		(GtkCallback) gtk_widget_destroy, NULL);
+	FivSidebarItem *item = FIV_SIDEBAR_ITEM(user_data);
+	GError *error = NULL;
+	GFileInfo *info =
+		g_file_query_info_finish(G_FILE(source_object), res, &error);
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free(error);
+		g_object_unref(item);
+		return;
+	}
+
+	FivSidebar *self = g_object_get_qdata(
+		G_OBJECT(item), fiv_sidebar_self_quark());
+	gint position = find_item(self, item);
+	if (position < 0 || position >= (gint) self->breadcrumbs_len) {
+		// The item has been replaced.
+	} else if (!info) {
+		g_debug("%s", error->message);
+		g_list_store_remove(self->items, position);
+		self->breadcrumbs_len--;
+	} else {
+		// Replacing the item makes the listbox recreate its row.
+		g_free(item->name);
+		item->name = g_strdup(g_file_info_get_display_name(info));
+		g_list_store_splice(self->items, position, 1, (gpointer *) &item, 1);
+	}
+
+	g_clear_error(&error);
+	g_clear_object(&info);
+	g_object_unref(item);
+}
+
+static void
+reload_breadcrumbs(FivSidebar *self, GFile *location)
+{
+	if (self->cancellable)
+		g_cancellable_cancel(self->cancellable);
+	g_clear_object(&self->cancellable);
+	g_clear_object(&self->location);
+
+	g_list_store_remove_all(self->items);
+	self->breadcrumbs_len = 0;
 	if (!location)
 		return;
 
+	// Show something immediately, and refine it once information arrives.
+	self->cancellable = g_cancellable_new();
+	self->location = g_object_ref(location);
+
+	GPtrArray *breadcrumbs = g_ptr_array_new_with_free_func(g_object_unref);
 	GFile *iter = g_object_ref(location);
-	GtkWidget *row = NULL;
 	while (TRUE) {
 		GFile *parent = g_file_get_parent(iter);
 		g_object_unref(iter);
 		if (!(iter = parent))
 			break;
 
-		if ((row = create_row(self, parent, "go-up-symbolic")))
-			gtk_list_box_prepend(GTK_LIST_BOX(self->listbox), row);
+		gchar *basename = g_file_get_basename(parent);
+		g_ptr_array_insert(breadcrumbs, 0,
+			fiv_sidebar_item_new(parent, basename, "go-up-symbolic"));
+		g_free(basename);
 	}
 
 	// Other options are "folder-{visiting,open}-symbolic", though the former
 	// is mildly inappropriate (means: open in another window).
-	if ((row = create_row(self, location, "circle-filled-symbolic")))
-		gtk_container_add(GTK_CONTAINER(self->listbox), row);
+	gchar *basename = g_file_get_basename(location);
+	g_ptr_array_add(breadcrumbs,
+		fiv_sidebar_item_new(location, basename, "circle-filled-symbolic"));
+	g_free(basename);
+
+	g_list_store_splice(
+		self->items, 0, 0, breadcrumbs->pdata, breadcrumbs->len);
+	self->breadcrumbs_len = breadcrumbs->len;
+
+	for (guint i = 0; i < breadcrumbs->len; i++) {
+		FivSidebarItem *item = breadcrumbs->pdata[i];
+		g_object_set_qdata(G_OBJECT(item), fiv_sidebar_self_quark(), self);
+		g_file_query_info_async(item->location,
+			G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
+			G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, G_PRIORITY_DEFAULT,
+			self->cancellable, on_breadcrumb_info, g_object_ref(item));
+	}
+	g_ptr_array_free(breadcrumbs, TRUE);
+}
+
+// Keeps the user interface responsive with large numbers of subdirectories.
+static gboolean
+on_pending_subdirs(gpointer user_data)
+{
+	FivSidebar *self = FIV_SIDEBAR(user_data);
+	enum { BATCH = 256 };
+
+	guint count = MIN(BATCH, self->pending->len - self->pending_offset);
+	gpointer *items = g_new(gpointer, count);
+	for (guint i = 0; i < count; i++) {
+		items[i] = fiv_sidebar_item_new_for_entry(
+			self->pending->pdata[self->pending_offset + i]);
+	}
+	g_list_store_splice(self->items,
+		g_list_model_get_n_items(G_LIST_MODEL(self->items)), 0, items, count);
+	for (guint i = 0; i < count; i++)
+		g_object_unref(items[i]);
+	g_free(items);
+
+	if ((self->pending_offset += count) < self->pending->len)
+		return G_SOURCE_CONTINUE;
+
+	g_clear_pointer(&self->pending, g_ptr_array_unref);
+	self->pending_offset = 0;
+	self->pending_source = 0;
+	return G_SOURCE_REMOVE;
+}
+
+static void
+reload_subdirs(FivSidebar *self)
+{
+	if (self->pending_source) {
+		g_source_remove(self->pending_source);
+		self->pending_source = 0;
+	}
+	g_clear_pointer(&self->pending, g_ptr_array_unref);
+	self->pending_offset = 0;
+
+	guint len = g_list_model_get_n_items(G_LIST_MODEL(self->items));
+	g_list_store_splice(self->items, self->breadcrumbs_len,
+		len - self->breadcrumbs_len, NULL, 0);
 
-	gsize len = 0;
+	gsize subdirs_len = 0;
 	FivIoModelEntry *const *subdirs =
-		fiv_io_model_get_subdirs(self->model, &len);
-	for (gsize i = 0; i < len; i++) {
-		GFile *file = g_file_new_for_uri(subdirs[i]->uri);
-		if ((row = create_row(self, file, "go-down-symbolic")))
-			gtk_container_add(GTK_CONTAINER(self->listbox), row);
-		g_object_unref(file);
+		fiv_io_model_get_subdirs(self->model, &subdirs_len);
+	if (!subdirs_len)
+		return;
+
+	self->pending = g_ptr_array_new_full(
+		subdirs_len, (GDestroyNotify) fiv_io_model_entry_unref);
+	for (gsize i = 0; i < subdirs_len; i++)
+		g_ptr_array_add(self->pending, fiv_io_model_entry_ref(subdirs[i]));
+
+	// Add the first batch right away, so that small directories don't flicker.
+	if (on_pending_subdirs(self) == G_SOURCE_CONTINUE) {
+		self->pending_source = g_idle_add_full(
+			G_PRIORITY_DEFAULT_IDLE, on_pending_subdirs, self, NULL);
 	}
 }
 
+static void
+reload_directories(FivSidebar *self)
+{
+	// Parent directories only change with the location.
+	GFile *location = fiv_io_model_get_location(self->model);
+	if (!location || !self->location || !g_file_equal(location, self->location))
+		reload_breadcrumbs(self, location);
+	if (location)
+		reload_subdirs(self);
+}
+
+static gint
+find_pending(FivSidebar *self, const char *uri)
+{
+	if (!self->pending)
+		return -1;
+
+	for (guint i = self->pending_offset; i < self->pending->len; i++) {
+		FivIoModelEntry *entry = self->pending->pdata[i];
+		if (!strcmp(entry->uri, uri))
+			return i;
+	}
+	return -1;
+}
+
 static void
 on_model_subdirectories_changed(G_GNUC_UNUSED FivIoModel *model,
 	FivIoModelEntry *old, FivIoModelEntry *new, gpointer user_data)
 {
 	FivSidebar *self = FIV_SIDEBAR(user_data);
-	// TODO(p): Optimize: there's no need to update parent directories.
-	if (!old || !new || strcmp(old->uri, new->uri))
-		reload_directories(self);
+	if (!self->location)
+		return;
+
+	// Subdirectories that haven't been shown yet can be changed in place.
+	gint index = -1;
+	if (old && (index = find_pending(self, old->uri)) >= 0) {
+		if (new) {
+			fiv_io_model_entry_unref(self->pending->pdata[index]);
+			self->pending->pdata[index] = fiv_io_model_entry_ref(new);
+		} else {
+			g_ptr_array_remove_index(self->pending, index);
+		}
+		return;
+	}
+
+	gint position = old ? find_subdir(self, old->uri) : -1;
+	if (!new) {
+		if (position >= 0)
+			g_list_store_remove(self->items, position);
+		return;
+	}
+
+	// The model appends additions, and so do we.
+	if (position < 0 && self->pending) {
+		g_ptr_array_add(self->pending, fiv_io_model_entry_ref(new));
+		return;
+	}
+
+	FivSidebarItem *item = fiv_sidebar_item_new_for_entry(new);
+	if (position >= 0) {
+		g_list_store_splice(self->items, position, 1, (gpointer *) &item, 1);
+	} else {
+		g_list_store_append(self->items, item);
+	}
+	g_object_unref(item);
 }
 
 static void
@@ -380,6 +655,13 @@ update_location(FivSidebar *self)
 	g_object_unref(collection);
 
 	gtk_places_sidebar_set_location(self->places, location);
+}
+
+static void
+on_model_reloaded(G_GNUC_UNUSED FivIoModel *model, gpointer user_data)
+{
+	FivSidebar *self = FIV_SIDEBAR(user_data);
+	update_location(self);
 	reload_directories(self);
 }
 
@@ -405,34 +687,163 @@ on_open_location(G_GNUC_UNUSED GtkPlacesSidebar *sidebar, GFile *location,
 	update_location(self);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Directory listings are kept for a short while, so that typing doesn't keep
+// hitting the filesystem, which may well be a slow network mount.
+#define COMPLETION_CACHE_TTL (5 * G_USEC_PER_SEC)
+
+typedef struct {
+	GPtrArray *names;                   ///< Subdirectory basenames
+	GPtrArray *parse_names;             ///< Their completions
+	gint64 timestamp;                   ///< When the listing was finished
+} CompletionListing;
+
+static CompletionListing *
+completion_listing_new(void)
+{
+	CompletionListing *self = g_new0(CompletionListing, 1);
+	self->names = g_ptr_array_new_with_free_func(g_free);
+	self->parse_names = g_ptr_array_new_with_free_func(g_free);
+	return self;
+}
+
 static void
-complete_path(GFile *location, GtkListStore *model)
+completion_listing_free(CompletionListing *self)
 {
-	// TODO(p): Do not enter directories unless followed by '/'.
-	// This information has already been stripped from `location`.
-	// TODO(p): Try out GFileCompleter.
-	GFile *parent = G_FILE_TYPE_DIRECTORY ==
-			g_file_query_file_type(location, G_FILE_QUERY_INFO_NONE, NULL)
-		? g_object_ref(location)
-		: g_file_get_parent(location);
-	if (!parent)
-		return;
+	g_ptr_array_free(self->names, TRUE);
+	g_ptr_array_free(self->parse_names, TRUE);
+	g_free(self);
+}
 
-	GFileEnumerator *enumerator = g_file_enumerate_children(parent,
-		G_FILE_ATTRIBUTE_STANDARD_NAME
-		"," G_FILE_ATTRIBUTE_STANDARD_TYPE
-		"," G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN,
-		G_FILE_QUERY_INFO_NONE, NULL, NULL);
-	if (!enumerator)
-		goto fail_enumerator;
+typedef struct {
+	FivSidebar *sidebar;                ///< For resolving relative paths
+	GtkEntry *entry;                    ///< The entry being completed
+	GtkListStore *model;                ///< Completion entries
+	GHashTable *cache;                  ///< URI to CompletionListing
+	GCancellable *cancellable;          ///< Any running enumeration
+	GCancellable *check_cancellable;    ///< Any running existence check
+	GFile *directory;                   ///< Directory to complete from
+	gchar *prefix;                      ///< Basename prefix to filter by
+} LocationCompletion;
+
+static LocationCompletion *
+location_completion_new(FivSidebar *sidebar, GtkEntry *entry,
+	GtkListStore *model)
+{
+	LocationCompletion *self = g_new0(LocationCompletion, 1);
+	self->sidebar = sidebar;
+	self->entry = entry;
+	self->model = g_object_ref(model);
+	self->cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify) completion_listing_free);
+	return self;
+}
 
-	while (TRUE) {
-		GFileInfo *info = NULL;
-		GFile *child = NULL;
-		if (!g_file_enumerator_iterate(enumerator, &info, &child, NULL, NULL) ||
-			!info)
-			break;
+static void
+location_completion_cancel(GCancellable **cancellable)
+{
+	if (*cancellable) {
+		g_cancellable_cancel(*cancellable);
+		g_clear_object(cancellable);
+	}
+}
+
+static void
+location_completion_free(gpointer data, G_GNUC_UNUSED GClosure *closure)
+{
+	LocationCompletion *self = data;
+	location_completion_cancel(&self->cancellable);
+	location_completion_cancel(&self->check_cancellable);
+	g_object_unref(self->model);
+	g_hash_table_destroy(self->cache);
+	g_clear_object(&self->directory);
+	g_free(self->prefix);
+	g_free(self);
+}
+
+static CompletionListing *
+location_completion_lookup(LocationCompletion *self, GFile *directory)
+{
+	gchar *uri = g_file_get_uri(directory);
+	CompletionListing *listing = g_hash_table_lookup(self->cache, uri);
+	if (listing &&
+		g_get_monotonic_time() - listing->timestamp > COMPLETION_CACHE_TTL) {
+		g_hash_table_remove(self->cache, uri);
+		listing = NULL;
+	}
+	g_free(uri);
+	return listing;
+}
+
+static void
+location_completion_fill(LocationCompletion *self, CompletionListing *listing)
+{
+	// XXX: For some reason, this jumps around with longer lists.
+	gtk_list_store_clear(self->model);
+	for (guint i = 0; listing && i < listing->names->len; i++) {
+		if (g_str_has_prefix(listing->names->pdata[i], self->prefix)) {
+			gtk_list_store_insert_with_values(self->model, NULL, -1,
+				0, listing->parse_names->pdata[i], -1);
+		}
+	}
+}
+
+typedef struct {
+	LocationCompletion *completion;     ///< Only valid if not cancelled
+	GCancellable *cancellable;          ///< The job's cancellable
+	GFile *directory;                   ///< The directory being enumerated
+	CompletionListing *listing;         ///< Results so far
+} CompletionJob;
+
+static void
+completion_job_free(CompletionJob *self)
+{
+	g_object_unref(self->cancellable);
+	g_object_unref(self->directory);
+	if (self->listing)
+		completion_listing_free(self->listing);
+	g_free(self);
+}
+
+static void
+completion_job_finish(CompletionJob *self)
+{
+	LocationCompletion *completion = self->completion;
+	if (completion->cancellable == self->cancellable)
+		g_clear_object(&completion->cancellable);
+
+	CompletionListing *listing = g_steal_pointer(&self->listing);
+	listing->timestamp = g_get_monotonic_time();
+	g_hash_table_replace(
+		completion->cache, g_file_get_uri(self->directory), listing);
+	if (completion->directory &&
+		g_file_equal(completion->directory, self->directory))
+		location_completion_fill(completion, listing);
+
+	completion_job_free(self);
+}
+
+static void
+on_completion_next_files(
+	GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	GFileEnumerator *enumerator = G_FILE_ENUMERATOR(source_object);
+	CompletionJob *self = user_data;
+	GError *error = NULL;
+	GList *infos = g_file_enumerator_next_files_finish(enumerator, res, &error);
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free(error);
+		completion_job_free(self);
+		return;
+	}
+	if (error) {
+		g_debug("%s", error->message);
+		g_error_free(error);
+	}
 
+	for (GList *iter = infos; iter; iter = iter->next) {
+		GFileInfo *info = iter->data;
 		if (g_file_info_get_file_type(info) != G_FILE_TYPE_DIRECTORY)
 			continue;
 		if (g_file_info_has_attribute(info,
@@ -440,19 +851,123 @@ complete_path(GFile *location, GtkListStore *model)
 			g_file_info_get_is_hidden(info))
 			continue;
 
+		GFile *child = g_file_enumerator_get_child(enumerator, info);
 		gchar *parse_name = g_file_get_parse_name(child);
+		g_object_unref(child);
 		if (!g_str_has_suffix(parse_name, G_DIR_SEPARATOR_S)) {
 			gchar *save = parse_name;
 			parse_name = g_strdup_printf("%s%c", parse_name, G_DIR_SEPARATOR);
 			g_free(save);
 		}
-		gtk_list_store_insert_with_values(model, NULL, -1, 0, parse_name, -1);
-		g_free(parse_name);
+		g_ptr_array_add(self->listing->parse_names, parse_name);
+		g_ptr_array_add(
+			self->listing->names, g_strdup(g_file_info_get_name(info)));
 	}
 
+	if (infos) {
+		g_list_free_full(infos, g_object_unref);
+		g_file_enumerator_next_files_async(enumerator, 256, G_PRIORITY_DEFAULT,
+			self->cancellable, on_completion_next_files, self);
+		return;
+	}
+
+	g_file_enumerator_close_async(
+		enumerator, G_PRIORITY_DEFAULT, NULL, NULL, NULL);
 	g_object_unref(enumerator);
-fail_enumerator:
-	g_object_unref(parent);
+	completion_job_finish(self);
+}
+
+static void
+on_completion_enumerated(
+	GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	CompletionJob *self = user_data;
+	GError *error = NULL;
+	GFileEnumerator *enumerator = g_file_enumerate_children_finish(
+		G_FILE(source_object), res, &error);
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free(error);
+		completion_job_free(self);
+		return;
+	}
+	if (!enumerator) {
+		// Remember the failure as well, there is nothing to offer.
+		g_debug("%s", error->message);
+		g_error_free(error);
+		completion_job_finish(self);
+		return;
+	}
+
+	g_file_enumerator_next_files_async(enumerator, 256, G_PRIORITY_DEFAULT,
+		self->cancellable, on_completion_next_files, self);
+}
+
+static void
+location_completion_update(
+	LocationCompletion *self, GFile *directory, const char *prefix)
+{
+	gboolean same_directory = self->directory &&
+		directory && g_file_equal(self->directory, directory);
+
+	g_free(self->prefix);
+	self->prefix = g_strdup(prefix);
+	g_clear_object(&self->directory);
+	if (directory)
+		self->directory = g_object_ref(directory);
+
+	// Let any enumeration of the same directory finish.
+	if (same_directory && self->cancellable)
+		return;
+
+	location_completion_cancel(&self->cancellable);
+	if (!directory) {
+		gtk_list_store_clear(self->model);
+		return;
+	}
+
+	CompletionListing *listing = location_completion_lookup(self, directory);
+	if (listing) {
+		location_completion_fill(self, listing);
+		return;
+	}
+
+	// Keep whatever is in the model, it's better than flickering.
+	CompletionJob *job = g_new0(CompletionJob, 1);
+	job->completion = self;
+	job->cancellable = g_object_ref((self->cancellable = g_cancellable_new()));
+	job->directory = g_object_ref(directory);
+	job->listing = completion_listing_new();
+	g_file_enumerate_children_async(directory,
+		G_FILE_ATTRIBUTE_STANDARD_NAME
+		"," G_FILE_ATTRIBUTE_STANDARD_TYPE
+		"," G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN,
+		G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT, job->cancellable,
+		on_completion_enumerated, job);
+}
+
+static void
+on_location_checked(
+	GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	GError *error = NULL;
+	GFileInfo *info =
+		g_file_query_info_finish(G_FILE(source_object), res, &error);
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free(error);
+		return;
+	}
+
+	LocationCompletion *self = user_data;
+	GtkStyleContext *style =
+		gtk_widget_get_style_context(GTK_WIDGET(self->entry));
+	if (info)
+		gtk_style_context_remove_class(style, GTK_STYLE_CLASS_WARNING);
+	else
+		gtk_style_context_add_class(style, GTK_STYLE_CLASS_WARNING);
+
+	g_clear_error(&error);
+	g_clear_object(&info);
+	g_clear_object(&self->check_cancellable);
 }
 
 static GFile *
@@ -488,23 +1003,39 @@ resolve_location(FivSidebar *self, const char *text)
 static void
 on_enter_location_changed(GtkEntry *entry, gpointer user_data)
 {
-	FivSidebar *self = FIV_SIDEBAR(user_data);
+	LocationCompletion *self = user_data;
 	const char *text = gtk_entry_get_text(entry);
-	GFile *location = resolve_location(self, text);
+	GFile *location = resolve_location(self->sidebar, text);
 
 	// Don't touch the network anywhere around here, URIs are a no-no.
-	GtkStyleContext *style = gtk_widget_get_style_context(GTK_WIDGET(entry));
-	if (!g_file_peek_path(location) || g_file_query_exists(location, NULL))
-		gtk_style_context_remove_class(style, GTK_STYLE_CLASS_WARNING);
-	else
-		gtk_style_context_add_class(style, GTK_STYLE_CLASS_WARNING);
+	location_completion_cancel(&self->check_cancellable);
+	if (!g_file_peek_path(location)) {
+		gtk_style_context_remove_class(
+			gtk_widget_get_style_context(GTK_WIDGET(entry)),
+			GTK_STYLE_CLASS_WARNING);
+		location_completion_update(self, NULL, NULL);
+		g_object_unref(location);
+		return;
+	}
 
-	// XXX: For some reason, this jumps around with longer lists.
-	GtkEntryCompletion *completion = gtk_entry_get_completion(entry);
-	GtkTreeModel *model = gtk_entry_completion_get_model(completion);
-	gtk_list_store_clear(GTK_LIST_STORE(model));
-	if (g_file_peek_path(location))
-		complete_path(location, GTK_LIST_STORE(model));
+	self->check_cancellable = g_cancellable_new();
+	g_file_query_info_async(location, G_FILE_ATTRIBUTE_STANDARD_TYPE,
+		G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT, self->check_cancellable,
+		on_location_checked, self);
+
+	// Only enter directories when explicitly asked to, by a trailing slash,
+	// otherwise complete siblings.
+	if (g_str_has_suffix(text, "/") ||
+		g_str_has_suffix(text, G_DIR_SEPARATOR_S)) {
+		location_completion_update(self, location, "");
+	} else {
+		GFile *parent = g_file_get_parent(location);
+		gchar *prefix = g_file_get_basename(location);
+		location_completion_update(self, parent, prefix ? prefix : "");
+		g_free(prefix);
+		if (parent)
+			g_object_unref(parent);
+	}
 	g_object_unref(location);
 }
 
@@ -534,8 +1065,10 @@ on_show_enter_location(
 	GtkWidget *entry = gtk_entry_new();
 	gtk_entry_set_completion(GTK_ENTRY(entry), completion);
 	gtk_entry_set_activates_default(GTK_ENTRY(entry), TRUE);
-	g_signal_connect(entry, "changed",
-		G_CALLBACK(on_enter_location_changed), self);
+	g_signal_connect_data(entry, "changed",
+		G_CALLBACK(on_enter_location_changed),
+		location_completion_new(self, GTK_ENTRY(entry), model),
+		location_completion_free, 0);
 
 	GFile *location = fiv_io_model_get_location(self->model);
 	if (location) {
@@ -608,9 +1141,12 @@ fiv_sidebar_init(FivSidebar *self)
 	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(self->places),
 		GTK_POLICY_NEVER, GTK_POLICY_NEVER);
 
+	self->items = g_list_store_new(FIV_TYPE_SIDEBAR_ITEM);
 	self->listbox = gtk_list_box_new();
 	gtk_list_box_set_selection_mode(
 		GTK_LIST_BOX(self->listbox), GTK_SELECTION_NONE);
+	gtk_list_box_bind_model(GTK_LIST_BOX(self->listbox),
+		G_LIST_MODEL(self->items), create_row, self, NULL);
 	g_signal_connect(self->listbox, "row-activated",
 		G_CALLBACK(on_open_breadcrumb), self);
 
@@ -650,11 +1186,14 @@ fiv_sidebar_new(FivIoModel *model)
 		gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(self)));
 
 	self->model = g_object_ref(model);
-	g_signal_connect_swapped(self->model, "reloaded",
-		G_CALLBACK(update_location), self);
+	g_signal_connect(self->model, "reloaded",
+		G_CALLBACK(on_model_reloaded), self);
 	g_signal_connect(self->model, "subdirectories-changed",
 		G_CALLBACK(on_model_subdirectories_changed), self);
 
+	// The model might have already been loaded.
+	on_model_reloaded(self->model, self);
+
 	return GTK_WIDGET(self);
 }
 
@@ -37,6 +37,9 @@
 #define LIBRAW_OPIONS_NO_MEMERR_CALLBACK 0
 #endif
 #endif  // HAVE_LIBRAW
+#ifdef HAVE_LIBHEIF
+#include <libheif/heif.h>
+#endif  // HAVE_LIBHEIF
 
 // TODO(p): Consider merging back with fiv-io.
 #define FIV_THUMBNAIL_ERROR fiv_thumbnail_error_quark()
@@ -159,6 +162,37 @@ render(GFile *target, GBytes *data, gboolean *color_managed, GError **error)
 	return image;
 }
 
+// Only reads the necessary parts of the file, which may be remote.
+// Smaller previews than requested are refused, unless `any` is set.
+static FivIoImage *
+render_preview(GFile *target, int min_size, bool any, GError **error)
+{
+	FivIoCmm *cmm = fiv_io_cmm_get_default();
+	FivIoOpenContext ctx = {
+		.uri = g_file_get_uri(target),
+		// Remember to synchronize changes with adjust_thumbnail().
+		.cmm = cmm,
+		.screen_profile = fiv_io_cmm_get_profile_sRGB(cmm),
+		.screen_dpi = 96,
+		.first_frame_only = TRUE,
+		// Only using this array as a redirect.
+		.warnings = g_ptr_array_new_with_free_func(g_free),
+	};
+
+	FivIoImage *image = fiv_io_open_preview(&ctx, min_size, error);
+	g_free((gchar *) ctx.uri);
+	g_ptr_array_free(ctx.warnings, TRUE);
+	if (ctx.screen_profile)
+		fiv_io_profile_free(ctx.screen_profile);
+
+	if (image && !any &&
+		MAX(image->width, image->height) < (unsigned) min_size) {
+		set_error(error, "the embedded preview is too small");
+		g_clear_pointer(&image, fiv_io_image_unref);
+	}
+	return image;
+}
+
 // In principle similar to rescale_thumbnail() from fiv-browser.c.
 static FivIoImage *
 adjust_thumbnail(FivIoImage *thumbnail, double row_height)
@@ -187,8 +221,12 @@ adjust_thumbnail(FivIoImage *thumbnail, double row_height)
 		FivIoCmm *cmm = fiv_io_cmm_get_default();
 		FivIoProfile *screen_profile = fiv_io_cmm_get_profile_sRGB(cmm);
 		// This API doesn't accept non-uniform scaling; prefer a vertical fit.
+		// Drafts stand in for larger pictures, which is what gets rendered.
+		double scale = scale_y;
+		if (thumbnail->full_width && thumbnail->full_height)
+			scale *= (double) thumbnail->height / thumbnail->full_height;
 		FivIoImage *scaled =
-			closure->render(closure, cmm, screen_profile, scale_y);
+			closure->render(closure, cmm, screen_profile, scale);
 		if (screen_profile)
 			fiv_io_profile_free(screen_profile);
 		if (scaled)
@@ -513,6 +551,47 @@ fail:
 }
 
 #endif  // HAVE_LIBRAW
+#ifdef HAVE_LIBHEIF
+
+static FivIoImage *
+extract_libheif(GMappedFile *mf, GError **error)
+{
+	FivIoImage *I = NULL;
+	struct heif_context *ctx = heif_context_alloc();
+	struct heif_error err = heif_context_read_from_memory_without_copy(ctx,
+		g_mapped_file_get_contents(mf), g_mapped_file_get_length(mf), NULL);
+	if (err.code != heif_error_Ok) {
+		set_error(error, err.message);
+		goto fail;
+	}
+
+	struct heif_image_handle *primary = NULL;
+	if ((err = heif_context_get_primary_image_handle(ctx, &primary)).code !=
+		heif_error_Ok) {
+		set_error(error, err.message);
+		goto fail;
+	}
+
+	// There is typically just one, and whichever will do as a draft.
+	heif_item_id id = 0;
+	struct heif_image_handle *handle = NULL;
+	if (!heif_image_handle_get_list_of_thumbnail_IDs(primary, &id, 1))
+		set_error(error, "no thumbnails found");
+	else if ((err = heif_image_handle_get_thumbnail(primary, id, &handle))
+			.code != heif_error_Ok)
+		set_error(error, err.message);
+	else
+		I = fiv_io_open_libheif_handle(handle, error);
+
+	if (handle)
+		heif_image_handle_release(handle);
+	heif_image_handle_release(primary);
+fail:
+	heif_context_free(ctx);
+	return I;
+}
+
+#endif  // HAVE_LIBHEIF
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -536,6 +615,14 @@ fiv_thumbnail_extract(GFile *target, FivThumbnailSize max_size, GError **error)
 	}
 
 	FivIoImage *image = NULL;
+#ifdef HAVE_LIBHEIF
+	// HEIF thumbnails are proper image items, libheif applies transforms.
+	if (heif_check_filetype((const uint8_t *) g_mapped_file_get_contents(mf),
+			MIN(g_mapped_file_get_length(mf), G_MAXINT)) ==
+		heif_filetype_yes_supported)
+		image = extract_libheif(mf, error);
+	else
+#endif  // HAVE_LIBHEIF
 #ifdef HAVE_LIBRAW
 	image = extract_libraw(target, mf, error);
 #else  // ! HAVE_LIBRAW
@@ -566,7 +653,7 @@ encode_thumbnail(FivIoImage *image)
 		return bitstream;
 
 	config.near_lossless = 95;
-	config.thread_level = true;
+	config.thread_level = fiv_io_work_threads() > 1;
 	if (!WebPValidateConfig(&config))
 		return bitstream;
 
@@ -655,21 +742,31 @@ produce_fallback(GFile *target, FivThumbnailSize size, GError **error)
 		g_object_unref(info);
 	}
 
+	// Larger files are likely to be raw photos with embedded previews,
+	// which are much cheaper to fetch than the whole file.
+	FivIoImage *image = NULL;
+	GError *e = NULL;
+	if (filesize > 1 << 20 && !(image = render_preview(target,
+			fiv_thumbnail_sizes[size].size, filesize > 10 << 20, &e))) {
+		g_debug("%s", e->message);
+		g_clear_error(&e);
+	}
+
 	// TODO(p): Try to be a bit more intelligent about this.
 	// For example, we can employ magic checks.
-	if (filesize > 10 << 20) {
+	if (!image && filesize > 10 << 20) {
 		set_error(error, "oversize, not thumbnailing");
 		return NULL;
 	}
+	if (!image) {
+		GBytes *data = g_file_load_bytes(target, NULL, NULL, error);
+		if (!data)
+			return NULL;
 
-	GBytes *data = g_file_load_bytes(target, NULL, NULL, error);
-	if (!data)
-		return NULL;
-
-	gboolean color_managed = FALSE;
-	FivIoImage *image = render(target, data, &color_managed, error);
-	if (!image)
-		return NULL;
+		gboolean color_managed = FALSE;
+		if (!(image = render(target, data, &color_managed, error)))
+			return NULL;
+	}
 
 	FivIoImage *result =
 		adjust_thumbnail(image, fiv_thumbnail_sizes[size].size);
@@ -67,6 +67,9 @@ struct _FivView {
 	FivIoImage *image;                  ///< The loaded image (sequence)
 	FivIoImage *page;                   ///< Current page within image, weak
 	FivIoImage *page_scaled;            ///< Current page within image, scaled
+	FivIoImage *page_base;              ///< Low resolution page for regions
+	double page_base_scale;             ///< Scale of the low resolution page
+	bool page_regions;                  ///< Page only rendered by regions
 	FivIoImage *frame;                  ///< Current frame within page, weak
 	FivIoOrientation orientation;       ///< Current page orientation
 	bool enable_cms : 1;                ///< Smooth scaling toggle
@@ -82,6 +85,23 @@ struct _FivView {
 	double zoom_gesture_surface[2];     ///< Pinch gesture surface coordinates
 
 	FivIoImage *enhance_swap;           ///< Quick swap in/out
+	GCancellable *enhance_cancellable;  ///< Pending background enhancement
+	GCancellable *load_cancellable;     ///< Pending background load
+	bool loading;                       ///< The image is still being decoded
+	FivIoImage *mipmap_source;          ///< Frame the mipmap is for
+	GPtrArray *mipmap;                  ///< Successively halved frames
+	GCancellable *mipmap_cancellable;   ///< Pending mipmap computation
+
+	GHashTable *tiles;                  ///< Rendered tiles by position
+	GHashTable *tiles_pending;          ///< Positions being prefetched
+	FivIoImage *tiles_frame;            ///< Frame the tiles are rendered from
+	double tiles_scale;                 ///< Scale the tiles are rendered at
+	int tiles_device_scale;             ///< Device scale of the tiles
+	FivIoOrientation tiles_orientation; ///< Orientation of the tiles
+	bool tiles_filter;                  ///< Filtering of the tiles
+	guint tiles_generation;             ///< Bumped on invalidation
+	GCancellable *tiles_cancellable;    ///< Cancelled on invalidation
+
 	FivIoProfile *screen_cms_profile;   ///< Target colour profile for widget
 
 	int remaining_loops;                ///< Greater than zero if limited
@@ -91,6 +111,18 @@ struct _FivView {
 	GdkGLContext *gl_context;           ///< OpenGL context
 	bool gl_initialized;                ///< Objects have been created
 	GLuint gl_program;                  ///< Linked render program
+	GLuint gl_vao;                      ///< Vertex array object
+	GLuint gl_vertex_buffer;            ///< Vertices of the picture
+	GLuint gl_pixel_buffer;             ///< Staging buffer for uploads
+	GLuint gl_frame_buffer;             ///< Framebuffer for gl_target
+	GLuint gl_target;                   ///< Off-screen render target
+	int gl_target_width;                ///< Render target width
+	int gl_target_height;               ///< Render target height
+
+	FivIoImage *gl_page;                ///< Page the textures belong to
+	GHashTable *gl_textures;            ///< FivIoImage to ViewGLFrame
+	gsize gl_textures_size;             ///< Total size of textures in bytes
+	guint64 gl_stamp;                   ///< Draw counter, for tile eviction
 };
 
 G_DEFINE_TYPE_EXTENDED(FivView, fiv_view, GTK_TYPE_WIDGET, 0,
@@ -317,15 +349,45 @@ on_adjustment_value_changed(
 	gtk_widget_queue_draw(GTK_WIDGET(user_data));
 }
 
+// Drafts are presented with the dimensions of the full picture.
+static bool
+is_draft(const FivIoImage *page)
+{
+	return page->full_width && page->full_height;
+}
+
+// Returns how much smaller the page is than the picture it stands for.
+static void
+get_draft_scale(FivView *self, double *sx, double *sy)
+{
+	*sx = *sy = 1;
+	if (is_draft(self->page)) {
+		*sx = (double) self->page->width / self->page->full_width;
+		*sy = (double) self->page->height / self->page->full_height;
+	}
+}
+
+// Returns the unoriented dimensions of the page.
+static Dimensions
+get_page_dimensions(FivView *self)
+{
+	if (is_draft(self->page))
+		return (Dimensions) {self->page->full_width, self->page->full_height};
+	return (Dimensions) {self->page->width, self->page->height};
+}
+
 static Dimensions
 get_surface_dimensions(FivView *self)
 {
 	if (!self->image)
 		return (Dimensions) {};
 
+	Dimensions page = get_page_dimensions(self);
+	FivIoImage oriented = {.width = page.width, .height = page.height};
+
 	Dimensions dimensions = {};
 	fiv_io_orientation_dimensions(
-		self->page, self->orientation, &dimensions.width, &dimensions.height);
+		&oriented, self->orientation, &dimensions.width, &dimensions.height);
 	return dimensions;
 }
 
@@ -386,8 +448,20 @@ fiv_view_finalize(GObject *gobject)
 	FivView *self = FIV_VIEW(gobject);
 	g_clear_pointer(&self->screen_cms_profile, fiv_io_profile_free);
 	g_clear_pointer(&self->enhance_swap, fiv_io_image_unref);
+	g_clear_object(&self->enhance_cancellable);
+	g_clear_object(&self->load_cancellable);
 	g_clear_pointer(&self->image, fiv_io_image_unref);
 	g_clear_pointer(&self->page_scaled, fiv_io_image_unref);
+	g_clear_pointer(&self->page_base, fiv_io_image_unref);
+	g_clear_pointer(&self->gl_page, fiv_io_image_unref);
+	g_hash_table_destroy(self->gl_textures);
+	g_clear_pointer(&self->mipmap_source, fiv_io_image_unref);
+	g_clear_pointer(&self->mipmap, g_ptr_array_unref);
+	g_clear_object(&self->mipmap_cancellable);
+	g_hash_table_destroy(self->tiles);
+	g_hash_table_destroy(self->tiles_pending);
+	g_clear_object(&self->tiles_cancellable);
+	g_clear_pointer(&self->tiles_frame, fiv_io_image_unref);
 	g_free(self->uri);
 	g_free(self->messages);
 
@@ -548,6 +622,11 @@ fiv_view_get_preferred_width(GtkWidget *widget, gint *minimum, gint *natural)
 	}
 }
 
+// Vector pages larger than this are only rendered by visible regions.
+#define REGIONS_THRESHOLD (4096. * 4096.)
+// The size of the base layer to show while regions are being rendered.
+#define REGIONS_BASE (2048. * 2048.)
+
 static void
 prescale_page(FivView *self)
 {
@@ -559,12 +638,35 @@ prescale_page(FivView *self)
 	g_return_if_fail(!self->frame_update_connection);
 
 	// Optimization, taking into account the workaround in set_scale().
-	if (!self->page_scaled &&
+	// Drafts always need to be rendered.
+	if (!self->page_scaled && !self->page_regions &&
+		!is_draft(self->page) &&
 		(self->scale == 1 || self->scale == 0.999999999999999))
 		return;
 
 	// If it fails, the previous frame pointer may become invalid.
 	g_clear_pointer(&self->page_scaled, fiv_io_image_unref);
+	self->frame = self->page;
+	self->page_regions = false;
+
+	Dimensions dimensions = get_surface_dimensions(self);
+	double area = dimensions.width * self->scale *
+		dimensions.height * self->scale;
+	if (closure->render_region && area > REGIONS_THRESHOLD) {
+		double base_scale =
+			sqrt(REGIONS_BASE / dimensions.width / dimensions.height);
+		if (!self->page_base || self->page_base_scale != base_scale) {
+			g_clear_pointer(&self->page_base, fiv_io_image_unref);
+			self->page_base = closure->render(closure,
+				self->enable_cms ? fiv_io_cmm_get_default() : NULL,
+				self->enable_cms ? self->screen_cms_profile : NULL,
+				base_scale);
+			self->page_base_scale = base_scale;
+		}
+		self->page_regions = true;
+		return;
+	}
+
 	self->frame = self->page_scaled = closure->render(closure,
 		self->enable_cms ? fiv_io_cmm_get_default() : NULL,
 		self->enable_cms ? self->screen_cms_profile : NULL, self->scale);
@@ -776,6 +878,140 @@ gl_on_message(G_GNUC_UNUSED GLenum source, GLenum type, G_GNUC_UNUSED GLuint id,
 		g_debug("GL: %s", message);
 }
 
+// Textures are kept around for as long as the page is being shown,
+// but all frames of an animation only if they aren't too large together.
+// Large frames are split into tiles, which are uploaded as they're needed.
+#define GL_TEXTURES_BUDGET (256 << 20)
+
+typedef struct _ViewGLFrame {
+	int width, height;                  ///< Frame dimensions
+	int tile_size;                      ///< Tile size, excluding borders
+	int columns, rows;                  ///< Tile grid dimensions
+	GLuint *textures;                   ///< Tile textures, zero if missing
+	guint64 *stamps;                    ///< When a tile has last been drawn
+} ViewGLFrame;
+
+static ViewGLFrame *
+gl_frame_new(const FivIoImage *frame, int max_texture_size)
+{
+	ViewGLFrame *self = g_new0(ViewGLFrame, 1);
+	self->width = frame->width;
+	self->height = frame->height;
+
+	// Tiles overlap by a pixel on each side, for seamless linear filtering.
+	if (self->width <= max_texture_size && self->height <= max_texture_size)
+		self->tile_size = MAX(self->width, self->height);
+	else
+		self->tile_size = MIN(max_texture_size, 4096) - 2;
+
+	self->columns = (self->width + self->tile_size - 1) / self->tile_size;
+	self->rows = (self->height + self->tile_size - 1) / self->tile_size;
+	self->textures = g_new0(GLuint, self->columns * self->rows);
+	self->stamps = g_new0(guint64, self->columns * self->rows);
+	return self;
+}
+
+static void
+gl_frame_free(ViewGLFrame *self)
+{
+	g_free(self->textures);
+	g_free(self->stamps);
+	g_free(self);
+}
+
+static void
+gl_frame_tile(const ViewGLFrame *self, int column, int row,
+	cairo_rectangle_int_t *interior, cairo_rectangle_int_t *texture)
+{
+	interior->x = column * self->tile_size;
+	interior->y = row * self->tile_size;
+	interior->width = MIN(self->tile_size, self->width - interior->x);
+	interior->height = MIN(self->tile_size, self->height - interior->y);
+
+	int x1 = MAX(0, interior->x - 1);
+	int y1 = MAX(0, interior->y - 1);
+	int x2 = MIN(self->width, interior->x + interior->width + 1);
+	int y2 = MIN(self->height, interior->y + interior->height + 1);
+	if (self->columns == 1)
+		x1 = 0, x2 = self->width;
+	if (self->rows == 1)
+		y1 = 0, y2 = self->height;
+
+	*texture = (cairo_rectangle_int_t) {x1, y1, x2 - x1, y2 - y1};
+}
+
+static gsize
+gl_frame_release(ViewGLFrame *self, int index)
+{
+	if (!self->textures[index])
+		return 0;
+
+	cairo_rectangle_int_t interior = {}, texture = {};
+	gl_frame_tile(self, index % self->columns, index / self->columns,
+		&interior, &texture);
+	glDeleteTextures(1, &self->textures[index]);
+	self->textures[index] = 0;
+	return (gsize) texture.width * texture.height * 4;
+}
+
+static void
+gl_frame_release_all(ViewGLFrame *self, gsize *size)
+{
+	for (int i = 0; i < self->columns * self->rows; i++)
+		*size -= gl_frame_release(self, i);
+}
+
+static void
+gl_flush_textures(FivView *self)
+{
+	GHashTableIter iter;
+	gpointer frame = NULL;
+	g_hash_table_iter_init(&iter, self->gl_textures);
+	while (g_hash_table_iter_next(&iter, NULL, &frame))
+		gl_frame_release_all(frame, &self->gl_textures_size);
+
+	g_hash_table_remove_all(self->gl_textures);
+	self->gl_textures_size = 0;
+}
+
+static void
+gl_flush_other_frames(FivView *self)
+{
+	GHashTableIter iter;
+	gpointer key = NULL, frame = NULL;
+	g_hash_table_iter_init(&iter, self->gl_textures);
+	while (g_hash_table_iter_next(&iter, &key, &frame)) {
+		if (key == self->frame)
+			continue;
+
+		gl_frame_release_all(frame, &self->gl_textures_size);
+		g_hash_table_iter_remove(&iter);
+	}
+}
+
+// Makes room for a new tile, returning false if nothing could be evicted.
+static bool
+gl_evict(FivView *self, ViewGLFrame *current)
+{
+	if (g_hash_table_size(self->gl_textures) > 1) {
+		gl_flush_other_frames(self);
+		return true;
+	}
+
+	// Never evict tiles that are needed for the current draw.
+	int lru = -1;
+	for (int i = 0; i < current->columns * current->rows; i++) {
+		if (current->textures[i] && current->stamps[i] != self->gl_stamp &&
+			(lru < 0 || current->stamps[i] < current->stamps[lru]))
+			lru = i;
+	}
+	if (lru < 0)
+		return false;
+
+	self->gl_textures_size -= gl_frame_release(current, lru);
+	return true;
+}
+
 static void
 fiv_view_unrealize(GtkWidget *widget)
 {
@@ -783,47 +1019,217 @@ fiv_view_unrealize(GtkWidget *widget)
 	if (self->gl_context) {
 		if (self->gl_initialized) {
 			gdk_gl_context_make_current(self->gl_context);
+			gl_flush_textures(self);
+			glDeleteTextures(1, &self->gl_target);
+			glDeleteFramebuffers(1, &self->gl_frame_buffer);
+			glDeleteBuffers(1, &self->gl_pixel_buffer);
+			glDeleteBuffers(1, &self->gl_vertex_buffer);
+			glDeleteVertexArrays(1, &self->gl_vao);
 			glDeleteProgram(self->gl_program);
+			self->gl_target_width = self->gl_target_height = 0;
+			self->gl_initialized = false;
 		}
 		if (self->gl_context == gdk_gl_context_get_current())
 			gdk_gl_context_clear_current();
 
 		g_clear_object(&self->gl_context);
 	}
+	g_clear_pointer(&self->gl_page, fiv_io_image_unref);
 
 	GTK_WIDGET_CLASS(fiv_view_parent_class)->unrealize(widget);
 }
 
 static bool
-gl_draw(FivView *self, cairo_t *cr)
+gl_initialize(FivView *self)
 {
-	gdk_gl_context_make_current(self->gl_context);
+	GLuint program = gl_make_program();
+	if (!program)
+		return false;
 
-	if (!self->gl_initialized) {
-		GLuint program = gl_make_program();
-		if (!program)
-			return false;
+	glDisable(GL_SCISSOR_TEST);
+	glDisable(GL_STENCIL_TEST);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_BLEND);
+	if (epoxy_has_gl_extension("GL_ARB_debug_output")) {
+		glEnable(GL_DEBUG_OUTPUT);
+		glDebugMessageCallback(gl_on_message, NULL);
+	}
 
-		glDisable(GL_SCISSOR_TEST);
-		glDisable(GL_STENCIL_TEST);
-		glDisable(GL_DEPTH_TEST);
-		glDisable(GL_CULL_FACE);
-		glDisable(GL_BLEND);
-		if (epoxy_has_gl_extension("GL_ARB_debug_output")) {
-			glEnable(GL_DEBUG_OUTPUT);
-			glDebugMessageCallback(gl_on_message, NULL);
-		}
+	glGenVertexArrays(1, &self->gl_vao);
+	glGenBuffers(1, &self->gl_vertex_buffer);
+	glGenBuffers(1, &self->gl_pixel_buffer);
+	glGenFramebuffers(1, &self->gl_frame_buffer);
+	glGenTextures(1, &self->gl_target);
+
+	// The layout of the vertex buffer never changes, only its contents.
+	GLint position_location = glGetAttribLocation(program, "position");
+	glBindVertexArray(self->gl_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, self->gl_vertex_buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(double[4][4]), NULL, GL_DYNAMIC_DRAW);
+	glVertexAttribPointer(position_location,
+		4, GL_DOUBLE, GL_FALSE, sizeof(double[4]), 0);
+	glEnableVertexAttribArray(position_location);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	self->gl_program = program;
+	self->gl_initialized = true;
+	return true;
+}
+
+static void
+gl_upload(FivIoImage *frame, const cairo_rectangle_int_t *rect,
+	GLuint pixel_buffer)
+{
+	// Texture swizzling is OpenGL 3.3.
+	GLenum type = GL_UNSIGNED_INT_8_8_8_8_REV;
+	if (frame->format == CAIRO_FORMAT_ARGB32) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ALPHA);
+	} else if (frame->format == CAIRO_FORMAT_RGB24) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
+	} else if (frame->format == CAIRO_FORMAT_RGB30) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
+		type = GL_UNSIGNED_INT_2_10_10_10_REV;
+	} else {
+		g_warning("GL: unsupported bitmap format");
+		return;
+	}
+
+	// GL_UNPACK_ALIGNMENT is initially 4, which is fine for these.
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rect->width, rect->height,
+		0, GL_BGRA, type, NULL);
+
+	// Going through a pixel buffer lets the driver transfer data
+	// asynchronously, rather than blocking until it has made its own copy.
+	const uint8_t *data = frame->data + rect->y * frame->stride + rect->x * 4;
+	gsize row_size = (gsize) rect->width * 4;
+	gsize size = row_size * rect->height;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+	uint8_t *staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (staging) {
+		for (int y = 0; y < rect->height; y++)
+			memcpy(staging + y * row_size, data + y * frame->stride, row_size);
+
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rect->width, rect->height,
+			GL_BGRA, type, NULL);
+
+		// Orphan the storage, it will be released once the transfer is done.
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, 0, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	} else {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, frame->stride / 4);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rect->width, rect->height,
+			GL_BGRA, type, data);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+}
+
+static ViewGLFrame *
+gl_get_frame(FivView *self, int max_texture_size)
+{
+	if (self->gl_page != self->page) {
+		gl_flush_textures(self);
+		g_clear_pointer(&self->gl_page, fiv_io_image_unref);
+		self->gl_page = fiv_io_image_ref(self->page);
+	}
+
+	ViewGLFrame *frame = g_hash_table_lookup(self->gl_textures, self->frame);
+	if (frame)
+		return frame;
+
+	// Only animations are worth keeping all frames for.
+	if (!self->page->frame_next)
+		gl_flush_textures(self);
+
+	frame = gl_frame_new(self->frame, max_texture_size);
+	g_hash_table_insert(
+		self->gl_textures, fiv_io_image_ref(self->frame), frame);
+	return frame;
+}
+
+// Computes vertices of the given tile, in viewport coordinates,
+// returning whether the tile is visible at all.
+static bool
+gl_frame_tile_vertices(const ViewGLFrame *frame, const cairo_matrix_t *matrix,
+	int column, int row, cairo_rectangle_int_t *texture, double vertices[4][4])
+{
+	cairo_rectangle_int_t interior = {};
+	gl_frame_tile(frame, column, row, &interior, texture);
+
+	double fx1 = (double) interior.x / frame->width;
+	double fy1 = (double) interior.y / frame->height;
+	double fx2 = (double) (interior.x + interior.width) / frame->width;
+	double fy2 = (double) (interior.y + interior.height) / frame->height;
+	double tx1 = (double) (interior.x - texture->x) / texture->width;
+	double ty1 = (double) (interior.y - texture->y) / texture->height;
+	double tx2 = tx1 + (double) interior.width / texture->width;
+	double ty2 = ty1 + (double) interior.height / texture->height;
+
+	double corners[4][4] = {
+		{fx1, fy1, tx1, ty1},
+		{fx2, fy1, tx2, ty1},
+		{fx2, fy2, tx2, ty2},
+		{fx1, fy2, tx1, ty2},
+	};
+
+	double minx = +INFINITY, maxx = -INFINITY;
+	double miny = +INFINITY, maxy = -INFINITY;
+	for (size_t i = 0; i < G_N_ELEMENTS(corners); i++) {
+		cairo_matrix_transform_point(matrix, &corners[i][0], &corners[i][1]);
+		minx = MIN(minx, corners[i][0]);
+		maxx = MAX(maxx, corners[i][0]);
+		miny = MIN(miny, corners[i][1]);
+		maxy = MAX(maxy, corners[i][1]);
+	}
+	memcpy(vertices, corners, sizeof corners);
 
-		self->gl_program = program;
-		self->gl_initialized = true;
+	// Only tiles within the viewport need to be uploaded and drawn.
+	return maxx > -1 && minx < +1 && maxy > -1 && miny < +1;
+}
+
+// Binds a texture with the given tile's contents, uploading them if needed.
+static void
+gl_bind_tile(FivView *self, ViewGLFrame *frame, int column, int row,
+	const cairo_rectangle_int_t *texture)
+{
+	int index = row * frame->columns + column;
+	frame->stamps[index] = self->gl_stamp;
+	if (frame->textures[index]) {
+		glBindTexture(GL_TEXTURE_2D, frame->textures[index]);
+		return;
 	}
 
-	// This limit is always less than that of Cairo/pixman,
-	// and we'd have to figure out tiling.
+	gsize size = (gsize) texture->width * texture->height * 4;
+	while (self->gl_textures_size + size > GL_TEXTURES_BUDGET &&
+		gl_evict(self, frame))
+		;
+
+	// https://stackoverflow.com/questions/25157306 0..1
+	// GL_TEXTURE_RECTANGLE seems kind-of useful
+	glGenTextures(1, &frame->textures[index]);
+	glBindTexture(GL_TEXTURE_2D, frame->textures[index]);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	gl_upload(self->frame, texture, self->gl_pixel_buffer);
+	self->gl_textures_size += size;
+}
+
+static bool
+gl_draw(FivView *self, cairo_t *cr)
+{
+	gdk_gl_context_make_current(self->gl_context);
+	if (!self->gl_initialized && !gl_initialize(self))
+		return false;
+
+	// This limit is always less than that of Cairo/pixman.
 	GLint max = 0;
 	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max);
-	if (max < (GLint) self->frame->width ||
-		max < (GLint) self->frame->height) {
+	if (max < 64) {
 		g_warning("OpenGL max. texture size is too small");
 		return false;
 	}
@@ -854,143 +1260,740 @@ gl_draw(FivView *self, cairo_t *cr)
 		cliph = allocation.height;
 	}
 
+	// Map frame coordinates to display coordinates, both normalized,
+	// and those to the visible range, with the Y axis flipped.
+	cairo_matrix_t matrix = fiv_io_orientation_matrix(self->orientation, 1, 1);
+	cairo_matrix_invert(&matrix);
+
+	cairo_matrix_t viewport = {};
+	cairo_matrix_init_translate(&viewport, -1, +1);
+	cairo_matrix_scale(&viewport, 2 / (x2 - x1), -2 / (y2 - y1));
+	cairo_matrix_translate(&viewport, -x1, -y1);
+	cairo_matrix_multiply(&matrix, &matrix, &viewport);
+
+	// Tiled frames that are too large to be shown at once from textures,
+	// or that would alias for lack of mipmaps, are left to Cairo,
+	// which will draw them from halved renditions.
+	ViewGLFrame *frame = gl_get_frame(self, max);
+	if (frame->columns * frame->rows > 1) {
+		if (self->filter && self->scale < 0.5)
+			return false;
+
+		gsize visible = 0;
+		for (int row = 0; row < frame->rows; row++)
+			for (int column = 0; column < frame->columns; column++) {
+				cairo_rectangle_int_t texture = {};
+				double vertices[4][4] = {};
+				if (gl_frame_tile_vertices(
+						frame, &matrix, column, row, &texture, vertices))
+					visible += (gsize) texture.width * texture.height * 4;
+			}
+		if (visible > GL_TEXTURES_BUDGET)
+			return false;
+	}
+
 	int scale = gtk_widget_get_scale_factor(GTK_WIDGET(self));
 	clipw *= scale;
 	cliph *= scale;
 
-	enum { SRC, DEST };
-	GLuint textures[2] = {};
-	glGenTextures(2, textures);
-
-	// https://stackoverflow.com/questions/25157306 0..1
-	// GL_TEXTURE_RECTANGLE seems kind-of useful
-	glBindTexture(GL_TEXTURE_2D, textures[SRC]);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	if (self->filter) {
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	} else {
+	// GtkGLArea creates textures like this.
+	glBindFramebuffer(GL_FRAMEBUFFER, self->gl_frame_buffer);
+	if (self->gl_target_width != clipw || self->gl_target_height != cliph) {
+		glBindTexture(GL_TEXTURE_2D, self->gl_target);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, clipw, cliph, 0, GL_BGRA,
+			GL_UNSIGNED_BYTE, NULL);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+			GL_TEXTURE_2D, self->gl_target, 0);
+
+		self->gl_target_width = clipw;
+		self->gl_target_height = cliph;
+	}
+
+	glViewport(0, 0, clipw, cliph);
+	glClearColor(0., 0., 0., 1.);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		g_warning("GL framebuffer status: %u", status);
+
+	glUseProgram(self->gl_program);
+	GLint picture_location = glGetUniformLocation(
+		self->gl_program, "picture");
+	GLint checkerboard_location = glGetUniformLocation(
+		self->gl_program, "checkerboard");
+
+	glUniform1i(picture_location, 0);
+	glUniform1i(checkerboard_location, self->checkerboard);
+	glActiveTexture(GL_TEXTURE0);
+	glBindVertexArray(self->gl_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, self->gl_vertex_buffer);
+
+	self->gl_stamp++;
+	for (int row = 0; row < frame->rows; row++)
+		for (int column = 0; column < frame->columns; column++) {
+			cairo_rectangle_int_t texture = {};
+			double vertices[4][4] = {};
+			if (!gl_frame_tile_vertices(
+					frame, &matrix, column, row, &texture, vertices))
+				continue;
+
+			gl_bind_tile(self, frame, column, row, &texture);
+			if (self->filter) {
+				glTexParameteri(
+					GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				glTexParameteri(
+					GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			} else {
+				glTexParameteri(
+					GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+				glTexParameteri(
+					GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			}
+
+			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof vertices, vertices);
+			glDrawArrays(GL_TRIANGLE_FAN, 0, G_N_ELEMENTS(vertices));
+		}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// XXX: Native GdkWindows send this to the software fallback path.
+	// XXX: This only reliably alpha blends when using the software fallback,
+	// such as with a native window, because 7237f5d in GTK+ 3 is a regression.
+	// (Introduced in 3.24.39, reverted in 3.24.42.)
+	//
+	// We had to resort to rendering the checkerboard pattern in the shader.
+	// Unfortunately, it is hard to retrieve the theme colours from CSS.
+	GdkWindow *window = gtk_widget_get_window(GTK_WIDGET(self));
+	cairo_translate(cr, dx, dy);
+	gdk_cairo_draw_from_gl(
+		cr, window, self->gl_target, GL_TEXTURE, scale, 0, 0, clipw, cliph);
+	gdk_gl_context_make_current(self->gl_context);
+
+	// TODO(p): Possibly use this clue as a hint to use Cairo rendering.
+	GLenum err = 0;
+	while ((err = glGetError()) != GL_NO_ERROR) {
+		const char *string = gl_error_string(err);
+		if (string)
+			g_warning("GL: error: %s", string);
+		else
+			g_warning("GL: error: %u", err);
+	}
+
+	gdk_gl_context_clear_current();
+	return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Scaling down large frames with CAIRO_FILTER_GOOD on every draw is slow,
+// so prepare a pyramid of halved renditions, averaged in linear light,
+// and scale from the nearest level that is still at least as large.
+
+static float mipmap_to_linear[256];
+static uint8_t mipmap_from_linear[1 << 16];
+
+static void
+mipmap_initialize_tables(void)
+{
+	static gsize initialized;
+	if (!g_once_init_enter(&initialized))
+		return;
+
+	for (int i = 0; i < 256; i++) {
+		double c = i / 255.;
+		mipmap_to_linear[i] =
+			c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+	}
+	for (int i = 0; i < (1 << 16); i++) {
+		double c = i / 65535.;
+		c = c <= 0.0031308 ? c * 12.92 : 1.055 * pow(c, 1 / 2.4) - 0.055;
+		mipmap_from_linear[i] = round(c * 255);
+	}
+	g_once_init_leave(&initialized, 1);
+}
+
+static inline float
+mipmap_decode(unsigned premultiplied, unsigned alpha)
+{
+	unsigned c = (premultiplied * 255 + alpha / 2) / alpha;
+	return mipmap_to_linear[MIN(c, 255)];
+}
+
+static inline uint8_t
+mipmap_encode(float linear)
+{
+	return mipmap_from_linear[(int) (CLAMP(linear, 0, 1) * 65535 + .5f)];
+}
+
+// Cairo uses premultiplied alpha in the encoded space, which we undo,
+// so that only opaque contributions affect colour.
+static uint32_t
+mipmap_average(const uint32_t p[4])
+{
+	float r = 0, g = 0, b = 0;
+	unsigned a = 0;
+	for (int i = 0; i < 4; i++) {
+		unsigned alpha = p[i] >> 24;
+		if (!alpha)
+			continue;
+
+		float weight = alpha / 255.f;
+		r += mipmap_decode(p[i] >> 16 & 0xff, alpha) * weight;
+		g += mipmap_decode(p[i] >> 8 & 0xff, alpha) * weight;
+		b += mipmap_decode(p[i] & 0xff, alpha) * weight;
+		a += alpha;
+	}
+	if (!a)
+		return 0;
+
+	// Unpremultiplied linear colour, then premultiplied again when encoded.
+	float total = a / 255.f;
+	unsigned alpha = (a + 2) / 4;
+	unsigned rr = (mipmap_encode(r / total) * alpha + 127) / 255;
+	unsigned gg = (mipmap_encode(g / total) * alpha + 127) / 255;
+	unsigned bb = (mipmap_encode(b / total) * alpha + 127) / 255;
+	return alpha << 24 | rr << 16 | gg << 8 | bb;
+}
+
+static FivIoImage *
+mipmap_halve(const FivIoImage *source)
+{
+	uint32_t w = (source->width + 1) / 2, h = (source->height + 1) / 2;
+	FivIoImage *target = fiv_io_image_new(source->format, w, h);
+	if (!target)
+		return NULL;
+
+	bool opaque = source->format == CAIRO_FORMAT_RGB24;
+	for (uint32_t y = 0; y < h; y++) {
+		const uint32_t *row1 =
+			(const uint32_t *) (source->data + 2 * y * source->stride);
+		const uint32_t *row2 = 2 * y + 1 < source->height
+			? (const uint32_t *) ((const uint8_t *) row1 + source->stride)
+			: row1;
+		uint32_t *out = (uint32_t *) (target->data + y * target->stride);
+		for (uint32_t x = 0; x < w; x++) {
+			uint32_t x1 = 2 * x, x2 = MIN(2 * x + 1, source->width - 1);
+			uint32_t p[4] = {row1[x1], row1[x2], row2[x1], row2[x2]};
+			if (opaque) {
+				for (int i = 0; i < 4; i++)
+					p[i] |= 0xff000000;
+			}
+			out[x] = mipmap_average(p);
+		}
+	}
+	return target;
+}
+
+static void
+on_mipmap_task(GTask *task, G_GNUC_UNUSED gpointer source_object,
+	gpointer task_data, GCancellable *cancellable)
+{
+	mipmap_initialize_tables();
+
+	GPtrArray *levels =
+		g_ptr_array_new_with_free_func((GDestroyNotify) fiv_io_image_unref);
+	const FivIoImage *level = task_data;
+	while (level->width > 1 || level->height > 1) {
+		if (g_cancellable_is_cancelled(cancellable))
+			break;
+
+		FivIoImage *halved = mipmap_halve(level);
+		if (!halved)
+			break;
+
+		g_ptr_array_add(levels, halved);
+		level = halved;
+	}
+
+	if (!g_task_return_error_if_cancelled(task))
+		g_task_return_pointer(task, levels, (GDestroyNotify) g_ptr_array_unref);
+	else
+		g_ptr_array_unref(levels);
+}
+
+static void
+on_mipmap_done(GObject *source_object, GAsyncResult *res,
+	G_GNUC_UNUSED gpointer user_data)
+{
+	FivView *self = FIV_VIEW(source_object);
+	GError *error = NULL;
+	GPtrArray *levels = g_task_propagate_pointer(G_TASK(res), &error);
+	if (!levels) {
+		g_error_free(error);
+		return;
+	}
+
+	// Make sure this isn't a stale result.
+	if (g_task_get_task_data(G_TASK(res)) != self->mipmap_source) {
+		g_ptr_array_unref(levels);
+		return;
+	}
+
+	g_clear_object(&self->mipmap_cancellable);
+	g_clear_pointer(&self->mipmap, g_ptr_array_unref);
+	self->mipmap = levels;
+	gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+static void
+mipmap_invalidate(FivView *self)
+{
+	if (self->mipmap_cancellable) {
+		g_cancellable_cancel(self->mipmap_cancellable);
+		g_clear_object(&self->mipmap_cancellable);
+	}
+	g_clear_pointer(&self->mipmap, g_ptr_array_unref);
+	g_clear_pointer(&self->mipmap_source, fiv_io_image_unref);
+}
+
+// Returns the most appropriate halved rendition of the current frame,
+// or NULL if the frame itself should be used. Sets `pending` when
+// a suitable rendition is still being computed.
+static FivIoImage *
+mipmap_lookup(FivView *self, bool *pending)
+{
+	*pending = false;
+
+	// Animations and images being loaded change too often to make this
+	// worthwhile, and only 8-bit formats are supported.
+	if (self->loading || !self->filter || self->scale > 0.5 ||
+		self->page->frame_next ||
+		(self->frame->format != CAIRO_FORMAT_ARGB32 &&
+		 self->frame->format != CAIRO_FORMAT_RGB24))
+		return NULL;
+
+	if (self->mipmap_source != self->frame) {
+		mipmap_invalidate(self);
+		self->mipmap_source = fiv_io_image_ref(self->frame);
+
+		self->mipmap_cancellable = g_cancellable_new();
+		GTask *task = g_task_new(
+			self, self->mipmap_cancellable, on_mipmap_done, NULL);
+		g_task_set_name(task, __func__);
+		g_task_set_task_data(task, fiv_io_image_ref(self->frame),
+			(GDestroyNotify) fiv_io_image_unref);
+		fiv_io_work_run_task(task, FivIoWorkUpgrade, on_mipmap_task);
+		g_object_unref(task);
+	}
+	if (!self->mipmap) {
+		*pending = true;
+		return NULL;
+	}
+
+	// Level N is 2^-(N + 1) times the size of the frame.
+	FivIoImage *level = NULL;
+	double factor = 0.5;
+	for (guint i = 0; i < self->mipmap->len && self->scale <= factor; i++) {
+		level = self->mipmap->pdata[i];
+		factor /= 2;
+	}
+	return level;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// When zoomed in, compositing the whole visible area through a scaled pattern
+// on every scroll step is expensive, so keep rendered tiles of the picture,
+// as it is displayed, and only render what has newly become visible.
+// Tiles are rendered by shared worker threads, those just outside
+// of the viewport are prefetched in the background.
+//
+// Vector pages that would be too large to render whole are only ever rendered
+// by tiles, asynchronously, over a lower resolution base layer.
+
+#define TILE_SIZE 256
+#define TILES_MAX 1024
+
+typedef struct {
+	FivView *view;                      ///< Owning view, a reference
+	FivIoImage *frame;                  ///< The frame to render from
+	FivIoRenderClosure *closure;        ///< Region renderer, if vector
+	cairo_matrix_t matrix;              ///< Display to frame transformation
+	double scale;                       ///< Display scale
+	int device_scale;                   ///< Target surface device scale
+	bool filter;                        ///< Smooth scaling
+	gint64 position;                    ///< Tile position key
+	guint generation;                   ///< Cache generation at creation
+
+	cairo_surface_t *result;            ///< The rendered tile
+	FivIoImage *region;                 ///< The rendered vector tile
+} TileJob;
+
+static gint64
+tile_position(int column, int row)
+{
+	return (gint64) row << 32 | (guint32) column;
+}
+
+static gint64 *
+tile_key(gint64 position)
+{
+	gint64 *key = g_new(gint64, 1);
+	*key = position;
+	return key;
+}
+
+static void
+tile_job_free(TileJob *self)
+{
+	g_object_unref(self->view);
+	fiv_io_image_unref(self->frame);
+	if (self->result)
+		cairo_surface_destroy(self->result);
+	g_clear_pointer(&self->region, fiv_io_image_unref);
+	g_free(self);
+}
+
+static cairo_surface_t *
+tile_render(const TileJob *job)
+{
+	int column = (gint32) (job->position & 0xffffffff);
+	int row = job->position >> 32;
+
+	cairo_surface_t *tile = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+		TILE_SIZE * job->device_scale, TILE_SIZE * job->device_scale);
+	cairo_surface_set_device_scale(tile, job->device_scale, job->device_scale);
+
+	cairo_t *cr = cairo_create(tile);
+	cairo_translate(cr, -column * TILE_SIZE, -row * TILE_SIZE);
+	cairo_scale(cr, job->scale, job->scale);
+
+	cairo_surface_t *surface = fiv_io_image_to_surface_noref(job->frame);
+	cairo_set_source_surface(cr, surface, 0, 0);
+	cairo_surface_destroy(surface);
+
+	cairo_pattern_t *pattern = cairo_get_source(cr);
+	cairo_pattern_set_matrix(pattern, &job->matrix);
+	cairo_pattern_set_extend(pattern, CAIRO_EXTEND_PAD);
+	cairo_pattern_set_filter(pattern,
+		job->filter ? CAIRO_FILTER_GOOD : CAIRO_FILTER_NEAREST);
+
+	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+	cairo_paint(cr);
+	cairo_destroy(cr);
+	return tile;
+}
+
+// Here, the matrix transforms device pixels of the display
+// to those of the unoriented page, rendered at the device scale.
+static FivIoImage *
+tile_render_region(const TileJob *job)
+{
+	int column = (gint32) (job->position & 0xffffffff);
+	int row = job->position >> 32;
+	int size = TILE_SIZE * job->device_scale;
+
+	FivIoImage *tile = fiv_io_image_new(CAIRO_FORMAT_ARGB32, size, size);
+	if (!tile)
+		return NULL;
+
+	// Orientations only permute whole pixels, so rounding is exact.
+	double x1 = column * size, y1 = row * size;
+	double x2 = x1 + size, y2 = y1 + size;
+	cairo_matrix_transform_point(&job->matrix, &x1, &y1);
+	cairo_matrix_transform_point(&job->matrix, &x2, &y2);
+	cairo_rectangle_int_t region = {
+		.x = round(MIN(x1, x2)), .y = round(MIN(y1, y2)),
+		.width = round(fabs(x2 - x1)), .height = round(fabs(y2 - y1))};
+
+	FivIoImage *part = job->closure->render_region(job->closure, NULL, NULL,
+		job->scale * job->device_scale, &region);
+	if (!part) {
+		fiv_io_image_unref(tile);
+		return NULL;
+	}
+
+	cairo_surface_t *surface = fiv_io_image_to_surface_noref(tile);
+	cairo_t *cr = cairo_create(surface);
+	cairo_surface_destroy(surface);
+	cairo_translate(cr, -column * size, -row * size);
+
+	surface = fiv_io_image_to_surface_noref(part);
+	cairo_set_source_surface(cr, surface, 0, 0);
+	cairo_surface_destroy(surface);
+
+	cairo_matrix_t matrix = job->matrix;
+	matrix.x0 -= region.x;
+	matrix.y0 -= region.y;
+
+	cairo_pattern_t *pattern = cairo_get_source(cr);
+	cairo_pattern_set_matrix(pattern, &matrix);
+	cairo_pattern_set_filter(pattern, CAIRO_FILTER_NEAREST);
+
+	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+	cairo_paint(cr);
+	cairo_destroy(cr);
+
+	// Colour management happens later, and needs to know the source.
+	if (part->icc)
+		tile->icc = g_bytes_ref(part->icc);
+	fiv_io_image_unref(part);
+	return tile;
+}
+
+static void
+tiles_store(FivView *self, TileJob *job)
+{
+	// Vector renderers are invoked without colour management,
+	// because the target profile may not outlive the job.
+	if (job->region) {
+		if (self->enable_cms && self->screen_cms_profile)
+			fiv_io_cmm_finish(fiv_io_cmm_get_default(), job->region,
+				self->screen_cms_profile);
+
+		job->result = fiv_io_image_to_surface(g_steal_pointer(&job->region));
+		cairo_surface_set_device_scale(
+			job->result, job->device_scale, job->device_scale);
+	}
+
+	// Failed renders are remembered as NULL, so as to not retry them,
+	// and the base layer is drawn in their place.
+	g_hash_table_remove(self->tiles_pending, &job->position);
+	g_hash_table_replace(self->tiles,
+		tile_key(job->position), g_steal_pointer(&job->result));
+}
+
+static gboolean
+on_tile_prefetched(gpointer user_data)
+{
+	TileJob *job = user_data;
+	FivView *self = job->view;
+	if (job->generation == self->tiles_generation) {
+		tiles_store(self, job);
+		if (job->closure)
+			gtk_widget_queue_draw(GTK_WIDGET(self));
+	}
+	tile_job_free(job);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+tile_job_run(TileJob *job)
+{
+	if (job->closure)
+		job->region = tile_render_region(job);
+	else
+		job->result = tile_render(job);
+}
+
+static void
+on_tile_job(gpointer data, GCancellable *cancellable)
+{
+	// The view may have been invalidated since the job has been dequeued.
+	if (!g_cancellable_is_cancelled(cancellable))
+		tile_job_run(data);
+}
+
+// Jobs are finished in the main thread even if they were skipped,
+// which only happens after they have become stale.
+static void
+on_tile_job_finished(gpointer data)
+{
+	g_main_context_invoke(NULL, on_tile_prefetched, data);
+}
+
+static void
+on_tile_batch_job(gpointer data, guint index)
+{
+	GPtrArray *jobs = data;
+	tile_job_run(jobs->pdata[index]);
+}
+
+static void
+tiles_invalidate(FivView *self)
+{
+	self->tiles_generation++;
+	if (self->tiles_cancellable) {
+		g_cancellable_cancel(self->tiles_cancellable);
+		g_clear_object(&self->tiles_cancellable);
 	}
+	g_hash_table_remove_all(self->tiles);
+	g_hash_table_remove_all(self->tiles_pending);
+	g_clear_pointer(&self->tiles_frame, fiv_io_image_unref);
+}
 
-	// GL_UNPACK_ALIGNMENT is initially 4, which is fine for these.
-	// Texture swizzling is OpenGL 3.3.
-	if (self->frame->format == CAIRO_FORMAT_ARGB32) {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-			self->frame->width, self->frame->height,
-			0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, self->frame->data);
-	} else if (self->frame->format == CAIRO_FORMAT_RGB24) {
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-			self->frame->width, self->frame->height,
-			0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, self->frame->data);
-	} else if (self->frame->format == CAIRO_FORMAT_RGB30) {
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-			self->frame->width, self->frame->height,
-			0, GL_BGRA, GL_UNSIGNED_INT_2_10_10_10_REV, self->frame->data);
-	} else {
-		g_warning("GL: unsupported bitmap format");
-	}
+static TileJob *
+tiles_make_job(FivView *self, const cairo_matrix_t *matrix, gint64 position)
+{
+	TileJob *job = g_new0(TileJob, 1);
+	job->view = g_object_ref(self);
+	job->frame = fiv_io_image_ref(self->frame);
+	if (self->page_regions)
+		job->closure = self->page->render;
+	job->matrix = *matrix;
+	job->scale = self->tiles_scale;
+	job->device_scale = self->tiles_device_scale;
+	job->filter = self->tiles_filter;
+	job->position = position;
+	job->generation = self->tiles_generation;
+	return job;
+}
 
-	// GtkGLArea creates textures like this.
-	glBindTexture(GL_TEXTURE_2D, textures[DEST]);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, clipw, cliph, 0, GL_BGRA,
-		GL_UNSIGNED_BYTE, NULL);
+static void
+tiles_prefetch(FivView *self, const cairo_matrix_t *matrix, gint64 position,
+	bool urgent)
+{
+	if (g_hash_table_contains(self->tiles, &position) ||
+		g_hash_table_contains(self->tiles_pending, &position))
+		return;
 
-	glViewport(0, 0, clipw, cliph);
+	// Tiles that are needed right now go first.
+	TileJob *job = tiles_make_job(self, matrix, position);
+	g_hash_table_add(self->tiles_pending, tile_key(position));
+	if (!self->tiles_cancellable)
+		self->tiles_cancellable = g_cancellable_new();
+	fiv_io_work_push(urgent ? FivIoWorkInteractive : FivIoWorkPrefetch,
+		self->tiles_cancellable, on_tile_job, job, on_tile_job_finished);
+}
 
-	GLuint vao = 0;
-	glGenVertexArrays(1, &vao);
+static void
+tiles_trim(FivView *self, int c1, int r1, int c2, int r2)
+{
+	if (g_hash_table_size(self->tiles) <= TILES_MAX)
+		return;
 
-	GLuint frame_buffer = 0;
-	glGenFramebuffers(1, &frame_buffer);
-	glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer);
-	glFramebufferTexture2D(
-		GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[DEST], 0);
+	GHashTableIter iter;
+	gpointer key = NULL;
+	g_hash_table_iter_init(&iter, self->tiles);
+	while (g_hash_table_iter_next(&iter, &key, NULL)) {
+		gint64 position = *(gint64 *) key;
+		int column = (gint32) (position & 0xffffffff);
+		int row = position >> 32;
+		if (column < c1 || column > c2 || row < r1 || row > r2)
+			g_hash_table_iter_remove(&iter);
+	}
+}
 
-	glClearColor(0., 0., 0., 1.);
-	glClear(GL_COLOR_BUFFER_BIT);
+// Render all missing visible tiles in parallel, and wait for them.
+static void
+tiles_render(FivView *self, const cairo_matrix_t *matrix,
+	int c1, int r1, int c2, int r2)
+{
+	GPtrArray *jobs = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) tile_job_free);
+	for (int row = r1; row <= r2; row++)
+		for (int column = c1; column <= c2; column++) {
+			gint64 position = tile_position(column, row);
+			if (g_hash_table_contains(self->tiles, &position))
+				continue;
+
+			g_ptr_array_add(jobs, tiles_make_job(self, matrix, position));
+		}
 
-	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-	if (status != GL_FRAMEBUFFER_COMPLETE)
-		g_warning("GL framebuffer status: %u", status);
+	fiv_io_work_parallel(jobs->len, on_tile_batch_job, jobs);
 
-	glUseProgram(self->gl_program);
-	GLint position_location = glGetAttribLocation(
-		self->gl_program, "position");
-	GLint picture_location = glGetUniformLocation(
-		self->gl_program, "picture");
-	GLint checkerboard_location = glGetUniformLocation(
-		self->gl_program, "checkerboard");
+	for (guint i = 0; i < jobs->len; i++)
+		tiles_store(self, jobs->pdata[i]);
+	g_ptr_array_free(jobs, TRUE);
+}
 
-	glUniform1i(picture_location, 0);
-	glUniform1i(checkerboard_location, self->checkerboard);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, textures[SRC]);
-
-	// Note that the Y axis is flipped in the table.
-	double vertices[][4] = {
-		{-1., -1., x1, y2},
-		{+1., -1., x2, y2},
-		{+1., +1., x2, y1},
-		{-1., +1., x1, y1},
-	};
+static void
+tiles_set_base_source(FivView *self, cairo_t *cr, const cairo_matrix_t *matrix)
+{
+	double base_scale = 1, unused = 1;
+	FivIoImage *base = self->page_base ? self->page_base : self->page;
+	if (self->page_base)
+		base_scale = self->page_base_scale;
+	else
+		get_draft_scale(self, &base_scale, &unused);
 
-	cairo_matrix_t matrix = fiv_io_orientation_matrix(self->orientation, 1, 1);
-	cairo_matrix_transform_point(&matrix, &vertices[0][2], &vertices[0][3]);
-	cairo_matrix_transform_point(&matrix, &vertices[1][2], &vertices[1][3]);
-	cairo_matrix_transform_point(&matrix, &vertices[2][2], &vertices[2][3]);
-	cairo_matrix_transform_point(&matrix, &vertices[3][2], &vertices[3][3]);
-
-	GLuint vertex_buffer = 0;
-	glGenBuffers(1, &vertex_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof vertices, vertices, GL_STATIC_DRAW);
-	glBindVertexArray(vao);
-	glVertexAttribPointer(position_location,
-		G_N_ELEMENTS(vertices[0]), GL_DOUBLE, GL_FALSE, sizeof vertices[0], 0);
-	glEnableVertexAttribArray(position_location);
-	glDrawArrays(GL_TRIANGLE_FAN, 0, G_N_ELEMENTS(vertices));
-	glDisableVertexAttribArray(position_location);
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glUseProgram(0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	cairo_surface_t *surface = fiv_io_image_to_surface_noref(base);
+	cairo_set_source_surface(cr, surface, 0, 0);
+	cairo_surface_destroy(surface);
 
-	// XXX: Native GdkWindows send this to the software fallback path.
-	// XXX: This only reliably alpha blends when using the software fallback,
-	// such as with a native window, because 7237f5d in GTK+ 3 is a regression.
-	// (Introduced in 3.24.39, reverted in 3.24.42.)
-	//
-	// We had to resort to rendering the checkerboard pattern in the shader.
-	// Unfortunately, it is hard to retrieve the theme colours from CSS.
-	GdkWindow *window = gtk_widget_get_window(GTK_WIDGET(self));
-	cairo_translate(cr, dx, dy);
-	gdk_cairo_draw_from_gl(
-		cr, window, textures[DEST], GL_TEXTURE, scale, 0, 0, clipw, cliph);
-	gdk_gl_context_make_current(self->gl_context);
+	cairo_matrix_t pattern_matrix = {}, scaling = {};
+	cairo_matrix_init_scale(&pattern_matrix, 1 / self->scale, 1 / self->scale);
+	cairo_matrix_multiply(&pattern_matrix, &pattern_matrix, matrix);
+	cairo_matrix_init_scale(&scaling, base_scale, base_scale);
+	cairo_matrix_multiply(&pattern_matrix, &pattern_matrix, &scaling);
+
+	cairo_pattern_t *pattern = cairo_get_source(cr);
+	cairo_pattern_set_matrix(pattern, &pattern_matrix);
+	cairo_pattern_set_extend(pattern, CAIRO_EXTEND_PAD);
+	cairo_pattern_set_filter(pattern,
+		self->filter ? CAIRO_FILTER_GOOD : CAIRO_FILTER_NEAREST);
+}
 
-	glDeleteBuffers(1, &vertex_buffer);
-	glDeleteTextures(2, textures);
-	glDeleteVertexArrays(1, &vao);
-	glDeleteFramebuffers(1, &frame_buffer);
+// Draws the picture from cached tiles, returning false if not applicable.
+// The context must be translated so that the picture starts at the origin.
+static bool
+tiles_draw(FivView *self, cairo_t *cr, const cairo_matrix_t *matrix)
+{
+	bool regions = self->page_regions;
+	if (!regions && (self->loading || self->scale <= 1 ||
+		self->page->frame_next || is_draft(self->frame) ||
+		(self->frame->format != CAIRO_FORMAT_ARGB32 &&
+		 self->frame->format != CAIRO_FORMAT_RGB24)))
+		return false;
 
-	// TODO(p): Possibly use this clue as a hint to use Cairo rendering.
-	GLenum err = 0;
-	while ((err = glGetError()) != GL_NO_ERROR) {
-		const char *string = gl_error_string(err);
-		if (string)
-			g_warning("GL: error: %s", string);
-		else
-			g_warning("GL: error: %u", err);
+	int device_scale = gtk_widget_get_scale_factor(GTK_WIDGET(self));
+	if (self->tiles_frame != self->frame ||
+		self->tiles_scale != self->scale ||
+		self->tiles_device_scale != device_scale ||
+		self->tiles_orientation != self->orientation ||
+		self->tiles_filter != self->filter) {
+		tiles_invalidate(self);
+		self->tiles_frame = fiv_io_image_ref(self->frame);
+		self->tiles_scale = self->scale;
+		self->tiles_device_scale = device_scale;
+		self->tiles_orientation = self->orientation;
+		self->tiles_filter = self->filter;
 	}
 
-	gdk_gl_context_clear_current();
+	const cairo_matrix_t *display = matrix;
+	cairo_matrix_t region_matrix = {};
+	if (regions) {
+		double scale = self->scale * device_scale;
+		Dimensions page = get_page_dimensions(self);
+		region_matrix = fiv_io_orientation_matrix(self->orientation,
+			ceil(page.width * scale), ceil(page.height * scale));
+		matrix = &region_matrix;
+	}
+
+	double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+	cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+	if (x1 >= x2 || y1 >= y2)
+		return true;
+
+	int c1 = floor(x1 / TILE_SIZE), c2 = ceil(x2 / TILE_SIZE) - 1;
+	int r1 = floor(y1 / TILE_SIZE), r2 = ceil(y2 / TILE_SIZE) - 1;
+	if (!regions)
+		tiles_render(self, matrix, c1, r1, c2, r2);
+
+	for (int row = r1; row <= r2; row++)
+		for (int column = c1; column <= c2; column++) {
+			gint64 position = tile_position(column, row);
+			cairo_surface_t *tile = NULL;
+			if (!g_hash_table_lookup_extended(
+					self->tiles, &position, NULL, (gpointer *) &tile)) {
+				tiles_prefetch(self, matrix, position, true);
+				tiles_set_base_source(self, cr, display);
+			} else if (tile) {
+				cairo_set_source_surface(
+					cr, tile, column * TILE_SIZE, row * TILE_SIZE);
+			} else {
+				tiles_set_base_source(self, cr, display);
+			}
+			cairo_rectangle(cr,
+				column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+			cairo_fill(cr);
+		}
+
+	// Prefetch the surroundings, within the picture's bounds.
+	int dw = 0, dh = 0;
+	get_display_dimensions(self, &dw, &dh);
+	int last_column = (dw - 1) / TILE_SIZE, last_row = (dh - 1) / TILE_SIZE;
+	int pc1 = MAX(c1 - 1, 0), pc2 = MIN(c2 + 1, last_column);
+	int pr1 = MAX(r1 - 1, 0), pr2 = MIN(r2 + 1, last_row);
+	for (int row = pr1; row <= pr2; row++)
+		for (int column = pc1; column <= pc2; column++)
+			tiles_prefetch(self, matrix, tile_position(column, row), false);
+
+	tiles_trim(self, pc1, pr1, pc2, pr2);
 	return true;
 }
 
@@ -1008,7 +2011,8 @@ fiv_view_draw(GtkWidget *widget, cairo_t *cr)
 	if (!self->image ||
 		!gtk_cairo_should_draw_window(cr, gtk_widget_get_window(widget)))
 		return TRUE;
-	if (self->gl_context && gl_draw(self, cr))
+	if (self->gl_context && !self->page_regions && !self->loading &&
+		gl_draw(self, cr))
 		return TRUE;
 
 	int dw = 0, dh = 0;
@@ -1028,9 +2032,15 @@ fiv_view_draw(GtkWidget *widget, cairo_t *cr)
 	// XXX: This naming is confusing, because it isn't actually for the surface,
 	// but rather for our possibly rotated rendition of it.
 	Dimensions surface_dimensions = {};
-	cairo_matrix_t matrix = fiv_io_orientation_apply(
-		self->page_scaled ? self->page_scaled : self->page, self->orientation,
-		&surface_dimensions.width, &surface_dimensions.height);
+	cairo_matrix_t matrix = {};
+	if (self->page_scaled) {
+		matrix = fiv_io_orientation_apply(self->page_scaled, self->orientation,
+			&surface_dimensions.width, &surface_dimensions.height);
+	} else {
+		surface_dimensions = get_surface_dimensions(self);
+		matrix = fiv_io_orientation_matrix(self->orientation,
+			surface_dimensions.width, surface_dimensions.height);
+	}
 
 	cairo_translate(cr, x, y);
 	if (self->checkerboard) {
@@ -1052,19 +2062,44 @@ fiv_view_draw(GtkWidget *widget, cairo_t *cr)
 	// a pixel's worth of made-up picture data.
 	cairo_rectangle(cr, 0, 0, dw, dh);
 	cairo_clip(cr);
+	if (tiles_draw(self, cr, &matrix))
+		return TRUE;
 
 	cairo_scale(cr, self->scale, self->scale);
-	set_source_image(self, cr);
+
+	// Drafts are stretched over the picture they stand for.
+	cairo_matrix_t draft = {};
+	get_draft_scale(self, &draft.xx, &draft.yy);
+	cairo_matrix_multiply(&matrix, &matrix, &draft);
+
+	bool pending = false;
+	FivIoImage *level = mipmap_lookup(self, &pending);
+	if (level) {
+		cairo_surface_t *surface = fiv_io_image_to_surface_noref(level);
+		cairo_set_source_surface(cr, surface, 0, 0);
+		cairo_surface_destroy(surface);
+
+		// Orientation is thus applied to the smaller rendition.
+		cairo_matrix_t down = {};
+		cairo_matrix_init_scale(&down,
+			(double) level->width / self->frame->width,
+			(double) level->height / self->frame->height);
+		cairo_matrix_multiply(&matrix, &matrix, &down);
+	} else {
+		set_source_image(self, cr);
+	}
 
 	cairo_pattern_t *pattern = cairo_get_source(cr);
 	cairo_pattern_set_matrix(pattern, &matrix);
 	cairo_pattern_set_extend(pattern, CAIRO_EXTEND_PAD);
 
-	// TODO(p): Prescale it ourselves to an off-screen bitmap, gamma-correctly.
-	if (self->filter)
-		cairo_pattern_set_filter(pattern, CAIRO_FILTER_GOOD);
-	else
+	// While the mipmap is being prepared, favour responsiveness.
+	if (!self->filter)
 		cairo_pattern_set_filter(pattern, CAIRO_FILTER_NEAREST);
+	else if (pending)
+		cairo_pattern_set_filter(pattern, CAIRO_FILTER_BILINEAR);
+	else
+		cairo_pattern_set_filter(pattern, CAIRO_FILTER_GOOD);
 
 #ifdef GDK_WINDOWING_QUARTZ
 	// Not supported there. Acts a bit like repeating, but weirdly offset.
@@ -1144,6 +2179,11 @@ set_scale_with_focus(FivView *self, double scale,
 	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_SCALE]);
 	prescale_page(self);
 
+	// Previews are replaced once zoomed past their native resolution.
+	if (self->page && self->page->preview && self->scale > 1 &&
+		!self->enhance)
+		fiv_view_command(self, FIV_VIEW_COMMAND_TOGGLE_ENHANCE);
+
 	// Similar to set_orientation().
 	if (self->hadjustment && self->vadjustment) {
 		Dimensions surface_dimensions = get_surface_dimensions(self);
@@ -1325,8 +2365,29 @@ static void
 switch_page(FivView *self, FivIoImage *page)
 {
 	g_clear_pointer(&self->page_scaled, fiv_io_image_unref);
+	g_clear_pointer(&self->page_base, fiv_io_image_unref);
+	self->page_regions = false;
 	self->frame = self->page = page;
 
+	// Don't keep the previous page alive through derived data.
+	mipmap_invalidate(self);
+	tiles_invalidate(self);
+
+	GError *error = NULL;
+	if (page && !fiv_io_image_undefer(page,
+			self->enable_cms ? fiv_io_cmm_get_default() : NULL,
+			self->enable_cms ? self->screen_cms_profile : NULL, &error)) {
+		// The page stays blank, which deserves an explanation.
+		gchar *messages = self->messages
+			? g_strconcat(self->messages, "\n", error->message, NULL)
+			: g_strdup(error->message);
+		g_free(self->messages);
+		self->messages = messages;
+		g_error_free(error);
+		g_object_notify_by_pspec(
+			G_OBJECT(self), view_properties[PROP_MESSAGES]);
+	}
+
 	// XXX: When self->scale_to_fit is in effect,
 	// this uses an old value that may no longer be appropriate,
 	// resulting in wasted effort.
@@ -1924,6 +2985,12 @@ fiv_view_init(FivView *self)
 	self->filter = true;
 	self->checkerboard = false;
 	self->scale = 1.0;
+	self->gl_textures = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+		(GDestroyNotify) fiv_io_image_unref, (GDestroyNotify) gl_frame_free);
+	self->tiles = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+		g_free, (GDestroyNotify) cairo_surface_destroy);
+	self->tiles_pending =
+		g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, NULL);
 
 	GtkGesture *drag = gtk_gesture_drag_new(GTK_WIDGET(self));
 	gtk_event_controller_set_propagation_phase(
@@ -1988,11 +3055,216 @@ open_without_swapping_in(FivView *self, const char *uri)
 	return image;
 }
 
-// TODO(p): Progressive picture loading, or at least async/cancellable.
+static void
+cancel_enhancement(FivView *self)
+{
+	if (self->enhance_cancellable) {
+		g_cancellable_cancel(self->enhance_cancellable);
+		g_clear_object(&self->enhance_cancellable);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Files may also be opened in a worker thread, keeping the view responsive.
+
+typedef struct {
+	gchar *uri;                         ///< Source URI
+	GBytes *screen_profile;             ///< Target colour space or NULL
+	gboolean enhance;                   ///< Enhance the picture
+	void (*progress)(FivIoImage *, gpointer);  ///< Progress callback or NULL
+	gchar *messages;                    ///< Image load information
+} OpenData;
+
+static OpenData *
+open_data_new(FivView *self, const char *uri)
+{
+	OpenData *data = g_new0(OpenData, 1);
+	data->uri = g_strdup(uri);
+	if (self->enable_cms && self->screen_cms_profile)
+		data->screen_profile =
+			fiv_io_profile_to_bytes(self->screen_cms_profile);
+	return data;
+}
+
+static void
+open_data_free(OpenData *self)
+{
+	g_free(self->uri);
+	if (self->screen_profile)
+		g_bytes_unref(self->screen_profile);
+	g_free(self->messages);
+	g_free(self);
+}
+
+static void
+on_open_task(GTask *task, G_GNUC_UNUSED gpointer source_object,
+	gpointer task_data, GCancellable *cancellable)
+{
+	// The view's profile may change while this runs, so use a copy.
+	OpenData *data = task_data;
+	FivIoOpenContext ctx = {
+		.uri = data->uri,
+		.cmm = data->screen_profile ? fiv_io_cmm_get_default() : NULL,
+		.screen_dpi = 96,  // TODO(p): Try to retrieve it from the screen.
+		.enhance = data->enhance,
+		.cancellable = cancellable,
+		.warnings = g_ptr_array_new_with_free_func(g_free),
+		.progress = data->progress,
+		.progress_data = task,
+	};
+	if (data->screen_profile)
+		ctx.screen_profile = fiv_io_cmm_get_profile_from_bytes(
+			ctx.cmm, data->screen_profile);
+
+	GError *error = NULL;
+	FivIoImage *image = fiv_io_open(&ctx, &error);
+	if (ctx.warnings->len) {
+		g_ptr_array_add(ctx.warnings, NULL);
+		data->messages = g_strjoinv("\n", (gchar **) ctx.warnings->pdata);
+	}
+	g_ptr_array_free(ctx.warnings, TRUE);
+	g_clear_pointer(&ctx.screen_profile, fiv_io_profile_free);
+
+	if (g_task_return_error_if_cancelled(task)) {
+		g_clear_pointer(&image, fiv_io_image_unref);
+		g_clear_error(&error);
+	} else if (!image) {
+		g_task_return_error(task, error);
+	} else {
+		g_task_return_pointer(task, image, (GDestroyNotify) fiv_io_image_unref);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Files from slow sources are read in the background, and their pictures
+// are shown as they are being decoded, bypassing all caches,
+// because the worker thread keeps writing into them.
+
+typedef struct {
+	GTask *task;                        ///< The loading task
+	FivIoImage *image;                  ///< Partially decoded image
+} LoadProgress;
+
+static void
+load_progress_free(LoadProgress *self)
+{
+	g_object_unref(self->task);
+	fiv_io_image_unref(self->image);
+	g_free(self);
+}
+
+static gboolean
+on_load_progress_main(gpointer user_data)
+{
+	// The load may have been cancelled or finished in the meantime.
+	LoadProgress *progress = user_data;
+	FivView *self = g_task_get_source_object(progress->task);
+	if (g_task_get_cancellable(progress->task) != self->load_cancellable)
+		return G_SOURCE_REMOVE;
+	if (self->image == progress->image) {
+		gtk_widget_queue_draw(GTK_WIDGET(self));
+		return G_SOURCE_REMOVE;
+	}
+
+	g_clear_pointer(&self->image, fiv_io_image_unref);
+	self->frame = self->page = NULL;
+	self->loading = true;
+	switch_page(self, (self->image = fiv_io_image_ref(progress->image)));
+	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_HAS_IMAGE]);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_load_progress(FivIoImage *partial, gpointer user_data)
+{
+	GTask *task = user_data;
+	if (g_cancellable_is_cancelled(g_task_get_cancellable(task)))
+		return;
+
+	LoadProgress *progress = g_new0(LoadProgress, 1);
+	progress->task = g_object_ref(task);
+	progress->image = fiv_io_image_ref(partial);
+	g_main_context_invoke_full(g_task_get_context(task), G_PRIORITY_DEFAULT,
+		on_load_progress_main, progress, (GDestroyNotify) load_progress_free);
+}
+
+static void
+cancel_loading(FivView *self)
+{
+	if (self->load_cancellable) {
+		g_cancellable_cancel(self->load_cancellable);
+		g_clear_object(&self->load_cancellable);
+	}
+	self->loading = false;
+}
+
+static void enhance_in_background(FivView *self);
+
+static void
+on_load_done(GObject *source_object, GAsyncResult *res,
+	G_GNUC_UNUSED gpointer user_data)
+{
+	GError *error = NULL;
+	FivIoImage *image = g_task_propagate_pointer(G_TASK(res), &error);
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free(error);
+		return;
+	}
+
+	FivView *self = FIV_VIEW(source_object);
+	g_clear_object(&self->load_cancellable);
+	self->loading = false;
+
+	OpenData *data = g_task_get_task_data(G_TASK(res));
+	g_clear_pointer(&self->messages, g_free);
+	if (error) {
+		self->messages = g_strdup(error->message);
+		g_error_free(error);
+	} else {
+		self->messages = g_steal_pointer(&data->messages);
+	}
+
+	// The preview goes away even if the final decode fails.
+	g_clear_pointer(&self->image, fiv_io_image_unref);
+	self->frame = self->page = NULL;
+	switch_page(self, (self->image = image));
+
+	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_MESSAGES]);
+	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_HAS_IMAGE]);
+
+	// Enhancement may have been requested while the load was in progress.
+	if (self->enhance && self->image) {
+		enhance_in_background(self);
+	} else if (self->enhance) {
+		self->enhance = FALSE;
+		g_object_notify_by_pspec(
+			G_OBJECT(self), view_properties[PROP_ENHANCE]);
+	}
+}
+
+static void
+load_in_background(FivView *self, const char *uri)
+{
+	cancel_loading(self);
+
+	OpenData *data = open_data_new(self, uri);
+	data->progress = on_load_progress;
+
+	self->load_cancellable = g_cancellable_new();
+	GTask *task = g_task_new(
+		self, self->load_cancellable, on_load_done, NULL);
+	g_task_set_name(task, __func__);
+	g_task_set_task_data(task, data, (GDestroyNotify) open_data_free);
+	fiv_io_work_run_task(task, FivIoWorkInteractive, on_open_task);
+	g_object_unref(task);
+}
+
 gboolean
 fiv_view_set_uri(FivView *self, const char *uri)
 {
 	// This is extremely expensive, and only works sometimes.
+	cancel_enhancement(self);
+	cancel_loading(self);
 	g_clear_pointer(&self->enhance_swap, fiv_io_image_unref);
 	if (self->enhance) {
 		self->enhance = FALSE;
@@ -2000,7 +3272,18 @@ fiv_view_set_uri(FivView *self, const char *uri)
 			G_OBJECT(self), view_properties[PROP_ENHANCE]);
 	}
 
-	FivIoImage *image = open_without_swapping_in(self, uri);
+	GFile *file = g_file_new_for_uri(uri);
+	bool native = g_file_is_native(file);
+	g_object_unref(file);
+
+	FivIoImage *image = NULL;
+	if (native) {
+		image = open_without_swapping_in(self, uri);
+	} else {
+		g_clear_pointer(&self->messages, g_free);
+		load_in_background(self, uri);
+	}
+
 	g_clear_pointer(&self->image, fiv_io_image_unref);
 
 	self->frame = self->page = NULL;
@@ -2016,7 +3299,7 @@ fiv_view_set_uri(FivView *self, const char *uri)
 
 	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_MESSAGES]);
 	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_HAS_IMAGE]);
-	return image != NULL;
+	return image != NULL || self->load_cancellable;
 }
 
 static void
@@ -2047,6 +3330,8 @@ frame_step(FivView *self, int step)
 static gboolean
 reload(FivView *self)
 {
+	cancel_enhancement(self);
+	cancel_loading(self);
 	FivIoImage *image = open_without_swapping_in(self, self->uri);
 	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_MESSAGES]);
 	if (!image)
@@ -2058,10 +3343,97 @@ reload(FivView *self)
 	return TRUE;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Enhancement takes seconds, so it runs in the background,
+// while the plain decode remains on display.
+
+// Enhanced renditions may differ in resolution, such as with RAW previews.
+static void
+keep_apparent_size(FivView *self, double old_width)
+{
+	if (!self->image || !old_width || self->image->width == old_width ||
+		self->scale_to_fit)
+		return;
+
+	self->scale *= old_width / self->image->width;
+	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_SCALE]);
+	prescale_page(self);
+}
+
+static void
+on_enhance_done(GObject *source_object, GAsyncResult *res,
+	G_GNUC_UNUSED gpointer user_data)
+{
+	GError *error = NULL;
+	FivIoImage *image = g_task_propagate_pointer(G_TASK(res), &error);
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free(error);
+		return;
+	}
+
+	FivView *self = FIV_VIEW(source_object);
+	g_clear_object(&self->enhance_cancellable);
+
+	OpenData *data = g_task_get_task_data(G_TASK(res));
+	g_clear_pointer(&self->messages, g_free);
+	if (error) {
+		self->messages = g_strdup(error->message);
+		g_error_free(error);
+	} else {
+		self->messages = g_steal_pointer(&data->messages);
+	}
+	g_object_notify_by_pspec(G_OBJECT(self), view_properties[PROP_MESSAGES]);
+	if (!image) {
+		// The plain image stays on display, so don't pretend otherwise.
+		self->enhance = FALSE;
+		g_object_notify_by_pspec(
+			G_OBJECT(self), view_properties[PROP_ENHANCE]);
+		return;
+	}
+
+	double old_width = self->image ? self->image->width : 0;
+	g_clear_pointer(&self->enhance_swap, fiv_io_image_unref);
+	self->enhance_swap = self->image;
+	switch_page(self, (self->image = image));
+	keep_apparent_size(self, old_width);
+}
+
+static void
+enhance_in_background(FivView *self)
+{
+	cancel_enhancement(self);
+
+	OpenData *data = open_data_new(self, self->uri);
+	data->enhance = TRUE;
+
+	self->enhance_cancellable = g_cancellable_new();
+	GTask *task = g_task_new(
+		self, self->enhance_cancellable, on_enhance_done, NULL);
+	g_task_set_name(task, __func__);
+	g_task_set_task_data(task, data, (GDestroyNotify) open_data_free);
+	fiv_io_work_run_task(task, FivIoWorkUpgrade, on_open_task);
+	g_object_unref(task);
+}
+
 static void
 swap_enhanced_image(FivView *self)
 {
+	// Only a preview is on display, on_load_done() will take care of this.
+	if (self->load_cancellable)
+		return;
+
+	// The plain image is still on display.
+	if (self->enhance_cancellable) {
+		cancel_enhancement(self);
+		return;
+	}
+	if (self->enhance && !self->enhance_swap) {
+		enhance_in_background(self);
+		return;
+	}
+
 	FivIoImage *saved = self->image;
+	double old_width = saved ? saved->width : 0;
 	self->image = self->page = self->frame = NULL;
 
 	if (self->enhance_swap) {
@@ -2072,6 +3444,7 @@ swap_enhanced_image(FivView *self)
 	} else {
 		switch_page(self, (self->image = saved));
 	}
+	keep_apparent_size(self, old_width);
 }
 
 static void
@@ -22,7 +22,8 @@
 #define FIV_TYPE_VIEW (fiv_view_get_type())
 G_DECLARE_FINAL_TYPE(FivView, fiv_view, FIV, VIEW, GtkWidget)
 
-/// Try to open the given file, synchronously, to be displayed by the widget.
+/// Try to open the given file to be displayed by the widget. Files that are
+/// not native are loaded in the background, showing partial results.
 /// The current image is cleared on failure.
 gboolean fiv_view_set_uri(FivView *self, const char *uri);
 
@@ -828,7 +828,9 @@ enum {
 	TOOLBAR_COUNT
 };
 
-struct {
+// Each window keeps its own browsing state, while decoders, colour management
+// and thumbnail caches are shared by all windows within the process.
+typedef struct {
 	FivIoModel *model;         ///< "directory" contents
 	gchar *directory;          ///< URI of the currently browsed directory
 	GList *directory_back;     ///< History paths as URIs going backwards
@@ -854,13 +856,21 @@ struct {
 	GtkWidget *view_info_label;
 	GtkWidget *toolbar[TOOLBAR_COUNT];
 	GtkWidget *view;
+
+	GCancellable *cancellable; ///< Cancelled when the window goes away
+	guint idle_browser;        ///< Source ID of the lazy browser setup
+	gboolean drawn;            ///< Whether the first frame has been drawn
+} MainWindow;
+
+static struct {
+	gint64 startup_time;       ///< When the process was started
 } g;
 
 static void
-show_error_dialog(GError *error)
+show_error_dialog(MainWindow *w, GError *error)
 {
 	GtkWidget *dialog =
-		gtk_message_dialog_new(GTK_WINDOW(g.window), GTK_DIALOG_MODAL,
+		gtk_message_dialog_new(GTK_WINDOW(w->window), GTK_DIALOG_MODAL,
 			GTK_MESSAGE_ERROR, GTK_BUTTONS_CLOSE, "%s", error->message);
 	gtk_dialog_run(GTK_DIALOG(dialog));
 	gtk_widget_destroy(dialog);
@@ -868,40 +878,43 @@ show_error_dialog(GError *error)
 }
 
 static void
-set_window_title(const char *uri)
+set_window_title(MainWindow *w, const char *uri)
 {
 	GFile *file = g_file_new_for_uri(uri);
 	gchar *name = g_file_get_parse_name(file);
-	gtk_window_set_title(GTK_WINDOW(g.window), name);
+	gtk_window_set_title(GTK_WINDOW(w->window), name);
 	g_free(name);
 	g_object_unref(file);
 }
 
+static void ensure_browser(MainWindow *w);
+
 static void
-switch_to_browser_noselect(void)
+switch_to_browser_noselect(MainWindow *w)
 {
-	set_window_title(g.directory);
-	gtk_stack_set_visible_child(GTK_STACK(g.stack), g.browser_paned);
-	gtk_widget_grab_focus(g.browser);
+	ensure_browser(w);
+	set_window_title(w, w->directory);
+	gtk_stack_set_visible_child(GTK_STACK(w->stack), w->browser_paned);
+	gtk_widget_grab_focus(w->browser);
 }
 
 static void
-switch_to_browser(void)
+switch_to_browser(MainWindow *w)
 {
 	// XXX: This distinction is weird, it might make sense to make
 	// an end-user option for the behaviour.
-	switch_to_browser_noselect();
-	fiv_browser_select(FIV_BROWSER(g.browser), g.uri);
+	switch_to_browser_noselect(w);
+	fiv_browser_select(FIV_BROWSER(w->browser), w->uri);
 }
 
 static void
-switch_to_view(void)
+switch_to_view(MainWindow *w)
 {
-	g_return_if_fail(g.uri != NULL);
+	g_return_if_fail(w->uri != NULL);
 
-	set_window_title(g.uri);
-	gtk_stack_set_visible_child(GTK_STACK(g.stack), g.view_box);
-	gtk_widget_grab_focus(g.view);
+	set_window_title(w, w->uri);
+	gtk_stack_set_visible_child(GTK_STACK(w->stack), w->view_box);
+	gtk_widget_grab_focus(w->view);
 }
 
 static gchar *
@@ -918,181 +931,198 @@ parent_uri(GFile *child_file)
 }
 
 static void
-update_files_index(void)
+update_files_index(MainWindow *w)
 {
 	gsize files_len = 0;
-	FivIoModelEntry *const *files = fiv_io_model_get_files(g.model, &files_len);
+	FivIoModelEntry *const *files =
+		fiv_io_model_get_files(w->model, &files_len);
 
-	g.files_index = -1;
+	w->files_index = -1;
 	for (guint i = 0; i < files_len; i++)
-		if (!g_strcmp0(g.uri, files[i]->uri))
-			g.files_index = i;
+		if (!g_strcmp0(w->uri, files[i]->uri))
+			w->files_index = i;
 }
 
 static void
-change_directory_without_reload(const char *uri)
+change_directory_without_reload(MainWindow *w, const char *uri)
 {
-	if (g.directory) {
-		// Note that this function can be passed g.directory directly.
-		if (!strcmp(uri, g.directory))
+	if (w->directory) {
+		// Note that this function can be passed w->directory directly.
+		if (!strcmp(uri, w->directory))
 			return;
 
 		// We're on a new subpath.
-		g_list_free_full(g.directory_forward, g_free);
-		g.directory_forward = NULL;
+		g_list_free_full(w->directory_forward, g_free);
+		w->directory_forward = NULL;
 
-		g.directory_back = g_list_prepend(g.directory_back, g.directory);
+		w->directory_back = g_list_prepend(w->directory_back, w->directory);
 	}
 
-	g.directory = g_strdup(uri);
+	w->directory = g_strdup(uri);
 }
 
 static void
-load_directory_without_switching(const char *uri)
+load_directory_without_switching(MainWindow *w, const char *uri)
 {
 	if (uri) {
-		change_directory_without_reload(uri);
-
+		change_directory_without_reload(w, uri);
+	}
+	if (uri && w->browser_scroller) {
 		GtkAdjustment *vadjustment = gtk_scrolled_window_get_vadjustment(
-			GTK_SCROLLED_WINDOW(g.browser_scroller));
+			GTK_SCROLLED_WINDOW(w->browser_scroller));
 		gtk_adjustment_set_value(
 			vadjustment, gtk_adjustment_get_lower(vadjustment));
 	}
 
 	GError *error = NULL;
-	GFile *file = g_file_new_for_uri(g.directory);
-	if (fiv_io_model_open(g.model, file, &error)) {
+	GFile *file = g_file_new_for_uri(w->directory);
+	if (fiv_io_model_open(w->model, file, &error)) {
 		// This is handled by our ::reloaded callback.
 	} else if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED)) {
 		g_error_free(error);
 	} else {
-		show_error_dialog(error);
+		show_error_dialog(w, error);
 	}
 
 	g_object_unref(file);
 }
 
 static void
-load_directory(const char *uri)
+load_directory(MainWindow *w, const char *uri)
 {
-	load_directory_without_switching(uri);
+	load_directory_without_switching(w, uri);
 
 	if (uri) {
-		switch_to_browser_noselect();
+		switch_to_browser_noselect(w);
 
 		// TODO(p): Rather place it in history.
-		g_clear_pointer(&g.uri, g_free);
+		g_clear_pointer(&w->uri, g_free);
 	}
 }
 
 static void
-go_back(void)
+go_back(MainWindow *w)
 {
-	if (gtk_stack_get_visible_child(GTK_STACK(g.stack)) == g.view_box) {
-		switch_to_browser_noselect();
-	} else if (g.directory_back) {
-		if (g.directory)
-			g.directory_forward =
-				g_list_prepend(g.directory_forward, g.directory);
+	if (gtk_stack_get_visible_child(GTK_STACK(w->stack)) == w->view_box) {
+		switch_to_browser_noselect(w);
+	} else if (w->directory_back) {
+		if (w->directory)
+			w->directory_forward =
+				g_list_prepend(w->directory_forward, w->directory);
 
-		const gchar *uri = g.directory = g.directory_back->data;
+		const gchar *uri = w->directory = w->directory_back->data;
 
-		GList *link = g.directory_back;
-		g.directory_back = g_list_remove_link(g.directory_back, link);
+		GList *link = w->directory_back;
+		w->directory_back = g_list_remove_link(w->directory_back, link);
 		g_list_free(link);
 
-		load_directory(uri);
+		load_directory(w, uri);
 	}
 }
 
 static void
-go_forward(void)
+go_forward(MainWindow *w)
 {
-	if (g.directory_forward) {
-		if (g.directory)
-			g.directory_back =
-				g_list_prepend(g.directory_back, g.directory);
+	if (w->directory_forward) {
+		if (w->directory)
+			w->directory_back =
+				g_list_prepend(w->directory_back, w->directory);
 
-		const gchar *uri = g.directory = g.directory_forward->data;
+		const gchar *uri = w->directory = w->directory_forward->data;
 
-		GList *link = g.directory_forward;
-		g.directory_forward = g_list_remove_link(g.directory_forward, link);
+		GList *link = w->directory_forward;
+		w->directory_forward = g_list_remove_link(w->directory_forward, link);
 		g_list_free(link);
 
-		load_directory(uri);
-	} else if (g.uri) {
-		switch_to_view();
+		load_directory(w, uri);
+	} else if (w->uri) {
+		switch_to_view(w);
 	}
 }
 
 static void
-on_model_reloaded(FivIoModel *model, G_GNUC_UNUSED gpointer user_data)
+on_model_reloaded(FivIoModel *model, MainWindow *w)
 {
-	g_return_if_fail(model == g.model);
+	g_return_if_fail(model == w->model);
 
 	gsize files_len = 0;
-	(void) fiv_io_model_get_files(g.model, &files_len);
+	(void) fiv_io_model_get_files(w->model, &files_len);
 
-	update_files_index();
+	update_files_index(w);
 
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_FILE_PREVIOUS], files_len > 1);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_FILE_NEXT], files_len > 1);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_FILE_PREVIOUS], files_len > 1);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_FILE_NEXT], files_len > 1);
 }
 
 static void
-on_model_files_changed(FivIoModel *model, G_GNUC_UNUSED FivIoModelEntry *old,
-	G_GNUC_UNUSED FivIoModelEntry *new, G_GNUC_UNUSED gpointer user_data)
+on_model_files_changed(FivIoModel *model, FivIoModelEntry *old,
+	FivIoModelEntry *new, MainWindow *w)
 {
-	on_model_reloaded(model, NULL);
+	g_return_if_fail(model == w->model);
+
+	// Additions are appended, which keeps existing indexes valid.
+	// Streamed collections produce lots of these, so avoid rescanning.
+	if (!old && new) {
+		gsize files_len = 0;
+		(void) fiv_io_model_get_files(w->model, &files_len);
+		if (w->files_index < 0 && !g_strcmp0(w->uri, new->uri))
+			w->files_index = files_len - 1;
+
+		gtk_widget_set_sensitive(
+			w->toolbar[TOOLBAR_FILE_PREVIOUS], files_len > 1);
+		gtk_widget_set_sensitive(w->toolbar[TOOLBAR_FILE_NEXT], files_len > 1);
+		return;
+	}
+	on_model_reloaded(model, w);
 }
 
 static void
-on_sidebar_toggled(GtkToggleButton *button, G_GNUC_UNUSED gpointer user_data)
+on_sidebar_toggled(GtkToggleButton *button, MainWindow *w)
 {
 	gboolean active = gtk_toggle_button_get_active(button);
-	gtk_widget_set_visible(g.browser_sidebar, active);
+	gtk_widget_set_visible(w->browser_sidebar, active);
 }
 
 static void
-on_filtering_toggled(GtkToggleButton *button, G_GNUC_UNUSED gpointer user_data)
+on_filtering_toggled(GtkToggleButton *button, MainWindow *w)
 {
 	gboolean active = gtk_toggle_button_get_active(button);
-	g_object_set(g.model, "filtering", active, NULL);
+	g_object_set(w->model, "filtering", active, NULL);
 }
 
 static void
-on_filenames_toggled(GtkToggleButton *button, G_GNUC_UNUSED gpointer user_data)
+on_filenames_toggled(GtkToggleButton *button, MainWindow *w)
 {
 	gboolean active = gtk_toggle_button_get_active(button);
-	g_object_set(g.browser, "show-labels", active, NULL);
+	g_object_set(w->browser, "show-labels", active, NULL);
 }
 
 static void
-on_sort_field(G_GNUC_UNUSED GtkToggleButton *button, gpointer data)
+on_sort_field(GtkToggleButton *button, MainWindow *w)
 {
 	gboolean active = gtk_toggle_button_get_active(button);
 	if (!active)
 		return;
 
 	FivIoModelSort old = FIV_IO_MODEL_SORT_COUNT;
-	FivIoModelSort new = (FivIoModelSort) (intptr_t) data;
-	g_object_get(g.model, "sort-field", &old, NULL);
+	FivIoModelSort new = (FivIoModelSort) (intptr_t)
+		g_object_get_data(G_OBJECT(button), "sort-field");
+	g_object_get(w->model, "sort-field", &old, NULL);
 	if (old != new)
-		g_object_set(g.model, "sort-field", new, NULL);
+		g_object_set(w->model, "sort-field", new, NULL);
 }
 
 static void
-on_sort_direction(G_GNUC_UNUSED GtkToggleButton *button,
-	G_GNUC_UNUSED gpointer data)
+on_sort_direction(MainWindow *w)
 {
 	gboolean old = FALSE;
-	g_object_get(g.model, "sort-descending", &old, NULL);
-	g_object_set(g.model, "sort-descending", !old, NULL);
+	g_object_get(w->model, "sort-descending", &old, NULL);
+	g_object_set(w->model, "sort-descending", !old, NULL);
 }
 
 static void
-on_notify_view_messages(FivView *view, G_GNUC_UNUSED GParamSpec *param_spec,
-	G_GNUC_UNUSED gpointer user_data)
+on_notify_view_messages(
+	FivView *view, G_GNUC_UNUSED GParamSpec *param_spec, MainWindow *w)
 {
 	gchar *messages = NULL;
 	g_object_get(view, "messages", &messages, NULL);
@@ -1101,48 +1131,48 @@ on_notify_view_messages(FivView *view, G_GNUC_UNUSED GParamSpec *param_spec,
 		g_free(messages);
 		gchar *message = g_strdup_printf("<b>Error:</b> %s", escaped);
 		g_free(escaped);
-		gtk_label_set_markup(GTK_LABEL(g.view_info_label), message);
+		gtk_label_set_markup(GTK_LABEL(w->view_info_label), message);
 		g_free(message);
-		gtk_widget_show(g.view_info);
+		gtk_widget_show(w->view_info);
 	} else {
-		gtk_widget_hide(g.view_info);
+		gtk_widget_hide(w->view_info);
 	}
 }
 
 static void
-open_image(const char *uri)
+open_image(MainWindow *w, const char *uri)
 {
 	GFile *file = g_file_new_for_uri(uri);
-	if (fiv_view_set_uri(FIV_VIEW(g.view), uri))
+	if (fiv_view_set_uri(FIV_VIEW(w->view), uri))
 		gtk_recent_manager_add_item(gtk_recent_manager_get_default(), uri);
 
-	g_list_free_full(g.directory_forward, g_free);
-	g.directory_forward = NULL;
-	g_free(g.uri);
-	g.uri = g_strdup(uri);
+	g_list_free_full(w->directory_forward, g_free);
+	w->directory_forward = NULL;
+	g_free(w->uri);
+	w->uri = g_strdup(uri);
 
 	// So that load_directory() itself can be used for reloading.
 	gchar *parent = parent_uri(file);
 	g_object_unref(file);
-	if (!fiv_io_model_get_location(g.model) || !g.directory ||
-		strcmp(parent, g.directory))
-		load_directory_without_switching(parent);
+	if (!fiv_io_model_get_location(w->model) || !w->directory ||
+		strcmp(parent, w->directory))
+		load_directory_without_switching(w, parent);
 	else
-		update_files_index();
+		update_files_index(w);
 	g_free(parent);
 
 	// XXX: When something outside currently filtered entries is open,
-	// g.files_index is kept at -1, and browsing doesn't work.
+	// w->files_index is kept at -1, and browsing doesn't work.
 	// How to behave here?
 
-	switch_to_view();
+	switch_to_view(w);
 }
 
 static GtkWidget *
 create_open_dialog(void)
 {
 	GtkWidget *dialog = gtk_file_chooser_dialog_new("Open file",
-		GTK_WINDOW(g.window), GTK_FILE_CHOOSER_ACTION_OPEN,
+		NULL, GTK_FILE_CHOOSER_ACTION_OPEN,
 		"_Cancel", GTK_RESPONSE_CANCEL,
 		"_Open", GTK_RESPONSE_ACCEPT, NULL);
 	gtk_file_chooser_set_local_only(GTK_FILE_CHOOSER(dialog), FALSE);
@@ -1164,17 +1194,22 @@ create_open_dialog(void)
 	return dialog;
 }
 
+static void open_collection(MainWindow *w, gchar **uris);
+
 static void
-on_open(void)
+on_open(MainWindow *w)
 {
 	static GtkWidget *dialog;
 	if (!dialog)
 		dialog = create_open_dialog();
 
+	// The dialog is shared by all windows.
+	gtk_window_set_transient_for(GTK_WINDOW(dialog), GTK_WINDOW(w->window));
+
 	// Apparently, just keeping the dialog around doesn't mean
 	// that it will remember its last location.
 	(void) gtk_file_chooser_set_current_folder_uri(
-		GTK_FILE_CHOOSER(dialog), g.directory);
+		GTK_FILE_CHOOSER(dialog), w->directory);
 
 	switch (gtk_dialog_run(GTK_DIALOG(dialog))) {
 		GSList *uri_list;
@@ -1183,12 +1218,10 @@ on_open(void)
 			break;
 
 		gchar **uris = slist_to_strv(uri_list);
-		if (g_strv_length(uris) == 1) {
-			open_image(uris[0]);
-		} else {
-			fiv_collection_reload(uris);
-			load_directory(FIV_COLLECTION_SCHEME ":/");
-		}
+		if (g_strv_length(uris) == 1)
+			open_image(w, uris[0]);
+		else
+			open_collection(w, uris);
 		g_strfreev(uris);
 		break;
 	case GTK_RESPONSE_NONE:
@@ -1200,29 +1233,31 @@ on_open(void)
 }
 
 static void
-on_previous(void)
+on_previous(MainWindow *w)
 {
 	gsize files_len = 0;
-	FivIoModelEntry *const *files = fiv_io_model_get_files(g.model, &files_len);
-	if (g.files_index >= 0) {
-		int previous = (files_len + g.files_index - 1) % files_len;
-		open_image(files[previous]->uri);
+	FivIoModelEntry *const *files =
+		fiv_io_model_get_files(w->model, &files_len);
+	if (w->files_index >= 0) {
+		int previous = (files_len + w->files_index - 1) % files_len;
+		open_image(w, files[previous]->uri);
 	}
 }
 
 static void
-on_next(void)
+on_next(MainWindow *w)
 {
 	gsize files_len = 0;
-	FivIoModelEntry *const *files = fiv_io_model_get_files(g.model, &files_len);
-	if (g.files_index >= 0) {
-		int next = (g.files_index + 1) % files_len;
-		open_image(files[next]->uri);
+	FivIoModelEntry *const *files =
+		fiv_io_model_get_files(w->model, &files_len);
+	if (w->files_index >= 0) {
+		int next = (w->files_index + 1) % files_len;
+		open_image(w, files[next]->uri);
 	}
 }
 
-static gchar **
-build_spawn_argv(const char *uri)
+static GPtrArray *
+build_spawn_prologue(void)
 {
 	GPtrArray *a = g_ptr_array_new();
 #ifdef __APPLE__
@@ -1241,6 +1276,30 @@ build_spawn_argv(const char *uri)
 	if (!a->len)
 		g_ptr_array_add(a, g_strdup(PROJECT_NAME));
 
+	// Otherwise, in single instance mode, we would end up in this process.
+	g_ptr_array_add(a, g_strdup("--new-instance"));
+	return a;
+}
+
+static void
+spawn(GPtrArray *a, const char *cwd)
+{
+	g_ptr_array_add(a, NULL);
+	gchar **argv = (gchar **) g_ptr_array_free(a, FALSE);
+	GError *error = NULL;
+	if (!g_spawn_async(
+		cwd, argv, NULL, G_SPAWN_SEARCH_PATH, NULL, NULL, NULL, &error)) {
+		g_warning("%s", error->message);
+		g_error_free(error);
+	}
+	g_strfreev(argv);
+}
+
+static void
+spawn_uri(const char *uri)
+{
+	GPtrArray *a = build_spawn_prologue();
+
 	// Process-local VFS URIs need to be resolved to globally accessible URIs.
 	// It doesn't seem possible to reliably tell if a GFile is process-local,
 	// but our collection VFS is the only one to realistically cause problems.
@@ -1274,48 +1333,69 @@ build_spawn_argv(const char *uri)
 	g_object_unref(info);
 
 out:
-	g_ptr_array_add(a, NULL);
-	return (gchar **) g_ptr_array_free(a, FALSE);
+	spawn(a, NULL);
 }
 
 static void
-spawn_uri(const char *uri)
+spawn_collection(gchar **uris, const char *files_from, const char *cwd)
 {
-	gchar **argv = build_spawn_argv(uri);
-	GError *error = NULL;
-	if (!g_spawn_async(
-		NULL, argv, NULL, G_SPAWN_SEARCH_PATH, NULL, NULL, NULL, &error)) {
-		g_warning("%s", error->message);
-		g_error_free(error);
+	GPtrArray *a = build_spawn_prologue();
+	g_ptr_array_add(a, g_strdup("--collection"));
+	if (files_from) {
+		g_ptr_array_add(a, g_strdup("--files-from"));
+		g_ptr_array_add(a, g_strdup(files_from));
 	}
-	g_strfreev(argv);
+	for (gchar **p = uris; p && *p; p++)
+		g_ptr_array_add(a, g_strdup(*p));
+	spawn(a, cwd);
 }
 
+static void open_any_file(MainWindow *w, GFile *file, gboolean force_browser);
+static void open_new_window(MainWindow *w, const char *uri);
+
 static void
 on_item_activated(G_GNUC_UNUSED FivBrowser *browser, GFile *location,
-	GtkPlacesOpenFlags flags, G_GNUC_UNUSED gpointer data)
+	GtkPlacesOpenFlags flags, MainWindow *w)
 {
 	gchar *uri = g_file_get_uri(location);
 	if (flags == GTK_PLACES_OPEN_NEW_WINDOW)
-		spawn_uri(uri);
+		open_new_window(w, uri);
 	else
-		open_image(uri);
+		open_image(w, uri);
 	g_free(uri);
 }
 
-static void open_any_file(GFile *file, gboolean force_browser);
+typedef struct {
+	MainWindow *w;                      ///< Target window
+	GCancellable *cancellable;          ///< The window's cancellable
+	gboolean force_browser;             ///< open_any_file() argument
+} MountData;
 
 static void
 on_mounted_enclosing(
 	GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+	MountData *data = user_data;
+	MainWindow *w = data->w;
+	gboolean force_browser = data->force_browser;
+	gboolean gone = g_cancellable_is_cancelled(data->cancellable);
+	g_object_unref(data->cancellable);
+	g_free(data);
+
 	GFile *file = G_FILE(source_object);
 	GError *error = NULL;
-	if (g_file_mount_enclosing_volume_finish(file, res, &error))
+	gboolean ok = g_file_mount_enclosing_volume_finish(file, res, &error);
+
+	// The window may have been closed in the meantime.
+	if (gone) {
+		g_clear_error(&error);
+		return;
+	}
+	if (ok)
 		goto retry;
 
 	if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_ALREADY_MOUNTED)) {
-		show_error_dialog(error);
+		show_error_dialog(w, error);
 		return;
 	}
 
@@ -1324,26 +1404,31 @@ on_mounted_enclosing(
 	if (g_file_query_file_type(file, G_FILE_QUERY_INFO_NONE, NULL) ==
 		G_FILE_TYPE_UNKNOWN) {
 		gchar *uri = g_file_get_uri(file);
-		open_image(uri);
+		open_image(w, uri);
 		g_free(uri);
 		return;
 	}
 
 retry:
-	open_any_file(file, (gboolean) (gintptr) user_data);
+	open_any_file(w, file, force_browser);
 }
 
 static void
-open_any_file(GFile *file, gboolean force_browser)
+open_any_file(MainWindow *w, GFile *file, gboolean force_browser)
 {
 	// Various GVfs schemes may need mounting.
 	GFileType type = g_file_query_file_type(file, G_FILE_QUERY_INFO_NONE, NULL);
 	if (type == G_FILE_TYPE_UNKNOWN &&
 		G_FILE_GET_IFACE(file)->mount_enclosing_volume) {
+		MountData *data = g_new0(MountData, 1);
+		data->w = w;
+		data->cancellable = g_object_ref(w->cancellable);
+		data->force_browser = force_browser;
+
 		// TODO(p): At least provide some kind of indication.
-		GMountOperation *op = gtk_mount_operation_new(GTK_WINDOW(g.window));
-		g_file_mount_enclosing_volume(file, G_MOUNT_MOUNT_NONE, op, NULL,
-			on_mounted_enclosing, (gpointer) (gintptr) force_browser);
+		GMountOperation *op = gtk_mount_operation_new(GTK_WINDOW(w->window));
+		g_file_mount_enclosing_volume(file, G_MOUNT_MOUNT_NONE, op,
+			w->cancellable, on_mounted_enclosing, data);
 		g_object_unref(op);
 		return;
 	}
@@ -1351,32 +1436,67 @@ open_any_file(GFile *file, gboolean force_browser)
 	gchar *uri = g_file_get_uri(file);
 	if (type == G_FILE_TYPE_UNKNOWN) {
 		errno = ENOENT;
-		show_error_dialog(g_error_new(G_FILE_ERROR,
+		show_error_dialog(w, g_error_new(G_FILE_ERROR,
 			g_file_error_from_errno(errno), "%s: %s", uri, g_strerror(errno)));
 	} else if (type == G_FILE_TYPE_DIRECTORY) {
-		load_directory(uri);
+		load_directory(w, uri);
 	} else if (force_browser) {
 		// GNOME, e.g., invokes this as a hint to focus the particular file.
 		gchar *parent = parent_uri(file);
-		load_directory(parent);
+		load_directory(w, parent);
 		g_free(parent);
 
-		fiv_browser_select(FIV_BROWSER(g.browser), uri);
+		fiv_browser_select(FIV_BROWSER(w->browser), uri);
 	} else {
-		open_image(uri);
+		open_image(w, uri);
 	}
 	g_free(uri);
 }
 
+static MainWindow *
+main_window_of(GtkWindow *window)
+{
+	return g_object_get_data(G_OBJECT(window), "main-window");
+}
+
+// There is only one collection per process, shared by all of its windows.
+static gboolean
+is_collection_browsed_elsewhere(MainWindow *w)
+{
+	GtkApplication *app = GTK_APPLICATION(g_application_get_default());
+	GList *windows = gtk_application_get_windows(app);
+	for (GList *link = windows; link; link = link->next) {
+		MainWindow *other = main_window_of(link->data);
+		if (other && other != w && other->directory &&
+			fiv_collection_uri_matches(other->directory))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void
+open_collection(MainWindow *w, gchar **uris)
+{
+	// Rather than pulling the collection from under another window,
+	// open the new one in a separate process.
+	if (is_collection_browsed_elsewhere(w)) {
+		spawn_collection(uris, NULL, NULL);
+		return;
+	}
+
+	fiv_collection_reload(uris);
+	load_directory(w, FIV_COLLECTION_SCHEME ":/");
+}
+
 static void
 on_open_location(G_GNUC_UNUSED GtkPlacesSidebar *sidebar, GFile *location,
-	GtkPlacesOpenFlags flags, G_GNUC_UNUSED gpointer user_data)
+	GtkPlacesOpenFlags flags, MainWindow *w)
 {
 	gchar *uri = g_file_get_uri(location);
 	if (flags & GTK_PLACES_OPEN_NEW_WINDOW)
-		spawn_uri(uri);
+		open_new_window(w, uri);
 	else
-		open_any_file(location, FALSE);
+		open_any_file(w, location, FALSE);
 	g_free(uri);
 }
 
@@ -1384,7 +1504,7 @@ static void
 on_view_drag_data_received(G_GNUC_UNUSED GtkWidget *widget,
 	GdkDragContext *context, G_GNUC_UNUSED gint x, G_GNUC_UNUSED gint y,
 	GtkSelectionData *data, G_GNUC_UNUSED guint info, guint time,
-	G_GNUC_UNUSED gpointer user_data)
+	MainWindow *w)
 {
 	gchar **uris = gtk_selection_data_get_uris(data);
 	if (!uris) {
@@ -1392,111 +1512,121 @@ on_view_drag_data_received(G_GNUC_UNUSED GtkWidget *widget,
 		return;
 	}
 
-	GFile *file = NULL;
 	if (g_strv_length(uris) == 1) {
-		file = g_file_new_for_uri(uris[0]);
+		GFile *file = g_file_new_for_uri(uris[0]);
+		open_any_file(w, file, FALSE);
+		g_object_unref(file);
 	} else {
-		fiv_collection_reload(uris);
-		file = g_file_new_for_uri(FIV_COLLECTION_SCHEME ":/");
+		open_collection(w, uris);
 	}
-	open_any_file(file, FALSE);
-	g_object_unref(file);
 	gtk_drag_finish(context, TRUE, FALSE, time);
 	g_strfreev(uris);
 }
 
 static void
 on_notify_sidebar_visible(
-	GObject *object, GParamSpec *param_spec, G_GNUC_UNUSED gpointer user_data)
+	GObject *object, GParamSpec *param_spec, MainWindow *w)
 {
 	gboolean b = FALSE;
 	g_object_get(object, g_param_spec_get_name(param_spec), &b, NULL);
 	gtk_toggle_button_set_active(
-		GTK_TOGGLE_BUTTON(g.browsebar[BROWSEBAR_SIDEBAR]), b);
+		GTK_TOGGLE_BUTTON(w->browsebar[BROWSEBAR_SIDEBAR]), b);
 }
 
 static void
-on_dir_previous(void)
+on_dir_previous(MainWindow *w)
 {
-	GFile *directory = fiv_io_model_get_previous_directory(g.model);
+	GFile *directory = fiv_io_model_get_previous_directory(w->model);
 	if (directory) {
 		gchar *uri = g_file_get_uri(directory);
 		g_object_unref(directory);
-		load_directory(uri);
+		load_directory(w, uri);
 		g_free(uri);
 	}
 }
 
 static void
-on_dir_next(void)
+on_dir_next(MainWindow *w)
 {
-	GFile *directory = fiv_io_model_get_next_directory(g.model);
+	GFile *directory = fiv_io_model_get_next_directory(w->model);
 	if (directory) {
 		gchar *uri = g_file_get_uri(directory);
 		g_object_unref(directory);
-		load_directory(uri);
+		load_directory(w, uri);
 		g_free(uri);
 	}
 }
 
 static void
-on_toolbar_zoom(G_GNUC_UNUSED GtkButton *button, gpointer user_data)
+browser_zoom(MainWindow *w, int delta)
 {
 	FivThumbnailSize size = FIV_THUMBNAIL_SIZE_COUNT;
-	g_object_get(g.browser, "thumbnail-size", &size, NULL);
+	g_object_get(w->browser, "thumbnail-size", &size, NULL);
 
-	size += (gintptr) user_data;
+	size += delta;
 	g_return_if_fail(size >= FIV_THUMBNAIL_SIZE_MIN &&
 		size <= FIV_THUMBNAIL_SIZE_MAX);
 
-	g_object_set(g.browser, "thumbnail-size", size, NULL);
+	g_object_set(w->browser, "thumbnail-size", size, NULL);
+}
+
+static void
+on_toolbar_zoom_in(MainWindow *w)
+{
+	browser_zoom(w, +1);
+}
+
+static void
+on_toolbar_zoom_out(MainWindow *w)
+{
+	browser_zoom(w, -1);
 }
 
 static void
 on_notify_thumbnail_size(
-	GObject *object, GParamSpec *param_spec, G_GNUC_UNUSED gpointer user_data)
+	GObject *object, GParamSpec *param_spec, MainWindow *w)
 {
 	FivThumbnailSize size = FIV_THUMBNAIL_SIZE_COUNT;
 	g_object_get(object, g_param_spec_get_name(param_spec), &size, NULL);
 	gtk_widget_set_sensitive(
-		g.browsebar[BROWSEBAR_PLUS], size < FIV_THUMBNAIL_SIZE_MAX);
+		w->browsebar[BROWSEBAR_PLUS], size < FIV_THUMBNAIL_SIZE_MAX);
 	gtk_widget_set_sensitive(
-		g.browsebar[BROWSEBAR_MINUS], size > FIV_THUMBNAIL_SIZE_MIN);
+		w->browsebar[BROWSEBAR_MINUS], size > FIV_THUMBNAIL_SIZE_MIN);
 }
 
 static void
 on_notify_show_labels(
-	GObject *object, GParamSpec *param_spec, G_GNUC_UNUSED gpointer user_data)
+	GObject *object, GParamSpec *param_spec, MainWindow *w)
 {
 	gboolean show_labels = 0;
 	g_object_get(object, g_param_spec_get_name(param_spec), &show_labels, NULL);
 	gtk_toggle_button_set_active(
-		GTK_TOGGLE_BUTTON(g.browsebar[BROWSEBAR_FILENAMES]), show_labels);
+		GTK_TOGGLE_BUTTON(w->browsebar[BROWSEBAR_FILENAMES]), show_labels);
 }
 
 static void
 on_notify_filtering(
-	GObject *object, GParamSpec *param_spec, G_GNUC_UNUSED gpointer user_data)
+	GObject *object, GParamSpec *param_spec, MainWindow *w)
 {
 	gboolean b = FALSE;
 	g_object_get(object, g_param_spec_get_name(param_spec), &b, NULL);
 	gtk_toggle_button_set_active(
-		GTK_TOGGLE_BUTTON(g.browsebar[BROWSEBAR_FILTER]), b);
+		GTK_TOGGLE_BUTTON(w->browsebar[BROWSEBAR_FILTER]), b);
 }
 
 static void
 on_notify_sort_field(
-	GObject *object, GParamSpec *param_spec, G_GNUC_UNUSED gpointer user_data)
+	GObject *object, GParamSpec *param_spec, MainWindow *w)
 {
 	gint field = -1;
 	g_object_get(object, g_param_spec_get_name(param_spec), &field, NULL);
 	gtk_toggle_button_set_active(
-		GTK_TOGGLE_BUTTON(g.browsebar[BROWSEBAR_SORT_NAME + field]), TRUE);
+		GTK_TOGGLE_BUTTON(w->browsebar[BROWSEBAR_SORT_NAME + field]), TRUE);
 }
 
 static void
 on_notify_sort_descending(
-	GObject *object, GParamSpec *param_spec, G_GNUC_UNUSED gpointer user_data)
+	GObject *object, GParamSpec *param_spec, MainWindow *w)
 {
 	gboolean b = FALSE;
 	g_object_get(object, g_param_spec_get_name(param_spec), &b, NULL);
@@ -1508,52 +1638,60 @@ on_notify_sort_descending(
 		? "view-sort-ascending-symbolic"
 		: "view-sort-descending-symbolic";
 
-	GtkButton *button = GTK_BUTTON(g.browsebar[BROWSEBAR_SORT_DIR]);
+	GtkButton *button = GTK_BUTTON(w->browsebar[BROWSEBAR_SORT_DIR]);
 	GtkImage *image = GTK_IMAGE(gtk_button_get_image(button));
 	gtk_widget_set_tooltip_text(GTK_WIDGET(button), title);
 	gtk_image_set_from_icon_name(image, name, GTK_ICON_SIZE_BUTTON);
 }
 
 static void
-toggle_fullscreen(void)
+toggle_fullscreen(MainWindow *w)
 {
-	if (gdk_window_get_state(gtk_widget_get_window(g.window)) &
+	if (gdk_window_get_state(gtk_widget_get_window(w->window)) &
 		GDK_WINDOW_STATE_FULLSCREEN)
-		gtk_window_unfullscreen(GTK_WINDOW(g.window));
+		gtk_window_unfullscreen(GTK_WINDOW(w->window));
 	else
-		gtk_window_fullscreen(GTK_WINDOW(g.window));
+		gtk_window_fullscreen(GTK_WINDOW(w->window));
 }
 
 static void
-on_window_state_event(G_GNUC_UNUSED GtkWidget *widget,
-	GdkEventWindowState *event, G_GNUC_UNUSED gpointer user_data)
+update_fullscreen_button(GtkWidget *button, GdkWindowState state)
 {
-	if (!(event->changed_mask & GDK_WINDOW_STATE_FULLSCREEN))
-		return;
-
-	const char *name = (event->new_window_state & GDK_WINDOW_STATE_FULLSCREEN)
+	const char *name = (state & GDK_WINDOW_STATE_FULLSCREEN)
 		? "view-restore-symbolic"
 		: "view-fullscreen-symbolic";
 
 	gtk_image_set_from_icon_name(
-		GTK_IMAGE(gtk_button_get_image(
-			GTK_BUTTON(g.toolbar[TOOLBAR_FULLSCREEN]))),
-		name, GTK_ICON_SIZE_BUTTON);
-	gtk_image_set_from_icon_name(
-		GTK_IMAGE(gtk_button_get_image(
-			GTK_BUTTON(g.browsebar[BROWSEBAR_FULLSCREEN]))),
+		GTK_IMAGE(gtk_button_get_image(GTK_BUTTON(button))),
 		name, GTK_ICON_SIZE_BUTTON);
 }
 
 static void
-show_help_contents(void)
+on_window_state_event(
+	G_GNUC_UNUSED GtkWidget *widget, GdkEventWindowState *event, MainWindow *w)
+{
+	if (!(event->changed_mask & GDK_WINDOW_STATE_FULLSCREEN))
+		return;
+
+	update_fullscreen_button(
+		w->toolbar[TOOLBAR_FULLSCREEN], event->new_window_state);
+
+	// The browser may not have been constructed yet.
+	if (w->browser_paned) {
+		update_fullscreen_button(
+			w->browsebar[BROWSEBAR_FULLSCREEN], event->new_window_state);
+	}
+}
+
+static void
+show_help_contents(MainWindow *w)
 {
 #ifdef G_OS_WIN32
 	gchar *prefix = g_win32_get_package_installation_directory_of_module(NULL);
 #elif defined __APPLE__
 	gchar *prefix = get_application_bundle_path();
 	if (!prefix) {
-		show_error_dialog(g_error_new(
+		show_error_dialog(w, g_error_new(
 			G_FILE_ERROR, G_FILE_ERROR_FAILED, "Cannot locate bundle"));
 		return;
 	}
@@ -1572,7 +1710,7 @@ show_help_contents(void)
 
 	// For some reason, it doesn't work with a parent window.
 	if (!uri || !gtk_show_uri_on_window(NULL, uri, GDK_CURRENT_TIME, &error))
-		show_error_dialog(error);
+		show_error_dialog(w, error);
 	g_free(uri);
 }
 
@@ -1584,7 +1722,7 @@ on_help_destroyed(GtkWidget *window, GtkWidget **storage)
 }
 
 static void
-show_help_shortcuts(void)
+show_help_shortcuts(MainWindow *w)
 {
 	static GtkWidget *window;
 	if (!window) {
@@ -1594,7 +1732,7 @@ show_help_shortcuts(void)
 	}
 
 	g_object_set(window, "section-name",
-		gtk_stack_get_visible_child(GTK_STACK(g.stack)) == g.view_box
+		gtk_stack_get_visible_child(GTK_STACK(w->stack)) == w->view_box
 			? "viewer"
 			: "browser",
 		NULL);
@@ -1612,21 +1750,22 @@ toggle_sunlight(void)
 }
 
 static gboolean
-on_key_press(G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event,
-	G_GNUC_UNUSED gpointer data)
+on_key_press(
+	G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event, MainWindow *w)
 {
 	switch (event->state & gtk_accelerator_get_default_mod_mask()) {
 	case GDK_CONTROL_MASK:
 		switch (event->keyval) {
 		case GDK_KEY_h:
 			// XXX: Command-H is already occupied on macOS.
-			gtk_button_clicked(GTK_BUTTON(g.browsebar[BROWSEBAR_FILTER]));
+			ensure_browser(w);
+			gtk_button_clicked(GTK_BUTTON(w->browsebar[BROWSEBAR_FILTER]));
 			return TRUE;
 		}
 	}
 
 	gchar *accelerator = NULL;
-	g_object_get(gtk_widget_get_settings(g.window), "gtk-menu-bar-accel",
+	g_object_get(gtk_widget_get_settings(w->window), "gtk-menu-bar-accel",
 		&accelerator, NULL);
 	if (!accelerator)
 		return FALSE;
@@ -1645,11 +1784,11 @@ on_key_press(G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event,
 	guint mask = gtk_accelerator_get_default_mod_mask();
 	if (key && event->keyval == key && (event->state & mask) == mods &&
 		!shell_shows_menubar) {
-		gtk_widget_show(g.menu);
+		gtk_widget_show(w->menu);
 
 		// _gtk_menu_shell_set_keyboard_mode() is private.
 		// We've added a viewable menu bar, so calling this again will work.
-		return gtk_window_activate_key(GTK_WINDOW(g.window), event);
+		return gtk_window_activate_key(GTK_WINDOW(w->window), event);
 	}
 	return FALSE;
 }
@@ -1666,32 +1805,32 @@ on_key_press(G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event,
 // g_signal_connect{,after}(), or overriding the handler and either tactically
 // chaining up or using gtk_window_propagate_key_event().
 static gboolean
-on_key_press_view(G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event,
-	G_GNUC_UNUSED gpointer data)
+on_key_press_view(
+	G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event, MainWindow *w)
 {
 	switch (event->state & gtk_accelerator_get_default_mod_mask()) {
 	case 0:
 		switch (event->keyval) {
 		case GDK_KEY_F7:
-			gtk_widget_set_visible(g.view_toolbar,
-				!gtk_widget_is_visible(g.view_toolbar));
+			gtk_widget_set_visible(w->view_toolbar,
+				!gtk_widget_is_visible(w->view_toolbar));
 			return TRUE;
 
 		case GDK_KEY_Left:
 		case GDK_KEY_Up:
 		case GDK_KEY_Page_Up:
-			on_previous();
+			on_previous(w);
 			return TRUE;
 
 		case GDK_KEY_Right:
 		case GDK_KEY_Down:
 		case GDK_KEY_Page_Down:
-			on_next();
+			on_next(w);
 			return TRUE;
 
 		case GDK_KEY_Escape:
 		case GDK_KEY_Return:
-			switch_to_browser();
+			switch_to_browser(w);
 			return TRUE;
 		}
 	}
@@ -1699,34 +1838,34 @@ on_key_press_view(G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event,
 }
 
 static gboolean
-on_key_press_browser_paned(G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event,
-	G_GNUC_UNUSED gpointer data)
+on_key_press_browser_paned(
+	G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event, MainWindow *w)
 {
 	// TODO(p): Consider replicating more GtkFileChooserWidget bindings.
 	switch (event->state & gtk_accelerator_get_default_mod_mask()) {
 	case GDK_CONTROL_MASK:
 		switch (event->keyval) {
 		case GDK_KEY_r:
-			load_directory(NULL);
+			load_directory(w, NULL);
 			return TRUE;
 		case GDK_KEY_t:
-			gtk_button_clicked(GTK_BUTTON(g.browsebar[BROWSEBAR_FILENAMES]));
+			gtk_button_clicked(GTK_BUTTON(w->browsebar[BROWSEBAR_FILENAMES]));
 			return TRUE;
 		}
 		break;
 	case GDK_MOD1_MASK:
 		switch (event->keyval) {
 		case GDK_KEY_Up: {
-			GFile *directory = g_file_new_for_uri(g.directory);
+			GFile *directory = g_file_new_for_uri(w->directory);
 			gchar *parent = parent_uri(directory);
 			g_object_unref(directory);
-			load_directory(parent);
+			load_directory(w, parent);
 			g_free(parent);
 			return TRUE;
 		}
 		case GDK_KEY_Home: {
 			gchar *uri = g_filename_to_uri(g_get_home_dir(), NULL, NULL);
-			load_directory(uri);
+			load_directory(w, uri);
 			g_free(uri);
 			return TRUE;
 		}
@@ -1735,33 +1874,33 @@ on_key_press_browser_paned(G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event,
 	case 0:
 		switch (event->keyval) {
 		case GDK_KEY_F7:
-			gtk_widget_set_visible(g.browser_toolbar,
-				!gtk_widget_is_visible(g.browser_toolbar));
+			gtk_widget_set_visible(w->browser_toolbar,
+				!gtk_widget_is_visible(w->browser_toolbar));
 			return TRUE;
 		case GDK_KEY_F9:
-			gtk_widget_set_visible(g.browser_sidebar,
-				!gtk_widget_is_visible(g.browser_sidebar));
+			gtk_widget_set_visible(w->browser_sidebar,
+				!gtk_widget_is_visible(w->browser_sidebar));
 			return TRUE;
 
 		case GDK_KEY_bracketleft:
-			on_dir_previous();
+			on_dir_previous(w);
 			return TRUE;
 		case GDK_KEY_bracketright:
-			on_dir_next();
+			on_dir_next(w);
 			return TRUE;
 
 		case GDK_KEY_Escape:
-			fiv_browser_select(FIV_BROWSER(g.browser), NULL);
+			fiv_browser_select(FIV_BROWSER(w->browser), NULL);
 			return TRUE;
 		case GDK_KEY_h:
-			gtk_button_clicked(GTK_BUTTON(g.browsebar[BROWSEBAR_FILTER]));
+			gtk_button_clicked(GTK_BUTTON(w->browsebar[BROWSEBAR_FILTER]));
 			return TRUE;
 		case GDK_KEY_F5:
 		case GDK_KEY_r:
-			load_directory(NULL);
+			load_directory(w, NULL);
 			return TRUE;
 		case GDK_KEY_t:
-			gtk_button_clicked(GTK_BUTTON(g.browsebar[BROWSEBAR_FILENAMES]));
+			gtk_button_clicked(GTK_BUTTON(w->browsebar[BROWSEBAR_FILENAMES]));
 			return TRUE;
 		}
 	}
@@ -1769,18 +1908,19 @@ on_key_press_browser_paned(G_GNUC_UNUSED GtkWidget *widget, GdkEventKey *event,
 }
 
 static gboolean
-on_button_press_view(G_GNUC_UNUSED GtkWidget *widget, GdkEventButton *event)
+on_button_press_view(
+	G_GNUC_UNUSED GtkWidget *widget, GdkEventButton *event, MainWindow *w)
 {
 	if ((event->state & gtk_accelerator_get_default_mod_mask()))
 		return FALSE;
 	switch (event->button) {
 	case 4:  // back (GdkWin32, GdkQuartz)
 	case 8:  // back
-		go_back();
+		go_back(w);
 		return TRUE;
 	case GDK_BUTTON_PRIMARY:
 		if (event->type == GDK_2BUTTON_PRESS) {
-			toggle_fullscreen();
+			toggle_fullscreen(w);
 			return TRUE;
 		}
 		return FALSE;
@@ -1791,18 +1931,18 @@ on_button_press_view(G_GNUC_UNUSED GtkWidget *widget, GdkEventButton *event)
 
 static gboolean
 on_button_press_browser_paned(
-	G_GNUC_UNUSED GtkWidget *widget, GdkEventButton *event)
+	G_GNUC_UNUSED GtkWidget *widget, GdkEventButton *event, MainWindow *w)
 {
 	if ((event->state & gtk_accelerator_get_default_mod_mask()))
 		return FALSE;
 	switch (event->button) {
 	case 4:  // back (GdkWin32, GdkQuartz)
 	case 8:  // back
-		go_back();
+		go_back(w);
 		return TRUE;
 	case 5:  // forward (GdkWin32, GdkQuartz)
 	case 9:  // forward
-		go_forward();
+		go_forward(w);
 		return TRUE;
 	default:
 		return FALSE;
@@ -1854,15 +1994,15 @@ make_toolbar_radio(const char *label, const char *tooltip)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 static void
-browsebar_connect(int index, GCallback callback)
+browsebar_connect(MainWindow *w, int index, GCallback callback)
 {
-	g_signal_connect_swapped(g.browsebar[index], "clicked", callback, NULL);
+	g_signal_connect_swapped(w->browsebar[index], "clicked", callback, w);
 }
 
 static GtkWidget *
-make_browser_toolbar(void)
+make_browser_toolbar(MainWindow *w)
 {
-#define XX(id, constructor) g.browsebar[BROWSEBAR_ ## id] = constructor;
+#define XX(id, constructor) w->browsebar[BROWSEBAR_ ## id] = constructor;
 	BROWSEBAR(XX)
 #undef XX
 
@@ -1874,38 +2014,40 @@ make_browser_toolbar(void)
 
 	// Exploring different versions of awkward layouts.
 	for (int i = 0; i <= BROWSEBAR_S2; i++)
-		gtk_box_pack_start(box, g.browsebar[i], FALSE, FALSE, 0);
+		gtk_box_pack_start(box, w->browsebar[i], FALSE, FALSE, 0);
 	for (int i = BROWSEBAR_COUNT; --i >= BROWSEBAR_S5; )
-		gtk_box_pack_end(box, g.browsebar[i], FALSE, FALSE, 0);
+		gtk_box_pack_end(box, w->browsebar[i], FALSE, FALSE, 0);
 
 	GtkWidget *center = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
 	for (int i = BROWSEBAR_S2; ++i < BROWSEBAR_S5; )
-		gtk_box_pack_start(GTK_BOX(center), g.browsebar[i], FALSE, FALSE, 0);
+		gtk_box_pack_start(GTK_BOX(center), w->browsebar[i], FALSE, FALSE, 0);
 	gtk_box_set_center_widget(box, center);
 
-	g_signal_connect(g.browsebar[BROWSEBAR_SIDEBAR], "toggled",
-		G_CALLBACK(on_sidebar_toggled), NULL);
+	g_signal_connect(w->browsebar[BROWSEBAR_SIDEBAR], "toggled",
+		G_CALLBACK(on_sidebar_toggled), w);
 
-	browsebar_connect(BROWSEBAR_DIR_PREVIOUS, G_CALLBACK(on_dir_previous));
-	browsebar_connect(BROWSEBAR_DIR_NEXT,     G_CALLBACK(on_dir_next));
-	browsebar_connect(BROWSEBAR_SORT_DIR,     G_CALLBACK(on_sort_direction));
-	browsebar_connect(BROWSEBAR_FULLSCREEN,   G_CALLBACK(toggle_fullscreen));
+	browsebar_connect(w, BROWSEBAR_DIR_PREVIOUS, G_CALLBACK(on_dir_previous));
+	browsebar_connect(w, BROWSEBAR_DIR_NEXT,     G_CALLBACK(on_dir_next));
+	browsebar_connect(w, BROWSEBAR_SORT_DIR,     G_CALLBACK(on_sort_direction));
+	browsebar_connect(w, BROWSEBAR_FULLSCREEN,   G_CALLBACK(toggle_fullscreen));
 
-	g_signal_connect(g.browsebar[BROWSEBAR_PLUS], "clicked",
-		G_CALLBACK(on_toolbar_zoom), (gpointer) +1);
-	g_signal_connect(g.browsebar[BROWSEBAR_MINUS], "clicked",
-		G_CALLBACK(on_toolbar_zoom), (gpointer) -1);
+	g_signal_connect_swapped(w->browsebar[BROWSEBAR_PLUS], "clicked",
+		G_CALLBACK(on_toolbar_zoom_in), w);
+	g_signal_connect_swapped(w->browsebar[BROWSEBAR_MINUS], "clicked",
+		G_CALLBACK(on_toolbar_zoom_out), w);
 
-	g_signal_connect(g.browsebar[BROWSEBAR_FILTER], "toggled",
-		G_CALLBACK(on_filtering_toggled), NULL);
-	g_signal_connect(g.browsebar[BROWSEBAR_FILENAMES], "toggled",
-		G_CALLBACK(on_filenames_toggled), NULL);
+	g_signal_connect(w->browsebar[BROWSEBAR_FILTER], "toggled",
+		G_CALLBACK(on_filtering_toggled), w);
+	g_signal_connect(w->browsebar[BROWSEBAR_FILENAMES], "toggled",
+		G_CALLBACK(on_filenames_toggled), w);
 
-	GtkRadioButton *last = GTK_RADIO_BUTTON(g.browsebar[BROWSEBAR_SORT_NAME]);
+	GtkRadioButton *last =
+		GTK_RADIO_BUTTON(w->browsebar[BROWSEBAR_SORT_NAME]);
 	for (int i = BROWSEBAR_SORT_NAME; i <= BROWSEBAR_SORT_TIME; i++) {
-		GtkRadioButton *radio = GTK_RADIO_BUTTON(g.browsebar[i]);
-		g_signal_connect(radio, "toggled", G_CALLBACK(on_sort_field),
-			(gpointer) (gintptr) i - BROWSEBAR_SORT_NAME);
+		GtkRadioButton *radio = GTK_RADIO_BUTTON(w->browsebar[i]);
+		g_object_set_data(G_OBJECT(radio), "sort-field",
+			(gpointer) (gintptr) (i - BROWSEBAR_SORT_NAME));
+		g_signal_connect(radio, "toggled", G_CALLBACK(on_sort_field), w);
 		gtk_radio_button_join_group(radio, last);
 		last = radio;
 	}
@@ -1915,57 +2057,57 @@ make_browser_toolbar(void)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 static void
-on_view_actions_changed(void)
+on_view_actions_changed(MainWindow *w)
 {
 	gboolean has_image = FALSE, can_animate = FALSE;
 	gboolean has_previous = FALSE, has_next = FALSE;
-	g_object_get(g.view, "has-image", &has_image, "can-animate", &can_animate,
+	g_object_get(w->view, "has-image", &has_image, "can-animate", &can_animate,
 		"has-previous-page", &has_previous, "has-next-page", &has_next, NULL);
 
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_PAGE_FIRST], has_previous);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_PAGE_PREVIOUS], has_previous);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_PAGE_NEXT], has_next);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_PAGE_LAST], has_next);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_PAGE_FIRST], has_previous);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_PAGE_PREVIOUS], has_previous);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_PAGE_NEXT], has_next);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_PAGE_LAST], has_next);
 
 	// We don't want these to flash during playback.
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_SKIP_BACK], can_animate);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_SEEK_BACK], can_animate);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_PLAY_PAUSE], can_animate);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_SEEK_FORWARD], can_animate);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_SKIP_BACK], can_animate);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_SEEK_BACK], can_animate);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_PLAY_PAUSE], can_animate);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_SEEK_FORWARD], can_animate);
 
 	// Note that none of the following should be visible with no image.
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_MINUS], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_SCALE], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_PLUS], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_ONE], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_FIT], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_MINUS], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_SCALE], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_PLUS], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_ONE], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_FIT], has_image);
 
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_COLOR], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_SMOOTH], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_CHECKERBOARD], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_ENHANCE], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_COLOR], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_SMOOTH], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_CHECKERBOARD], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_ENHANCE], has_image);
 
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_SAVE], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_PRINT], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_INFO], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_SAVE], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_PRINT], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_INFO], has_image);
 
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_LEFT], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_MIRROR], has_image);
-	gtk_widget_set_sensitive(g.toolbar[TOOLBAR_RIGHT], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_LEFT], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_MIRROR], has_image);
+	gtk_widget_set_sensitive(w->toolbar[TOOLBAR_RIGHT], has_image);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 static void
 on_notify_view_scale(
-	GObject *object, GParamSpec *param_spec, G_GNUC_UNUSED gpointer user_data)
+	GObject *object, GParamSpec *param_spec, MainWindow *w)
 {
 	double scale = 0;
 	g_object_get(object, g_param_spec_get_name(param_spec), &scale, NULL);
 
 	gchar *scale_str = g_strdup_printf("%.0f%%", round(scale * 100));
 	gtk_label_set_text(GTK_LABEL(
-		gtk_bin_get_child(GTK_BIN(g.toolbar[TOOLBAR_SCALE]))), scale_str);
+		gtk_bin_get_child(GTK_BIN(w->toolbar[TOOLBAR_SCALE]))), scale_str);
 	g_free(scale_str);
 
 	// FIXME: The label doesn't immediately assume its new width.
@@ -1973,7 +2115,7 @@ on_notify_view_scale(
 
 static void
 on_notify_view_playing(
-	GObject *object, GParamSpec *param_spec, G_GNUC_UNUSED gpointer user_data)
+	GObject *object, GParamSpec *param_spec, MainWindow *w)
 {
 	gboolean b = FALSE;
 	g_object_get(object, g_param_spec_get_name(param_spec), &b, NULL);
@@ -1981,7 +2123,7 @@ on_notify_view_playing(
 		? "media-playback-pause-symbolic"
 		: "media-playback-start-symbolic";
 
-	GtkButton *button = GTK_BUTTON(g.toolbar[TOOLBAR_PLAY_PAUSE]);
+	GtkButton *button = GTK_BUTTON(w->toolbar[TOOLBAR_PLAY_PAUSE]);
 	GtkImage *image = GTK_IMAGE(gtk_button_get_image(button));
 	gtk_image_set_from_icon_name(image, name, GTK_ICON_SIZE_BUTTON);
 }
@@ -1998,39 +2140,45 @@ on_notify_view_boolean(
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 static void
-on_toolbar_view_toggle(GtkToggleButton *button, const char *property)
+on_toolbar_view_toggle(GtkToggleButton *button, GtkWidget *view)
 {
-	g_object_set(g.view, property, gtk_toggle_button_get_active(button), NULL);
+	const char *property = g_object_get_data(G_OBJECT(button), "property");
+	g_object_set(view, property, gtk_toggle_button_get_active(button), NULL);
 }
 
 static void
-toolbar_toggler(int index, const char *property)
+toolbar_toggler(MainWindow *w, int index, const char *property)
 {
-	g_signal_connect(g.toolbar[index], "toggled",
-		G_CALLBACK(on_toolbar_view_toggle), (gpointer) property);
+	g_object_set_data(G_OBJECT(w->toolbar[index]), "property",
+		(gpointer) property);
+	g_signal_connect(w->toolbar[index], "toggled",
+		G_CALLBACK(on_toolbar_view_toggle), w->view);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 static void
-on_toolbar_view_command(intptr_t command)
+on_toolbar_view_command(GtkButton *button, GtkWidget *view)
 {
-	fiv_view_command(FIV_VIEW(g.view), command);
+	fiv_view_command(FIV_VIEW(view),
+		(intptr_t) g_object_get_data(G_OBJECT(button), "command"));
 }
 
 static void
-toolbar_command(int index, FivViewCommand command)
+toolbar_command(MainWindow *w, int index, FivViewCommand command)
 {
-	g_signal_connect_swapped(g.toolbar[index], "clicked",
-		G_CALLBACK(on_toolbar_view_command), (void *) (intptr_t) command);
+	g_object_set_data(G_OBJECT(w->toolbar[index]), "command",
+		(void *) (intptr_t) command);
+	g_signal_connect(w->toolbar[index], "clicked",
+		G_CALLBACK(on_toolbar_view_command), w->view);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 static void
-toolbar_connect(int index, GCallback callback)
+toolbar_connect(MainWindow *w, int index, GCallback callback)
 {
-	g_signal_connect_swapped(g.toolbar[index], "clicked", callback, NULL);
+	g_signal_connect_swapped(w->toolbar[index], "clicked", callback, w);
 }
 
 // TODO(p): The text and icons should be faded, unless the mouse cursor is
@@ -2044,14 +2192,14 @@ toolbar_connect(int index, GCallback callback)
 // but it faces the same problem as above--the input model sucks.
 // TODO(p): Simply hide it in fullscreen and add a replacement context menu.
 static GtkWidget *
-make_view_toolbar(void)
+make_view_toolbar(MainWindow *w)
 {
-#define XX(id, constructor) g.toolbar[TOOLBAR_ ## id] = constructor;
+#define XX(id, constructor) w->toolbar[TOOLBAR_ ## id] = constructor;
 	TOOLBAR(XX)
 #undef XX
 
 	GtkWidget *scale_label = gtk_label_new("");
-	gtk_container_add(GTK_CONTAINER(g.toolbar[TOOLBAR_SCALE]), scale_label);
+	gtk_container_add(GTK_CONTAINER(w->toolbar[TOOLBAR_SCALE]), scale_label);
 	// So that the width doesn't jump around in the usual zoom range.
 	// Ideally, we'd measure the widest digit and use width(NNN%).
 	gtk_label_set_width_chars(GTK_LABEL(scale_label), 5);
@@ -2064,187 +2212,195 @@ make_view_toolbar(void)
 
 	// Exploring different versions of awkward layouts.
 	for (int i = 0; i <= TOOLBAR_S1; i++)
-		gtk_box_pack_start(box, g.toolbar[i], FALSE, FALSE, 0);
+		gtk_box_pack_start(box, w->toolbar[i], FALSE, FALSE, 0);
 	for (int i = TOOLBAR_COUNT; --i >= TOOLBAR_S7; )
-		gtk_box_pack_end(box, g.toolbar[i], FALSE, FALSE, 0);
+		gtk_box_pack_end(box, w->toolbar[i], FALSE, FALSE, 0);
 
 	GtkWidget *center = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
 	for (int i = TOOLBAR_S1; ++i < TOOLBAR_S7; )
-		gtk_box_pack_start(GTK_BOX(center), g.toolbar[i], FALSE, FALSE, 0);
+		gtk_box_pack_start(GTK_BOX(center), w->toolbar[i], FALSE, FALSE, 0);
 	gtk_box_set_center_widget(box, center);
 
-	toolbar_connect(TOOLBAR_BROWSE,        G_CALLBACK(switch_to_browser));
-	toolbar_connect(TOOLBAR_FILE_PREVIOUS, G_CALLBACK(on_previous));
-	toolbar_connect(TOOLBAR_FILE_NEXT,     G_CALLBACK(on_next));
-	toolbar_command(TOOLBAR_PAGE_FIRST,    FIV_VIEW_COMMAND_PAGE_FIRST);
-	toolbar_command(TOOLBAR_PAGE_PREVIOUS, FIV_VIEW_COMMAND_PAGE_PREVIOUS);
-	toolbar_command(TOOLBAR_PAGE_NEXT,     FIV_VIEW_COMMAND_PAGE_NEXT);
-	toolbar_command(TOOLBAR_PAGE_LAST,     FIV_VIEW_COMMAND_PAGE_LAST);
-	toolbar_command(TOOLBAR_SKIP_BACK,     FIV_VIEW_COMMAND_FRAME_FIRST);
-	toolbar_command(TOOLBAR_SEEK_BACK,     FIV_VIEW_COMMAND_FRAME_PREVIOUS);
-	toolbar_command(TOOLBAR_PLAY_PAUSE,    FIV_VIEW_COMMAND_TOGGLE_PLAYBACK);
-	toolbar_command(TOOLBAR_SEEK_FORWARD,  FIV_VIEW_COMMAND_FRAME_NEXT);
-	toolbar_command(TOOLBAR_MINUS,         FIV_VIEW_COMMAND_ZOOM_OUT);
-	toolbar_command(TOOLBAR_SCALE,         FIV_VIEW_COMMAND_ZOOM_ASK);
-	toolbar_command(TOOLBAR_PLUS,          FIV_VIEW_COMMAND_ZOOM_IN);
-	toolbar_command(TOOLBAR_ONE,           FIV_VIEW_COMMAND_ZOOM_1);
-	toolbar_toggler(TOOLBAR_FIT,           "scale-to-fit");
-	toolbar_toggler(TOOLBAR_FIXATE,        "fixate");
-	toolbar_toggler(TOOLBAR_COLOR,         "enable-cms");
-	toolbar_toggler(TOOLBAR_SMOOTH,        "filter");
-	toolbar_toggler(TOOLBAR_CHECKERBOARD,  "checkerboard");
-	toolbar_toggler(TOOLBAR_ENHANCE,       "enhance");
-	toolbar_command(TOOLBAR_PRINT,         FIV_VIEW_COMMAND_PRINT);
-	toolbar_command(TOOLBAR_SAVE,          FIV_VIEW_COMMAND_SAVE_PAGE);
-	toolbar_command(TOOLBAR_INFO,          FIV_VIEW_COMMAND_INFO);
-	toolbar_command(TOOLBAR_LEFT,          FIV_VIEW_COMMAND_ROTATE_LEFT);
-	toolbar_command(TOOLBAR_MIRROR,        FIV_VIEW_COMMAND_MIRROR);
-	toolbar_command(TOOLBAR_RIGHT,         FIV_VIEW_COMMAND_ROTATE_RIGHT);
-	toolbar_connect(TOOLBAR_FULLSCREEN,    G_CALLBACK(toggle_fullscreen));
-
-	g_signal_connect(g.view, "notify::scale",
-		G_CALLBACK(on_notify_view_scale), NULL);
-	g_signal_connect(g.view, "notify::playing",
-		G_CALLBACK(on_notify_view_playing), NULL);
-	g_signal_connect(g.view, "notify::scale-to-fit",
-		G_CALLBACK(on_notify_view_boolean), g.toolbar[TOOLBAR_FIT]);
-	g_signal_connect(g.view, "notify::fixate",
-		G_CALLBACK(on_notify_view_boolean), g.toolbar[TOOLBAR_FIXATE]);
-	g_signal_connect(g.view, "notify::enable-cms",
-		G_CALLBACK(on_notify_view_boolean), g.toolbar[TOOLBAR_COLOR]);
-	g_signal_connect(g.view, "notify::filter",
-		G_CALLBACK(on_notify_view_boolean), g.toolbar[TOOLBAR_SMOOTH]);
-	g_signal_connect(g.view, "notify::checkerboard",
-		G_CALLBACK(on_notify_view_boolean), g.toolbar[TOOLBAR_CHECKERBOARD]);
-	g_signal_connect(g.view, "notify::enhance",
-		G_CALLBACK(on_notify_view_boolean), g.toolbar[TOOLBAR_ENHANCE]);
-
-	g_object_notify(G_OBJECT(g.view), "scale");
-	g_object_notify(G_OBJECT(g.view), "playing");
-	g_object_notify(G_OBJECT(g.view), "scale-to-fit");
-	g_object_notify(G_OBJECT(g.view), "fixate");
-	g_object_notify(G_OBJECT(g.view), "enable-cms");
-	g_object_notify(G_OBJECT(g.view), "filter");
-	g_object_notify(G_OBJECT(g.view), "checkerboard");
-	g_object_notify(G_OBJECT(g.view), "enhance");
+	toolbar_connect(w, TOOLBAR_BROWSE,        G_CALLBACK(switch_to_browser));
+	toolbar_connect(w, TOOLBAR_FILE_PREVIOUS, G_CALLBACK(on_previous));
+	toolbar_connect(w, TOOLBAR_FILE_NEXT,     G_CALLBACK(on_next));
+	toolbar_command(w, TOOLBAR_PAGE_FIRST,    FIV_VIEW_COMMAND_PAGE_FIRST);
+	toolbar_command(w, TOOLBAR_PAGE_PREVIOUS, FIV_VIEW_COMMAND_PAGE_PREVIOUS);
+	toolbar_command(w, TOOLBAR_PAGE_NEXT,     FIV_VIEW_COMMAND_PAGE_NEXT);
+	toolbar_command(w, TOOLBAR_PAGE_LAST,     FIV_VIEW_COMMAND_PAGE_LAST);
+	toolbar_command(w, TOOLBAR_SKIP_BACK,     FIV_VIEW_COMMAND_FRAME_FIRST);
+	toolbar_command(w, TOOLBAR_SEEK_BACK,     FIV_VIEW_COMMAND_FRAME_PREVIOUS);
+	toolbar_command(w, TOOLBAR_PLAY_PAUSE,    FIV_VIEW_COMMAND_TOGGLE_PLAYBACK);
+	toolbar_command(w, TOOLBAR_SEEK_FORWARD,  FIV_VIEW_COMMAND_FRAME_NEXT);
+	toolbar_command(w, TOOLBAR_MINUS,         FIV_VIEW_COMMAND_ZOOM_OUT);
+	toolbar_command(w, TOOLBAR_SCALE,         FIV_VIEW_COMMAND_ZOOM_ASK);
+	toolbar_command(w, TOOLBAR_PLUS,          FIV_VIEW_COMMAND_ZOOM_IN);
+	toolbar_command(w, TOOLBAR_ONE,           FIV_VIEW_COMMAND_ZOOM_1);
+	toolbar_toggler(w, TOOLBAR_FIT,           "scale-to-fit");
+	toolbar_toggler(w, TOOLBAR_FIXATE,        "fixate");
+	toolbar_toggler(w, TOOLBAR_COLOR,         "enable-cms");
+	toolbar_toggler(w, TOOLBAR_SMOOTH,        "filter");
+	toolbar_toggler(w, TOOLBAR_CHECKERBOARD,  "checkerboard");
+	toolbar_toggler(w, TOOLBAR_ENHANCE,       "enhance");
+	toolbar_command(w, TOOLBAR_PRINT,         FIV_VIEW_COMMAND_PRINT);
+	toolbar_command(w, TOOLBAR_SAVE,          FIV_VIEW_COMMAND_SAVE_PAGE);
+	toolbar_command(w, TOOLBAR_INFO,          FIV_VIEW_COMMAND_INFO);
+	toolbar_command(w, TOOLBAR_LEFT,          FIV_VIEW_COMMAND_ROTATE_LEFT);
+	toolbar_command(w, TOOLBAR_MIRROR,        FIV_VIEW_COMMAND_MIRROR);
+	toolbar_command(w, TOOLBAR_RIGHT,         FIV_VIEW_COMMAND_ROTATE_RIGHT);
+	toolbar_connect(w, TOOLBAR_FULLSCREEN,    G_CALLBACK(toggle_fullscreen));
+
+	g_signal_connect(w->view, "notify::scale",
+		G_CALLBACK(on_notify_view_scale), w);
+	g_signal_connect(w->view, "notify::playing",
+		G_CALLBACK(on_notify_view_playing), w);
+	g_signal_connect(w->view, "notify::scale-to-fit",
+		G_CALLBACK(on_notify_view_boolean), w->toolbar[TOOLBAR_FIT]);
+	g_signal_connect(w->view, "notify::fixate",
+		G_CALLBACK(on_notify_view_boolean), w->toolbar[TOOLBAR_FIXATE]);
+	g_signal_connect(w->view, "notify::enable-cms",
+		G_CALLBACK(on_notify_view_boolean), w->toolbar[TOOLBAR_COLOR]);
+	g_signal_connect(w->view, "notify::filter",
+		G_CALLBACK(on_notify_view_boolean), w->toolbar[TOOLBAR_SMOOTH]);
+	g_signal_connect(w->view, "notify::checkerboard",
+		G_CALLBACK(on_notify_view_boolean), w->toolbar[TOOLBAR_CHECKERBOARD]);
+	g_signal_connect(w->view, "notify::enhance",
+		G_CALLBACK(on_notify_view_boolean), w->toolbar[TOOLBAR_ENHANCE]);
+
+	g_object_notify(G_OBJECT(w->view), "scale");
+	g_object_notify(G_OBJECT(w->view), "playing");
+	g_object_notify(G_OBJECT(w->view), "scale-to-fit");
+	g_object_notify(G_OBJECT(w->view), "fixate");
+	g_object_notify(G_OBJECT(w->view), "enable-cms");
+	g_object_notify(G_OBJECT(w->view), "filter");
+	g_object_notify(G_OBJECT(w->view), "checkerboard");
+	g_object_notify(G_OBJECT(w->view), "enhance");
 
 #ifndef HAVE_LCMS2
-	gtk_widget_set_no_show_all(g.toolbar[TOOLBAR_COLOR], TRUE);
+	gtk_widget_set_no_show_all(w->toolbar[TOOLBAR_COLOR], TRUE);
 #endif
 #ifndef HAVE_JPEG_QS
-	gtk_widget_set_no_show_all(g.toolbar[TOOLBAR_ENHANCE], TRUE);
+	gtk_widget_set_no_show_all(w->toolbar[TOOLBAR_ENHANCE], TRUE);
 #endif
 
 	GCallback callback = G_CALLBACK(on_view_actions_changed);
-	g_signal_connect(g.view, "notify::has-image", callback, NULL);
-	g_signal_connect(g.view, "notify::can-animate", callback, NULL);
-	g_signal_connect(g.view, "notify::has-previous-page", callback, NULL);
-	g_signal_connect(g.view, "notify::has-next-page", callback, NULL);
-	callback();
+	g_signal_connect_swapped(w->view, "notify::has-image", callback, w);
+	g_signal_connect_swapped(w->view, "notify::can-animate", callback, w);
+	g_signal_connect_swapped(w->view, "notify::has-previous-page", callback, w);
+	g_signal_connect_swapped(w->view, "notify::has-next-page", callback, w);
+	on_view_actions_changed(w);
 	return view_toolbar;
 }
 
 static GtkWidget *
-make_browser_sidebar(FivIoModel *model)
+make_browser_sidebar(MainWindow *w, FivIoModel *model)
 {
 	GtkWidget *sidebar = fiv_sidebar_new(model);
 	g_signal_connect(sidebar, "open-location",
-		G_CALLBACK(on_open_location), NULL);
+		G_CALLBACK(on_open_location), w);
 
 	g_signal_connect(sidebar, "notify::visible",
-		G_CALLBACK(on_notify_sidebar_visible), NULL);
+		G_CALLBACK(on_notify_sidebar_visible), w);
 
 	g_object_notify(G_OBJECT(sidebar), "visible");
 
-	g_signal_connect(g.browser, "notify::thumbnail-size",
-		G_CALLBACK(on_notify_thumbnail_size), NULL);
-	g_signal_connect(g.browser, "notify::show-labels",
-		G_CALLBACK(on_notify_show_labels), NULL);
+	g_signal_connect(w->browser, "notify::thumbnail-size",
+		G_CALLBACK(on_notify_thumbnail_size), w);
+	g_signal_connect(w->browser, "notify::show-labels",
+		G_CALLBACK(on_notify_show_labels), w);
 	g_signal_connect(model, "notify::filtering",
-		G_CALLBACK(on_notify_filtering), NULL);
+		G_CALLBACK(on_notify_filtering), w);
 	g_signal_connect(model, "notify::sort-field",
-		G_CALLBACK(on_notify_sort_field), NULL);
+		G_CALLBACK(on_notify_sort_field), w);
 	g_signal_connect(model, "notify::sort-descending",
-		G_CALLBACK(on_notify_sort_descending), NULL);
+		G_CALLBACK(on_notify_sort_descending), w);
 
-	on_toolbar_zoom(NULL, (gpointer) 0);
+	browser_zoom(w, 0);
 
-	g_object_notify(G_OBJECT(g.model), "filtering");
-	g_object_notify(G_OBJECT(g.model), "sort-field");
-	g_object_notify(G_OBJECT(g.model), "sort-descending");
+	g_object_notify(G_OBJECT(w->model), "filtering");
+	g_object_notify(G_OBJECT(w->model), "sort-field");
+	g_object_notify(G_OBJECT(w->model), "sort-descending");
 	return sidebar;
 }
 
 // --- Actions -----------------------------------------------------------------
 
-#define ACTION(name) static void on_action_ ## name(void)
+#define ACTION(name) static void on_action_ ## name(MainWindow *w)
 
 ACTION(new_window) {
-	if (gtk_stack_get_visible_child(GTK_STACK(g.stack)) == g.view_box)
-		spawn_uri(g.uri);
+	if (gtk_stack_get_visible_child(GTK_STACK(w->stack)) == w->view_box)
+		open_new_window(w, w->uri);
 	else
-		spawn_uri(g.directory);
+		open_new_window(w, w->directory);
 }
 
 ACTION(quit) {
-	gtk_widget_destroy(g.window);
+	gtk_widget_destroy(w->window);
 }
 
 ACTION(location) {
-	fiv_sidebar_show_enter_location(FIV_SIDEBAR(g.browser_sidebar));
+	ensure_browser(w);
+	fiv_sidebar_show_enter_location(FIV_SIDEBAR(w->browser_sidebar));
 }
 
 ACTION(preferences) {
-	show_preferences(g.window);
+	show_preferences(w->window);
 }
 
 ACTION(about) {
-	show_about_dialog(g.window);
+	show_about_dialog(w->window);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 typedef struct {
 	const char *name;                   ///< Unprefixed action name
-	GCallback callback;                 ///< Simple callback
+	GCallback callback;                 ///< Callback taking the window
 	const char **accels;                ///< NULL-terminated accelerator list
 } ActionEntry;
 
 static ActionEntry g_actions[] = {
-	{"preferences", on_action_preferences,
+	{"preferences", G_CALLBACK(on_action_preferences),
 		(const char *[]) {"<Primary>comma", NULL}},
-	{"new-window", on_action_new_window,
+	{"new-window", G_CALLBACK(on_action_new_window),
 		(const char *[]) {"<Primary>n", NULL}},
-	{"open", on_open,
+	{"open", G_CALLBACK(on_open),
 		(const char *[]) {"<Primary>o", "o", NULL}},
-	{"quit", on_action_quit,
+	{"quit", G_CALLBACK(on_action_quit),
 		(const char *[]) {"<Primary>q", "<Primary>w", "q", NULL}},
-	{"toggle-fullscreen", toggle_fullscreen,
+	{"toggle-fullscreen", G_CALLBACK(toggle_fullscreen),
 		(const char *[]) {"F11", "f", NULL}},
-	{"toggle-sunlight", toggle_sunlight,
+	{"toggle-sunlight", G_CALLBACK(toggle_sunlight),
 		(const char *[]) {"<Alt><Shift>d", NULL}},
-	{"go-back", go_back,
+	{"go-back", G_CALLBACK(go_back),
 		(const char *[]) {"<Alt>Left", "BackSpace", NULL}},
-	{"go-forward", go_forward,
+	{"go-forward", G_CALLBACK(go_forward),
 		(const char *[]) {"<Alt>Right", NULL}},
-	{"go-location", on_action_location,
+	{"go-location", G_CALLBACK(on_action_location),
 		(const char *[]) {"<Primary>l", NULL}},
-	{"help", show_help_contents,
+	{"help", G_CALLBACK(show_help_contents),
 		(const char *[]) {"F1", NULL}},
-	{"shortcuts", show_help_shortcuts,
+	{"shortcuts", G_CALLBACK(show_help_shortcuts),
 		// Similar to win.show-help-overlay in gtkapplication.c.
 		(const char *[]) {"<Primary>question", "<Primary>F1", NULL}},
-	{"about", on_action_about,
+	{"about", G_CALLBACK(on_action_about),
 		(const char *[]) {"<Shift>F1", NULL}},
 	{}
 };
 
+// Accelerators and menus are shared, they act upon the focused window.
 static void
 dispatch_action(G_GNUC_UNUSED GSimpleAction *action,
 	G_GNUC_UNUSED GVariant *parameter, gpointer user_data)
 {
-	GCallback callback = user_data;
-	callback();
+	GtkApplication *app = GTK_APPLICATION(g_application_get_default());
+	GtkWindow *window = gtk_application_get_active_window(app);
+	MainWindow *w = window ? main_window_of(window) : NULL;
+	if (!w)
+		return;
+
+	void (*callback)(MainWindow *) = (void (*)(MainWindow *)) user_data;
+	callback(w);
 }
 
 static void
@@ -2274,7 +2430,7 @@ typedef struct {
 	const MenuItem *items;              ///< ""-sectioned menu items
 } MenuRoot;
 
-// We're single-instance, skip the "win" namespace for simplicity.
+// Actions find their window by themselves, skip the "win" namespace.
 static MenuRoot g_menu[] = {
 	{"_File", (MenuItem[]) {
 		{"_New Window", "app.new-window", TRUE},
@@ -2340,18 +2496,18 @@ make_menu_model(void)
 }
 
 static GtkWidget *
-make_menu_bar(GMenuModel *model)
+make_menu_bar(MainWindow *w, GMenuModel *model)
 {
-	g.menu = gtk_menu_bar_new_from_model(model);
+	w->menu = gtk_menu_bar_new_from_model(model);
 
 	// Don't let it take up space by default. Firefox sets a precedent here.
 	// (gtk_application_window_set_show_menubar() doesn't seem viable for use
 	// for this purpose.)
-	gtk_widget_show_all(g.menu);
-	gtk_widget_set_no_show_all(g.menu, TRUE);
-	gtk_widget_hide(g.menu);
-	g_signal_connect(g.menu, "deactivate", G_CALLBACK(gtk_widget_hide), NULL);
-	return g.menu;
+	gtk_widget_show_all(w->menu);
+	gtk_widget_set_no_show_all(w->menu, TRUE);
+	gtk_widget_hide(w->menu);
+	g_signal_connect(w->menu, "deactivate", G_CALLBACK(gtk_widget_hide), NULL);
+	return w->menu;
 }
 
 // --- Application -------------------------------------------------------------
@@ -2428,123 +2584,193 @@ static const char stylesheet[] = "@define-color fiv-tile @content_view_bg; \
 	.fiv-information label { padding: 0 4px; }";
 
 static void
-on_app_startup(GApplication *app, G_GNUC_UNUSED gpointer user_data)
+report_startup_phase(const char *phase)
 {
-	// We can't prevent GApplication from adding --gapplication-service.
-	if (g_application_get_flags(app) & G_APPLICATION_IS_SERVICE)
-		exit(EXIT_FAILURE);
+	// Use G_MESSAGES_DEBUG=all to see these.
+	g_debug("%s: %.3f ms after start-up", phase,
+		(g_get_monotonic_time() - g.startup_time) / 1000.);
+}
 
-	// It doesn't make much sense to have command line arguments able to
-	// resolve to the VFS they may end up being contained within.
-	fiv_collection_register();
+// The browser and its sidebar are fairly expensive to set up,
+// and not needed at all when merely opening an image.
+static void
+ensure_browser(MainWindow *w)
+{
+	if (w->browser_paned)
+		return;
 
-	g.model = g_object_new(FIV_TYPE_IO_MODEL, NULL);
-	g_signal_connect(g.model, "reloaded",
-		G_CALLBACK(on_model_reloaded), NULL);
-	g_signal_connect(g.model, "files-changed",
-		G_CALLBACK(on_model_files_changed), NULL);
+	w->browser_scroller = gtk_scrolled_window_new(NULL, NULL);
+	w->browser = fiv_browser_new(w->model);
+	gtk_widget_set_vexpand(w->browser, TRUE);
+	gtk_widget_set_hexpand(w->browser, TRUE);
+	g_signal_connect(w->browser, "item-activated",
+		G_CALLBACK(on_item_activated), w);
+	gtk_container_add(GTK_CONTAINER(w->browser_scroller), w->browser);
 
-	gtk_window_set_default_icon_name(PROJECT_NAME);
-	gtk_icon_theme_add_resource_path(
-		gtk_icon_theme_get_default(), "/org/gnome/design/IconLibrary/");
+	// We need to hide it together with its separator.
+	w->browser_toolbar = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+	gtk_box_pack_start(GTK_BOX(w->browser_toolbar),
+		make_browser_toolbar(w), FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(w->browser_toolbar),
+		gtk_separator_new(GTK_ORIENTATION_VERTICAL), FALSE, FALSE, 0);
 
-	GtkCssProvider *provider = gtk_css_provider_new();
-	gtk_css_provider_load_from_data(
-		provider, stylesheet, sizeof stylesheet - 1, NULL);
-	gtk_style_context_add_provider_for_screen(gdk_screen_get_default(),
-		GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-	g_object_unref(provider);
+	GtkWidget *browser_right = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+	gtk_box_pack_start(GTK_BOX(browser_right),
+		w->browser_toolbar, FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(browser_right),
+		w->browser_scroller, TRUE, TRUE, 0);
+
+	w->browser_sidebar = make_browser_sidebar(w, w->model);
+	w->browser_paned = gtk_paned_new(GTK_ORIENTATION_HORIZONTAL);
+	gtk_paned_add1(GTK_PANED(w->browser_paned), w->browser_sidebar);
+	gtk_paned_add2(GTK_PANED(w->browser_paned), browser_right);
+	g_signal_connect(w->browser_paned, "key-press-event",
+		G_CALLBACK(on_key_press_browser_paned), w);
+	g_signal_connect(w->browser_paned, "button-press-event",
+		G_CALLBACK(on_button_press_browser_paned), w);
+	gtk_container_add(GTK_CONTAINER(w->stack), w->browser_paned);
+
+	GSettings *settings = g_settings_new(PROJECT_NS PROJECT_NAME);
+	g_object_set(w->browser, "thumbnail-size",
+		g_settings_get_enum(settings, "thumbnail-size"), NULL);
+
+	gtk_widget_show_all(w->browser_paned);
+	gtk_widget_set_visible(w->browser_sidebar,
+		g_settings_get_boolean(settings, "show-browser-sidebar"));
+	gtk_widget_set_visible(w->browser_toolbar,
+		g_settings_get_boolean(settings, "show-browser-toolbar"));
+	g_object_unref(settings);
+
+	GdkWindow *window = gtk_widget_get_window(w->window);
+	update_fullscreen_button(w->browsebar[BROWSEBAR_FULLSCREEN],
+		window ? gdk_window_get_state(window) : 0);
+}
+
+static gboolean
+on_idle_ensure_browser(gpointer user_data)
+{
+	MainWindow *w = user_data;
+	w->idle_browser = 0;
+	ensure_browser(w);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_window_draw(G_GNUC_UNUSED GtkWidget *widget, G_GNUC_UNUSED cairo_t *cr,
+	MainWindow *w)
+{
+	if (w->drawn)
+		return FALSE;
+
+	w->drawn = TRUE;
+	report_startup_phase("first frame");
+
+	// Only prepare the browser once the user has something to look at.
+	w->idle_browser = g_idle_add_full(
+		G_PRIORITY_LOW, on_idle_ensure_browser, w, NULL);
+	return FALSE;
+}
+
+static void
+on_window_destroy(G_GNUC_UNUSED GtkWidget *widget, MainWindow *w)
+{
+	// The state itself lives until the window is finalized,
+	// but nothing asynchronous may get to it anymore.
+	g_cancellable_cancel(w->cancellable);
+	if (w->idle_browser)
+		g_source_remove(w->idle_browser);
+	w->idle_browser = 0;
+	g_signal_handlers_disconnect_by_data(w->model, w);
+}
+
+static void
+main_window_free(MainWindow *w)
+{
+	g_object_unref(w->model);
+	g_object_unref(w->cancellable);
+
+	g_free(w->directory);
+	g_list_free_full(w->directory_back, g_free);
+	g_list_free_full(w->directory_forward, g_free);
+	g_free(w->uri);
+	g_free(w);
+}
+
+static MainWindow *
+main_window_new(GtkApplication *app)
+{
+	MainWindow *w = g_new0(MainWindow, 1);
+	w->files_index = -1;
+	w->cancellable = g_cancellable_new();
+
+	w->model = g_object_new(FIV_TYPE_IO_MODEL, NULL);
+	g_signal_connect(w->model, "reloaded",
+		G_CALLBACK(on_model_reloaded), w);
+	g_signal_connect(w->model, "files-changed",
+		G_CALLBACK(on_model_files_changed), w);
 
 	GtkWidget *view_scroller = gtk_scrolled_window_new(NULL, NULL);
-	g.view = g_object_new(FIV_TYPE_VIEW, NULL);
-	gtk_drag_dest_set(g.view, GTK_DEST_DEFAULT_ALL, NULL, 0, GDK_ACTION_COPY);
-	gtk_drag_dest_add_uri_targets(g.view);
-	g_signal_connect(g.view, "key-press-event",
-		G_CALLBACK(on_key_press_view), NULL);
-	g_signal_connect(g.view, "button-press-event",
-		G_CALLBACK(on_button_press_view), NULL);
-	g_signal_connect(g.view, "drag-data-received",
-		G_CALLBACK(on_view_drag_data_received), NULL);
-	gtk_container_add(GTK_CONTAINER(view_scroller), g.view);
+	w->view = g_object_new(FIV_TYPE_VIEW, NULL);
+	gtk_drag_dest_set(w->view, GTK_DEST_DEFAULT_ALL, NULL, 0, GDK_ACTION_COPY);
+	gtk_drag_dest_add_uri_targets(w->view);
+	g_signal_connect(w->view, "key-press-event",
+		G_CALLBACK(on_key_press_view), w);
+	g_signal_connect(w->view, "button-press-event",
+		G_CALLBACK(on_button_press_view), w);
+	g_signal_connect(w->view, "drag-data-received",
+		G_CALLBACK(on_view_drag_data_received), w);
+	gtk_container_add(GTK_CONTAINER(view_scroller), w->view);
 
 	// We need to hide it together with its separator.
-	g.view_toolbar = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-	gtk_box_pack_start(GTK_BOX(g.view_toolbar),
-		make_view_toolbar(), FALSE, FALSE, 0);
-	gtk_box_pack_start(GTK_BOX(g.view_toolbar),
+	w->view_toolbar = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+	gtk_box_pack_start(GTK_BOX(w->view_toolbar),
+		make_view_toolbar(w), FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(w->view_toolbar),
 		gtk_separator_new(GTK_ORIENTATION_VERTICAL), FALSE, FALSE, 0);
 
-	g.view_info = gtk_info_bar_new();
+	w->view_info = gtk_info_bar_new();
 	// The button cannot be made flat or reflect the message type under Adwaita.
-	gtk_info_bar_set_show_close_button(GTK_INFO_BAR(g.view_info), TRUE);
+	gtk_info_bar_set_show_close_button(GTK_INFO_BAR(w->view_info), TRUE);
 	// Do not use gtk_info_bar_set_revealed(), as it animates.
-	gtk_info_bar_set_message_type(GTK_INFO_BAR(g.view_info), GTK_MESSAGE_ERROR);
-	g_signal_connect(g.view_info, "response",
+	gtk_info_bar_set_message_type(GTK_INFO_BAR(w->view_info), GTK_MESSAGE_ERROR);
+	g_signal_connect(w->view_info, "response",
 		G_CALLBACK(gtk_widget_hide), NULL);
 
-	g.view_info_label = gtk_label_new(NULL);
-	gtk_label_set_line_wrap(GTK_LABEL(g.view_info_label), TRUE);
+	w->view_info_label = gtk_label_new(NULL);
+	gtk_label_set_line_wrap(GTK_LABEL(w->view_info_label), TRUE);
 	gtk_container_add(
-		GTK_CONTAINER(gtk_info_bar_get_content_area(GTK_INFO_BAR(g.view_info))),
-		g.view_info_label);
-	g_signal_connect(g.view, "notify::messages",
-		G_CALLBACK(on_notify_view_messages), NULL);
-	gtk_widget_show_all(g.view_info);
-	gtk_widget_set_no_show_all(g.view_info, TRUE);
-	gtk_widget_hide(g.view_info);
+		GTK_CONTAINER(gtk_info_bar_get_content_area(GTK_INFO_BAR(w->view_info))),
+		w->view_info_label);
+	g_signal_connect(w->view, "notify::messages",
+		G_CALLBACK(on_notify_view_messages), w);
+	gtk_widget_show_all(w->view_info);
+	gtk_widget_set_no_show_all(w->view_info, TRUE);
+	gtk_widget_hide(w->view_info);
 
 	// Need to put the toolbar at the top, because of the horizontal scrollbar.
-	g.view_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-	gtk_box_pack_start(GTK_BOX(g.view_box), g.view_toolbar, FALSE, FALSE, 0);
-	gtk_box_pack_start(GTK_BOX(g.view_box), g.view_info, FALSE, FALSE, 0);
-	gtk_box_pack_start(GTK_BOX(g.view_box), view_scroller, TRUE, TRUE, 0);
-
-	g.browser_scroller = gtk_scrolled_window_new(NULL, NULL);
-	g.browser = fiv_browser_new(g.model);
-	gtk_widget_set_vexpand(g.browser, TRUE);
-	gtk_widget_set_hexpand(g.browser, TRUE);
-	g_signal_connect(g.browser, "item-activated",
-		G_CALLBACK(on_item_activated), NULL);
-	gtk_container_add(GTK_CONTAINER(g.browser_scroller), g.browser);
-
-	// We need to hide it together with its separator.
-	g.browser_toolbar = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-	gtk_box_pack_start(GTK_BOX(g.browser_toolbar),
-		make_browser_toolbar(), FALSE, FALSE, 0);
-	gtk_box_pack_start(GTK_BOX(g.browser_toolbar),
-		gtk_separator_new(GTK_ORIENTATION_VERTICAL), FALSE, FALSE, 0);
+	w->view_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+	gtk_box_pack_start(GTK_BOX(w->view_box), w->view_toolbar, FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(w->view_box), w->view_info, FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(w->view_box), view_scroller, TRUE, TRUE, 0);
 
-	GtkWidget *browser_right = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-	gtk_box_pack_start(GTK_BOX(browser_right),
-		g.browser_toolbar, FALSE, FALSE, 0);
-	gtk_box_pack_start(GTK_BOX(browser_right),
-		g.browser_scroller, TRUE, TRUE, 0);
-
-	g.browser_sidebar = make_browser_sidebar(g.model);
-	g.browser_paned = gtk_paned_new(GTK_ORIENTATION_HORIZONTAL);
-	gtk_paned_add1(GTK_PANED(g.browser_paned), g.browser_sidebar);
-	gtk_paned_add2(GTK_PANED(g.browser_paned), browser_right);
-	g_signal_connect(g.browser_paned, "key-press-event",
-		G_CALLBACK(on_key_press_browser_paned), NULL);
-	g_signal_connect(g.browser_paned, "button-press-event",
-		G_CALLBACK(on_button_press_browser_paned), NULL);
-
-	g.stack = gtk_stack_new();
+	// The browser is constructed lazily, see ensure_browser().
+	w->stack = gtk_stack_new();
 	gtk_stack_set_transition_type(
-		GTK_STACK(g.stack), GTK_STACK_TRANSITION_TYPE_NONE);
-	gtk_container_add(GTK_CONTAINER(g.stack), g.view_box);
-	gtk_container_add(GTK_CONTAINER(g.stack), g.browser_paned);
-
-	g.window = gtk_application_window_new(GTK_APPLICATION(app));
-	g_signal_connect_swapped(g.window, "destroy",
-		G_CALLBACK(g_application_quit), app);
-	g_signal_connect(g.window, "key-press-event",
-		G_CALLBACK(on_key_press), NULL);
-	g_signal_connect(g.window, "window-state-event",
-		G_CALLBACK(on_window_state_event), NULL);
-
-	for (const ActionEntry *a = g_actions; a->name; a++)
-		set_up_action(GTK_APPLICATION(app), a);
+		GTK_STACK(w->stack), GTK_STACK_TRANSITION_TYPE_NONE);
+	gtk_container_add(GTK_CONTAINER(w->stack), w->view_box);
+
+	// The application quits on its own once its last window goes away.
+	w->window = gtk_application_window_new(app);
+	g_object_set_data_full(G_OBJECT(w->window), "main-window", w,
+		(GDestroyNotify) main_window_free);
+	g_signal_connect(w->window, "destroy",
+		G_CALLBACK(on_window_destroy), w);
+	g_signal_connect(w->window, "key-press-event",
+		G_CALLBACK(on_key_press), w);
+	g_signal_connect(w->window, "window-state-event",
+		G_CALLBACK(on_window_state_event), w);
+	g_signal_connect_after(w->window, "draw",
+		G_CALLBACK(on_window_draw), w);
 
 	// GtkApplicationWindow overrides GtkContainer/GtkWidget virtual methods
 	// so that it has the menu bar as an extra child (if it so decides).
@@ -2553,37 +2779,25 @@ on_app_startup(GApplication *app, G_GNUC_UNUSED gpointer user_data)
 	// Messing with the window's internal state seems at best quirky,
 	// so we'll manage the menu entirely by ourselves.
 	gtk_application_window_set_show_menubar(
-		GTK_APPLICATION_WINDOW(g.window), FALSE);
-
-	GMenuModel *menu = make_menu_model();
-	gtk_application_set_menubar(GTK_APPLICATION(app), menu);
-	// The default "app menu" is good, in particular for macOS, so keep it.
+		GTK_APPLICATION_WINDOW(w->window), FALSE);
 
 	GtkWidget *menu_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-	gtk_container_add(GTK_CONTAINER(menu_box), make_menu_bar(menu));
-	gtk_container_add(GTK_CONTAINER(menu_box), g.stack);
-	gtk_container_add(GTK_CONTAINER(g.window), menu_box);
-	g_object_unref(menu);
+	gtk_container_add(GTK_CONTAINER(menu_box),
+		make_menu_bar(w, gtk_application_get_menubar(app)));
+	gtk_container_add(GTK_CONTAINER(menu_box), w->stack);
+	gtk_container_add(GTK_CONTAINER(w->window), menu_box);
 
 	GSettings *settings = g_settings_new(PROJECT_NS PROJECT_NAME);
-	if (g_settings_get_boolean(settings, "dark-theme"))
-		toggle_sunlight();
-	g_object_set(g.browser, "thumbnail-size",
-		g_settings_get_enum(settings, "thumbnail-size"), NULL);
-
 	gtk_widget_show_all(menu_box);
-	gtk_widget_set_visible(g.browser_sidebar,
-		g_settings_get_boolean(settings, "show-browser-sidebar"));
-	gtk_widget_set_visible(g.browser_toolbar,
-		g_settings_get_boolean(settings, "show-browser-toolbar"));
-	gtk_widget_set_visible(g.view_toolbar,
+	gtk_widget_set_visible(w->view_toolbar,
 		g_settings_get_boolean(settings, "show-view-toolbar"));
+	g_object_unref(settings);
 
 	// Try to get half of the screen vertically, in 4:3 aspect ratio.
 	//
 	// We need the GdkMonitor before the GtkWindow has a GdkWindow (i.e.,
 	// before it is realized). Take the smallest dimensions, out of desperation.
-	GdkDisplay *display = gtk_widget_get_display(g.window);
+	GdkDisplay *display = gtk_widget_get_display(w->window);
 	int unit = G_MAXINT;
 	for (int i = gdk_display_get_n_monitors(display); i--; ) {
 		GdkRectangle geometry = {};
@@ -2594,34 +2808,118 @@ on_app_startup(GApplication *app, G_GNUC_UNUSED gpointer user_data)
 
 	// Ask for at least 800x600, to cover ridiculously heterogenous setups.
 	unit = MAX(200, unit);
-	gtk_window_set_default_size(GTK_WINDOW(g.window), 4 * unit, 3 * unit);
+	gtk_window_set_default_size(GTK_WINDOW(w->window), 4 * unit, 3 * unit);
 
 #ifdef GDK_WINDOWING_QUARTZ
 	// Otherwise the window simply opens at (0, 0),
 	// while other macOS applications are more likely to start centered.
 	if (GDK_IS_QUARTZ_DISPLAY(display))
-		gtk_window_set_position(GTK_WINDOW(g.window), GTK_WIN_POS_CENTER);
+		gtk_window_set_position(GTK_WINDOW(w->window), GTK_WIN_POS_CENTER);
 #endif  // GDK_WINDOWING_QUARTZ
 
 	// XXX: The widget wants to read the display's profile. The realize is ugly.
-	gtk_widget_realize(g.view);
+	gtk_widget_realize(w->view);
+	return w;
+}
+
+// In single instance mode, new windows stay within this process,
+// so that they share its decoders and caches.
+static void
+open_new_window(MainWindow *w, const char *uri)
+{
+	GtkApplication *app = gtk_window_get_application(GTK_WINDOW(w->window));
+	if (!g_application_get_application_id(G_APPLICATION(app))) {
+		spawn_uri(uri);
+		return;
+	}
+
+	MainWindow *new = main_window_new(app);
+	GFile *file = g_file_new_for_uri(uri);
+	open_any_file(new, file, FALSE);
+	g_object_unref(file);
+	gtk_window_present(GTK_WINDOW(new->window));
+}
+
+static void
+on_app_startup(GApplication *app, G_GNUC_UNUSED gpointer user_data)
+{
+	// We can't prevent GApplication from adding --gapplication-service.
+	if (g_application_get_flags(app) & G_APPLICATION_IS_SERVICE)
+		exit(EXIT_FAILURE);
+
+	// It doesn't make much sense to have command line arguments able to
+	// resolve to the VFS they may end up being contained within.
+	fiv_collection_register();
+
+	gtk_window_set_default_icon_name(PROJECT_NAME);
+	gtk_icon_theme_add_resource_path(
+		gtk_icon_theme_get_default(), "/org/gnome/design/IconLibrary/");
+
+	GtkCssProvider *provider = gtk_css_provider_new();
+	gtk_css_provider_load_from_data(
+		provider, stylesheet, sizeof stylesheet - 1, NULL);
+	gtk_style_context_add_provider_for_screen(gdk_screen_get_default(),
+		GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+	g_object_unref(provider);
+
+	for (const ActionEntry *a = g_actions; a->name; a++)
+		set_up_action(GTK_APPLICATION(app), a);
+
+	// Windows make their own menu bars out of this, see main_window_new().
+	GMenuModel *menu = make_menu_model();
+	gtk_application_set_menubar(GTK_APPLICATION(app), menu);
+	g_object_unref(menu);
+	// The default "app menu" is good, in particular for macOS, so keep it.
+
+	GSettings *settings = g_settings_new(PROJECT_NS PROJECT_NAME);
+	if (g_settings_get_boolean(settings, "dark-theme"))
+		toggle_sunlight();
+	g_object_unref(settings);
+
+	report_startup_phase("startup");
 }
 
 static struct {
-	gboolean browse, collection, extract_thumbnail;
+	gboolean browse, collection, extract_thumbnail, new_instance;
 	gchar **args, *thumbnail_size, *thumbnail_size_search;
+	gchar *files_from, *cwd;
 } o;
 
 static void
-on_app_activate(
-	G_GNUC_UNUSED GApplication *app, G_GNUC_UNUSED gpointer user_data)
+open_files_from(MainWindow *w, const char *files_from)
+{
+	GFile *file = strcmp(files_from, "-")
+		? g_file_new_for_uri(files_from)
+		: g_file_new_for_path("/dev/stdin");
+
+	GError *error = NULL;
+	GFileInputStream *stream = g_file_read(file, NULL, &error);
+	g_object_unref(file);
+	if (!stream) {
+		show_error_dialog(w, error);
+		return;
+	}
+
+	// The collection keeps growing as the list is being read,
+	// which is delivered to the model through directory monitoring.
+	fiv_collection_reload_from_stream(G_INPUT_STREAM(stream), o.cwd);
+	g_object_unref(stream);
+
+	file = g_file_new_for_uri(FIV_COLLECTION_SCHEME ":/");
+	open_any_file(w, file, TRUE);
+	g_object_unref(file);
+}
+
+static void
+open_arguments(MainWindow *w)
 {
 	// XXX: We follow the behaviour of Firefox and Eye of GNOME, which both
 	// interpret multiple command line arguments differently, as a collection.
 	// However, single-element collections are unrepresentable this way,
 	// so we have a switch to enforce it.
-	g.files_index = -1;
-	if (o.args) {
+	if (o.files_from) {
+		open_files_from(w, o.files_from);
+	} else if (o.args) {
 		const gchar *target = *o.args;
 		if (o.args[1] || o.collection) {
 			fiv_collection_reload(o.args);
@@ -2629,17 +2927,59 @@ on_app_activate(
 		}
 
 		GFile *file = g_file_new_for_uri(target);
-		open_any_file(file, o.browse);
+		open_any_file(w, file, o.browse);
 		g_object_unref(file);
 	}
 
-	if (!g.directory) {
-		GFile *file = g_file_new_for_path(".");
-		open_any_file(file, FALSE);
+	if (!w->directory) {
+		GFile *file = g_file_new_for_path(o.cwd ? o.cwd : ".");
+		open_any_file(w, file, FALSE);
 		g_object_unref(file);
 	}
 
-	gtk_widget_show(g.window);
+	report_startup_phase("activate");
+	gtk_window_present(GTK_WINDOW(w->window));
+}
+
+static void
+on_app_activate(GApplication *app, G_GNUC_UNUSED gpointer user_data)
+{
+	// In single instance mode, we may be activated from the outside.
+	GtkWindow *window = gtk_application_get_active_window(GTK_APPLICATION(app));
+	if (window)
+		gtk_window_present(window);
+	else
+		open_arguments(main_window_new(GTK_APPLICATION(app)));
+}
+
+// Only used in single instance mode, in the primary instance,
+// see on_app_handle_local_options() for what is being forwarded.
+static gint
+on_app_command_line(GApplication *app,
+	GApplicationCommandLine *command_line, G_GNUC_UNUSED gpointer user_data)
+{
+	GVariantDict *options =
+		g_application_command_line_get_options_dict(command_line);
+
+	g_clear_pointer(&o.args, g_strfreev);
+	(void) g_variant_dict_lookup(options, "uris", "^as", &o.args);
+	o.browse = o.collection = FALSE;
+	(void) g_variant_dict_lookup(options, "browse", "b", &o.browse);
+	(void) g_variant_dict_lookup(options, "collection", "b", &o.collection);
+	g_clear_pointer(&o.files_from, g_free);
+	(void) g_variant_dict_lookup(options, "files-from", "s", &o.files_from);
+	g_free(o.cwd);
+	o.cwd = g_strdup(g_application_command_line_get_cwd(command_line));
+
+	// Every command line gets a window of its own, however the collection
+	// cannot be replaced while another window is browsing it.
+	gboolean wants_collection =
+		o.files_from || (o.args && (o.args[1] || o.collection));
+	if (wants_collection && is_collection_browsed_elsewhere(NULL))
+		spawn_collection(o.args, o.files_from, o.cwd);
+	else
+		open_arguments(main_window_new(GTK_APPLICATION(app)));
+	return 0;
 }
 
 // --- Plumbing ----------------------------------------------------------------
@@ -2719,7 +3059,7 @@ output_thumbnail(gchar **uris, gboolean extract, const char *size_arg)
 }
 
 static gint
-on_app_handle_local_options(G_GNUC_UNUSED GApplication *app,
+on_app_handle_local_options(GApplication *app,
 	GVariantDict *options, G_GNUC_UNUSED gpointer user_data)
 {
 	if (g_variant_dict_contains(options, "version")) {
@@ -2746,6 +3086,16 @@ on_app_handle_local_options(G_GNUC_UNUSED GApplication *app,
 		o.args[i] = g_file_get_uri(resolved);
 		g_object_unref(resolved);
 	}
+	if (o.files_from && strcmp(o.files_from, "-")) {
+		GFile *resolved = g_file_new_for_commandline_arg(o.files_from);
+		g_free(o.files_from);
+		o.files_from = g_file_get_uri(resolved);
+		g_object_unref(resolved);
+	}
+#ifdef G_OS_WIN32
+	if (o.files_from && !strcmp(o.files_from, "-"))
+		exit_fatal("reading from standard input is not supported");
+#endif
 
 	// These come from an option group that doesn't get copied to "options".
 	if (o.thumbnail_size_search) {
@@ -2756,6 +3106,33 @@ on_app_handle_local_options(G_GNUC_UNUSED GApplication *app,
 		output_thumbnail(o.args, o.extract_thumbnail, o.thumbnail_size);
 		return 0;
 	}
+
+	// Deciding this late spares thumbnailing processes from GSettings.
+	GSettings *settings = g_settings_new(PROJECT_NS PROJECT_NAME);
+	gboolean single_instance =
+		g_settings_get_boolean(settings, "single-instance");
+	g_object_unref(settings);
+	if (!single_instance || o.new_instance)
+		return -1;
+
+	// Our standard input cannot be handed over to another process.
+	if (o.files_from && !strcmp(o.files_from, "-"))
+		return -1;
+
+	// Since arguments have already been resolved against our working
+	// directory, they can be forwarded to the primary instance as they are.
+	// Options bound to variables don't make it into the dictionary.
+	if (o.args) {
+		g_variant_dict_insert_value(options, "uris",
+			g_variant_new_strv((const gchar *const *) o.args, -1));
+	}
+	g_variant_dict_insert(options, "browse", "b", o.browse);
+	g_variant_dict_insert(options, "collection", "b", o.collection);
+	if (o.files_from)
+		g_variant_dict_insert(options, "files-from", "s", o.files_from);
+
+	g_application_set_application_id(app, PROJECT_NS PROJECT_NAME);
+	g_application_set_flags(app, G_APPLICATION_HANDLES_COMMAND_LINE);
 	return -1;
 }
 
@@ -2772,6 +3149,11 @@ main(int argc, char *argv[])
 		{"collection", 0, G_OPTION_FLAG_IN_MAIN,
 			G_OPTION_ARG_NONE, &o.collection,
 			"Always put arguments in a collection (implies --browse)", NULL},
+		{"files-from", 0, G_OPTION_FLAG_IN_MAIN,
+			G_OPTION_ARG_FILENAME, &o.files_from,
+			"Read a collection from FILE, or standard input if it is -, "
+			"with one path or URI per line, or NUL-terminated "
+			"(implies --browse)", "FILE"},
 		{"invalidate-cache", 0, G_OPTION_FLAG_IN_MAIN,
 			G_OPTION_ARG_NONE, NULL,
 			"Invalidate the wide thumbnail cache", NULL},
@@ -2793,9 +3175,14 @@ main(int argc, char *argv[])
 		{"thumbnail-for-search", 0, 0,
 			G_OPTION_ARG_STRING, &o.thumbnail_size_search,
 			"Output an image file suitable for searching by content", "SIZE"},
+		{"new-instance", 0, 0,
+			G_OPTION_ARG_NONE, &o.new_instance,
+			"Do not hand over to a running instance", NULL},
 		{},
 	};
 
+	g.startup_time = g_get_monotonic_time();
+
 #ifdef __APPLE__
 	adjust_environment();
 #endif
@@ -2817,9 +3204,19 @@ main(int argc, char *argv[])
 		G_CALLBACK(on_app_startup), NULL);
 	g_signal_connect(app, "activate",
 		G_CALLBACK(on_app_activate), NULL);
+	g_signal_connect(app, "command-line",
+		G_CALLBACK(on_app_command_line), NULL);
 
 	int status = g_application_run(G_APPLICATION(app), argc, argv);
 	g_object_unref(app);
+
+	// Use G_MESSAGES_DEBUG=all to see this.
+	FivIoImagePoolStats stats = {};
+	fiv_io_image_pool_stats(&stats);
+	g_debug("image pool: %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT
+		" misses, %" G_GUINT64_FORMAT " evictions, %" G_GSIZE_FORMAT
+		" bytes in %u buffers retained", stats.hits, stats.misses,
+		stats.evictions, stats.retained, stats.retained_buffers);
 	g_strfreev(o.args);
 	return status;
 }
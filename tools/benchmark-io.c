@@ -17,6 +17,9 @@
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gdk/gdk.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #include "fiv-io.h"
@@ -29,6 +32,130 @@ timestamp(void)
 	return ts.tv_sec + ts.tv_nsec / 1.e9;
 }
 
+// Time spent on loaders that fail, summed up by file extension.
+static GHashTable *sniffing_savings;
+
+typedef struct {
+	unsigned count;                     ///< Files seen
+	double saved;                       ///< Total time saved by sniffing
+} Savings;
+
+static double
+time_from_data(const char *data, gsize len, FivIoOpenContext *ctx)
+{
+	double since = timestamp();
+	FivIoImage *image = fiv_io_open_from_data(data, len, ctx, NULL);
+	if (!image)
+		return -1;
+
+	fiv_io_image_unref(image);
+	return timestamp() - since;
+}
+
+// Loading from memory excludes I/O, so that only the dispatch differs.
+static double
+sniffing(const char *data, gsize len, FivIoOpenContext *ctx)
+{
+	ctx->try_all_loaders = FALSE;
+	double sniffed = time_from_data(data, len, ctx);
+	ctx->try_all_loaders = TRUE;
+	double exhaustive = time_from_data(data, len, ctx);
+	ctx->try_all_loaders = FALSE;
+	return (sniffed < 0 || exhaustive < 0) ? 0 : exhaustive - sniffed;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static bool
+difference(const FivIoImage *a, const FivIoImage *b, int *max, double *mean)
+{
+	if (a->width != b->width || a->height != b->height ||
+		(a->format != CAIRO_FORMAT_RGB24 && a->format != CAIRO_FORMAT_ARGB32) ||
+		(b->format != CAIRO_FORMAT_RGB24 && b->format != CAIRO_FORMAT_ARGB32))
+		return false;
+
+	// The unused byte of CAIRO_FORMAT_RGB24 is undefined.
+	uint32_t a_opaque = a->format == CAIRO_FORMAT_RGB24 ? 0xff000000 : 0;
+	uint32_t b_opaque = b->format == CAIRO_FORMAT_RGB24 ? 0xff000000 : 0;
+
+	uint64_t sum = 0;
+	*max = 0;
+	for (uint32_t y = 0; y < a->height; y++) {
+		const uint32_t *ap = (const uint32_t *) (a->data + a->stride * y);
+		const uint32_t *bp = (const uint32_t *) (b->data + b->stride * y);
+		for (uint32_t x = 0; x < a->width; x++) {
+			uint32_t ax = ap[x] | a_opaque, bx = bp[x] | b_opaque;
+			for (int shift = 0; shift < 32; shift += 8) {
+				int d = abs((int) (ax >> shift & 0xff) -
+					(int) (bx >> shift & 0xff));
+				sum += d;
+				*max = MAX(*max, d);
+			}
+		}
+	}
+	*mean = a->width && a->height
+		? sum / (4. * a->width * a->height)
+		: 0;
+	return true;
+}
+
+// Every backend's first page is compared against the default backend's.
+static void
+compare_backends(const char *data, gsize len, FivIoOpenContext *ctx)
+{
+	gchar **backends = fiv_io_backends_for_data(data, len);
+	FivIoImage *reference = NULL;
+	for (gchar **backend = backends; *backend; backend++) {
+		ctx->backend = *backend;
+		double since = timestamp();
+		FivIoImage *image = fiv_io_open_from_data(data, len, ctx, NULL);
+		double elapsed = timestamp() - since;
+		if (!image) {
+			printf("\t%s\tfailed\n", *backend);
+			continue;
+		}
+
+		if (!reference) {
+			printf("\t%s\t%.3f\n", *backend, elapsed);
+			reference = image;
+			continue;
+		}
+
+		int max = 0;
+		double mean = 0;
+		if (difference(reference, image, &max, &mean)) {
+			printf("\t%s\t%.3f\t%d\t%.4f\n", *backend, elapsed, max, mean);
+		} else {
+			printf("\t%s\t%.3f\tincomparable\n", *backend, elapsed);
+		}
+		fiv_io_image_unref(image);
+	}
+	ctx->backend = NULL;
+	g_clear_pointer(&reference, fiv_io_image_unref);
+	g_strfreev(backends);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void
+add_savings(const char *filename, double saved)
+{
+	const char *dot = strrchr(filename, '.');
+	gchar *extension = g_ascii_strdown(
+		dot && !strchr(dot, G_DIR_SEPARATOR) ? dot + 1 : "", -1);
+
+	Savings *savings = g_hash_table_lookup(sniffing_savings, extension);
+	if (!savings) {
+		savings = g_malloc0(sizeof *savings);
+		g_hash_table_insert(sniffing_savings, extension, savings);
+	} else {
+		g_free(extension);
+	}
+
+	savings->count++;
+	savings->saved += saved;
+}
+
 static void
 one_file(const char *filename)
 {
@@ -42,15 +169,20 @@ one_file(const char *filename)
 	};
 
 	FivIoImage *loaded_by_us = fiv_io_open(&ctx, NULL);
-	g_clear_object(&file);
-	g_free((char *) ctx.uri);
-	g_ptr_array_free(ctx.warnings, TRUE);
 	if (!loaded_by_us)
-		return;
+		goto out;
 
 	fiv_io_image_unref(loaded_by_us);
 	us = timestamp() - since_us;
 
+	gchar *data = NULL;
+	gsize len = 0;
+	if (!g_file_load_contents(file, NULL, &data, &len, NULL, NULL))
+		goto out;
+
+	double saved = sniffing(data, len, &ctx);
+	add_savings(filename, saved);
+
 	double since_pixbuf = timestamp(), pixbuf = 0;
 	GdkPixbuf *gdk_pixbuf = gdk_pixbuf_new_from_file(filename, NULL);
 	if (gdk_pixbuf) {
@@ -61,7 +193,31 @@ one_file(const char *filename)
 		pixbuf = timestamp() - since_pixbuf;
 	}
 
-	printf("%.3f\t%.3f\t%.0f%%\t%s\n", us, pixbuf, us / pixbuf * 100, filename);
+	printf("%.3f\t%.3f\t%.0f%%\t%.3f\t%s\n",
+		us, pixbuf, us / pixbuf * 100, saved, filename);
+
+	// Followed by indented lines: backend, time, max. and mean difference.
+	compare_backends(data, len, &ctx);
+	g_free(data);
+out:
+	g_clear_object(&file);
+	g_free((char *) ctx.uri);
+	g_ptr_array_free(ctx.warnings, TRUE);
+}
+
+static void
+print_savings(void)
+{
+	GHashTableIter iter;
+	g_hash_table_iter_init(&iter, sniffing_savings);
+
+	const char *extension = NULL;
+	const Savings *savings = NULL;
+	while (g_hash_table_iter_next(
+			&iter, (gpointer *) &extension, (gpointer *) &savings)) {
+		printf("# %s\t%u\t%.3f\t%.3f\n", extension, savings->count,
+			savings->saved, savings->saved / savings->count);
+	}
 }
 
 int
@@ -70,7 +226,13 @@ main(int argc, char *argv[])
 	// Needed for gdk_cairo_surface_create_from_pixbuf().
 	gdk_init(&argc, &argv);
 
+	sniffing_savings =
+		g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
 	for (int i = 1; i < argc; i++)
 		one_file(argv[i]);
+
+	// Per extension: file count, total and average time saved by sniffing.
+	print_savings();
+	g_hash_table_destroy(sniffing_savings);
 	return 0;
 }
@@ -16,6 +16,7 @@
 //
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -199,3 +200,26 @@ extract_mime_globs(const char **media_types)
 	g_hash_table_destroy(globs);
 	return result;
 }
+
+/// Describe the state of all files that extract_mime_globs() would read,
+/// so that its results can be cached, and the cache invalidated.
+char *
+get_mime_globs_stamp(void)
+{
+	gchar **data_dirs = get_xdg_data_dirs();
+	GString *stamp = g_string_new("");
+	for (gsize i = 0; data_dirs[i]; i++) {
+		static const char *names[] = {"subclasses", "globs2", "globs", NULL};
+		for (const char **name = names; *name; name++) {
+			gchar *path = g_build_filename(data_dirs[i], "mime", *name, NULL);
+			GStatBuf st = {};
+			if (!g_stat(path, &st)) {
+				g_string_append_printf(stamp, "%s %lld %lld\n", path,
+					(long long) st.st_mtime, (long long) st.st_size);
+			}
+			g_free(path);
+		}
+	}
+	g_strfreev(data_dirs);
+	return g_string_free(stamp, FALSE);
+}
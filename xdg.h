@@ -17,3 +17,4 @@
 
 char *get_xdg_home_dir(const char *var, const char *default_);
 char **extract_mime_globs(const char **media_types);
+char *get_mime_globs_stamp(void);